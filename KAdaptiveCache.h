@@ -0,0 +1,351 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "KHashIndex.h"
+#include "KICachePolicy.h"
+
+namespace KamaCache
+{
+
+// 单个候选策略的影子缓存统计
+struct KShadowStats
+{
+    std::string name;        // 策略名称
+    double      score = 0;   // 平滑后的窗口命中率
+    size_t      capacity = 0; // 影子缓存容量
+};
+
+// 自适应缓存的运行统计 影子模拟的开销在这里报告
+struct KAdaptiveStats
+{
+    uint64_t                  accesses = 0;        // 主缓存的 get/put 总次数
+    uint64_t                  sampledAccesses = 0; // 被采样送入影子缓存的次数
+    uint64_t                  shadowNanos = 0;     // 影子缓存模拟累计耗时(纳秒)
+    uint64_t                  switches = 0;        // 主缓存切换策略的次数
+    size_t                    shadowEntries = 0;   // 所有影子缓存的容量之和
+    std::string               current;             // 当前主缓存使用的策略
+    std::vector<KShadowStats> shadows;
+};
+
+/**
+ * @brief 在线自适应选择淘汰策略的缓存
+ *
+ * 核心设计：
+ * 1. 通过 addPolicy 注册若干候选策略，每个候选策略有一个按 sampleRate 缩小容量的影子缓存。
+ * 2. 按 key 的哈希采样：只有哈希落在采样区间内的 key 会送入影子缓存，因此影子缓存看到的
+ *    是同一工作负载在较小规模上的缩影，各策略的命中率可以直接比较。
+ * 3. 每经过 windowSize 次采样读取，对各影子缓存的窗口命中率做指数平滑；
+ *    最优策略超过当前策略 switchMargin 以上时，主缓存切换到该策略。
+ * 4. 切换时新建主缓存，旧主缓存保留一个窗口：新主缓存未命中而旧主缓存命中时把数据搬到新主缓存，
+ *    一个窗口后释放旧主缓存，切换过程中不会整体丢失热数据。过渡期内同一个 key 的写入与搬迁
+ *    由按 key 条带划分的锁串行化：写入同时覆盖旧主缓存中的副本，搬迁只在新主缓存仍没有该 key 时写入，
+ *    较旧的值不会覆盖较新的写入，新主缓存淘汰该 key 后也不会从旧主缓存读到旧值。
+ * 5. 影子缓存只保存 1 字节的值，采样读写次数与模拟耗时都计入统计，开销约为 sampleRate * 候选数。
+ */
+template<typename Key, typename Value>
+class KAdaptiveCache : public KICachePolicy<Key, Value>
+{
+private:
+    using ShadowValue = uint8_t;
+    using PrimaryPtr = std::unique_ptr<KICachePolicy<Key, Value>>;
+    using ShadowPtr = std::unique_ptr<KICachePolicy<Key, ShadowValue>>;
+
+    struct Candidate
+    {
+        std::string                       name;
+        std::function<PrimaryPtr(size_t)> makePrimary;
+        ShadowPtr                         shadow;
+        size_t                            shadowCapacity;
+        uint64_t                          windowGets = 0;
+        uint64_t                          windowHits = 0;
+        double                            score = 0;
+    };
+
+    // 过渡期内串行化同一个 key 的写入与搬迁 独占缓存行
+    struct alignas(64) KeyStripe
+    {
+        std::mutex mutex;
+    };
+
+    static constexpr size_t kKeyStripes = 64;
+
+public:
+    /**
+     * @brief 构造函数
+     *
+     * @param capacity 主缓存容量
+     * @param sampleRate 送入影子缓存的 key 比例 同时是影子缓存相对主缓存的容量比例
+     * @param windowSize 每个评估窗口包含的采样读取次数
+     * @param switchMargin 切换所需的最小平滑命中率优势 防止在相近的策略之间来回切换
+     */
+    explicit KAdaptiveCache(size_t capacity, double sampleRate = 0.1,
+                            uint64_t windowSize = 2000, double switchMargin = 0.01)
+        : capacity_(capacity)
+        , sampleThreshold_(static_cast<uint64_t>(sampleRate * (1ull << 24)))
+        , sampleRate_(sampleRate)
+        , windowSize_(windowSize > 0 ? windowSize : 1)
+        , switchMargin_(switchMargin)
+        , current_(0)
+        , accesses_(0)
+        , sampledAccesses_(0)
+        , shadowNanos_(0)
+        , switches_(0)
+        , sampledGets_(0)
+        , windows_(0)
+    {}
+
+    ~KAdaptiveCache() override = default;
+
+    /**
+     * @brief 注册候选策略 第一个注册的策略作为初始主缓存
+     * Policy 的构造函数第一个参数为容量，其余参数由 args 提供。
+     */
+    template<template<typename...> class Policy, typename... Args>
+    void addPolicy(const std::string& name, Args... args)
+    {
+        std::lock_guard<std::mutex> shadowLock(shadowMutex_);
+        std::unique_lock<std::shared_mutex> primaryLock(primaryMutex_);
+        Candidate candidate;
+        candidate.name = name;
+        candidate.makePrimary = [args...](size_t capacity) -> PrimaryPtr {
+            return PrimaryPtr(new Policy<Key, Value>(capacity, args...));
+        };
+        candidate.shadowCapacity = std::max<size_t>(1, static_cast<size_t>(capacity_ * sampleRate_));
+        candidate.shadow.reset(new Policy<Key, ShadowValue>(candidate.shadowCapacity, args...));
+        candidates_.push_back(std::move(candidate));
+        if (!primary_)
+        {
+            primary_ = candidates_.front().makePrimary(capacity_);
+            forwardEvictions(primary_);
+        }
+    }
+
+    void put(Key key, Value value) override
+    {
+        size_t hash = KHashOf(key);
+        {
+            std::shared_lock<std::shared_mutex> lock(primaryMutex_);
+            if (!primary_)
+                return;
+            if (previous_)
+            {
+                // 过渡期：旧主缓存中的副本一并覆盖 与搬迁串行
+                std::lock_guard<std::mutex> keyLock(stripeOf(hash).mutex);
+                primary_->put(key, value);
+                previous_->updateIfPresent(key, value);
+            }
+            else
+            {
+                primary_->put(key, value);
+            }
+        }
+        record(key, hash, false);
+    }
+
+    bool get(Key key, Value& value) override
+    {
+        size_t hash = KHashOf(key);
+        bool hit;
+        {
+            std::shared_lock<std::shared_mutex> lock(primaryMutex_);
+            if (!primary_)
+                return false;
+            hit = primary_->get(key, value);
+            if (!hit && previous_)
+                hit = migrate(key, value, hash);
+        }
+        record(key, hash, true);
+        return hit;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 不计入访问统计 过渡期内新旧主缓存中的副本都更新
+    bool updateIfPresent(Key key, Value value) override
+    {
+        std::shared_lock<std::shared_mutex> lock(primaryMutex_);
+        if (!primary_)
+            return false;
+        if (!previous_)
+            return primary_->updateIfPresent(key, value);
+        std::lock_guard<std::mutex> keyLock(stripeOf(KHashOf(key)).mutex);
+        bool updated = primary_->updateIfPresent(key, value);
+        return previous_->updateIfPresent(key, value) || updated;
+    }
+
+    // 主缓存与各影子缓存按同一比例调整 影子缓存多出的条目由采样写入分批淘汰
+    void setCapacity(size_t capacity) override
+    {
+        std::lock_guard<std::mutex> shadowLock(shadowMutex_);
+        std::unique_lock<std::shared_mutex> primaryLock(primaryMutex_);
+        capacity_ = capacity;
+        for (Candidate& candidate : candidates_)
+        {
+            candidate.shadowCapacity = std::max<size_t>(1, static_cast<size_t>(capacity_ * sampleRate_));
+            candidate.shadow->setCapacity(candidate.shadowCapacity);
+        }
+        if (primary_)
+            primary_->setCapacity(capacity_);
+        if (previous_)
+            previous_->setCapacity(capacity_);
+    }
+
+    size_t trim(size_t maxEvictions) override
+    {
+        std::shared_lock<std::shared_mutex> lock(primaryMutex_);
+        return primary_ ? primary_->trim(maxEvictions) : 0;
+    }
+
+    KAdaptiveStats stats() const
+    {
+        std::lock_guard<std::mutex> lock(shadowMutex_);
+        KAdaptiveStats result;
+        result.accesses = accesses_.load(std::memory_order_relaxed);
+        result.sampledAccesses = sampledAccesses_;
+        result.shadowNanos = shadowNanos_;
+        result.switches = switches_;
+        if (!candidates_.empty())
+            result.current = candidates_[current_].name;
+        for (const Candidate& candidate : candidates_)
+        {
+            result.shadows.push_back({candidate.name, candidate.score, candidate.shadowCapacity});
+            result.shadowEntries += candidate.shadowCapacity;
+        }
+        return result;
+    }
+
+private:
+    // 切换后的过渡期 新主缓存未命中时从旧主缓存搬迁 持有 primaryMutex_ 的共享锁
+    bool migrate(const Key& key, Value& value, size_t hash)
+    {
+        std::lock_guard<std::mutex> keyLock(stripeOf(hash).mutex);
+        // 等锁期间可能有写入已经写进新主缓存 只在新主缓存仍没有该 key 时搬迁
+        if (primary_->get(key, value))
+            return true;
+        if (!previous_->get(key, value))
+            return false;
+        primary_->put(key, value);
+        return true;
+    }
+
+    KeyStripe& stripeOf(size_t hash)
+    {
+        return keyStripes_[hash % kKeyStripes];
+    }
+
+    // KHashIndex 的桶号取 hash * 0x9E3779B97F4A7C15 的高位，采样若用同样的位，
+    // 采样到的 key 全部挤在影子缓存索引的前 sampleRate 段，探测链随影子容量线性增长。
+    // 这里先用 splitmix64 的终结函数重新混合，再取低 24 位，与桶号和分片取模都不相关
+    bool sampled(size_t hash) const
+    {
+        uint64_t mixed = static_cast<uint64_t>(hash);
+        mixed = (mixed ^ (mixed >> 30)) * 0xBF58476D1CE4E5B9ull;
+        mixed = (mixed ^ (mixed >> 27)) * 0x94D049BB133111EBull;
+        mixed ^= mixed >> 31;
+        return (mixed & 0xFFFFFF) < sampleThreshold_;
+    }
+
+    void record(const Key& key, size_t hash, bool isGet)
+    {
+        accesses_.fetch_add(1, std::memory_order_relaxed);
+        if (!sampled(hash))
+            return;
+
+        std::lock_guard<std::mutex> lock(shadowMutex_);
+        auto start = std::chrono::steady_clock::now();
+        ++sampledAccesses_;
+        for (Candidate& candidate : candidates_)
+        {
+            if (isGet)
+            {
+                ShadowValue dummy;
+                ++candidate.windowGets;
+                if (candidate.shadow->get(key, dummy))
+                    ++candidate.windowHits;
+            }
+            else
+            {
+                candidate.shadow->put(key, 1);
+            }
+        }
+        if (isGet && ++sampledGets_ >= windowSize_)
+            evaluate();
+        shadowNanos_ += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+
+    // 评估一个窗口：平滑各影子缓存的命中率 必要时切换主缓存 持有 shadowMutex_
+    void evaluate()
+    {
+        sampledGets_ = 0;
+        size_t best = current_;
+        for (size_t i = 0; i < candidates_.size(); ++i)
+        {
+            Candidate& candidate = candidates_[i];
+            double ratio = candidate.windowGets > 0
+                ? static_cast<double>(candidate.windowHits) / candidate.windowGets : 0;
+            candidate.score = windows_ == 0 ? ratio : 0.5 * candidate.score + 0.5 * ratio;
+            candidate.windowGets = 0;
+            candidate.windowHits = 0;
+        }
+        ++windows_;
+        for (size_t i = 0; i < candidates_.size(); ++i)
+        {
+            if (candidates_[i].score > candidates_[best].score)
+                best = i;
+        }
+
+        std::unique_lock<std::shared_mutex> lock(primaryMutex_);
+        previous_.reset(); // 过渡期只持续一个窗口
+        if (best != current_ && candidates_[best].score > candidates_[current_].score + switchMargin_)
+        {
+            previous_ = std::move(primary_);
+            primary_ = candidates_[best].makePrimary(capacity_);
+            forwardEvictions(primary_);
+            current_ = best;
+            ++switches_;
+        }
+    }
+
+    void forwardEvictions(const PrimaryPtr& primary)
+    {
+        primary->setEvictCallback([this](const Key& key, const Value& value) { this->onEvict(key, value); });
+    }
+
+private:
+    size_t                    capacity_;        // 主缓存容量
+    uint64_t                  sampleThreshold_; // 采样阈值 24 位哈希小于它的 key 被采样
+    double                    sampleRate_;      // 采样比例
+    uint64_t                  windowSize_;      // 评估窗口的采样读取次数
+    double                    switchMargin_;    // 切换所需的命中率优势
+    std::vector<Candidate>    candidates_;      // 候选策略及其影子缓存
+    size_t                    current_;         // 当前主缓存对应的候选策略
+    PrimaryPtr                primary_;         // 主缓存
+    PrimaryPtr                previous_;        // 切换前的主缓存 过渡一个窗口后释放
+    std::atomic<uint64_t>     accesses_;        // 主缓存访问次数
+    uint64_t                  sampledAccesses_; // 以下统计由 shadowMutex_ 保护
+    uint64_t                  shadowNanos_;
+    uint64_t                  switches_;
+    uint64_t                  sampledGets_;     // 当前窗口已采样的读取次数
+    uint64_t                  windows_;         // 已评估的窗口数
+    mutable std::mutex        shadowMutex_;     // 保护影子缓存与选择状态
+    mutable std::shared_mutex primaryMutex_;    // 读写主缓存用共享锁 切换主缓存用独占锁
+    KeyStripe                 keyStripes_[kKeyStripes]; // 过渡期内按 key 串行化写入与搬迁
+};
+
+} // namespace KamaCache
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace KamaCache
+{
+
+/**
+ * @brief 分块布隆过滤器 (split block Bloom filter)
+ *
+ * 核心设计：
+ * 1. 过滤器由若干 32 字节的块组成，每个 key 只落在一个块内，一次查询只访问一个缓存行。
+ * 2. 块内 8 个 32 位字各置一位，8 个位置由 8 个不同的奇数常数与哈希相乘后取高 5 位得到，
+ *    8 个通道互相独立、没有分支，编译器可以直接向量化(SSE/AVX2/NEON)。
+ * 3. 约每个元素 10 位时误判率约 1%。
+ * 4. containsBatch 先计算所有块地址并预取，再逐个检查，批量查询时可以隐藏内存延迟。
+ */
+class KBlockedBloomFilter
+{
+private:
+    struct alignas(32) Block
+    {
+        uint32_t words[8];
+    };
+
+public:
+    /**
+     * @brief 构造函数
+     *
+     * @param expectedItems 预计插入的元素数
+     * @param bitsPerItem 每个元素分配的位数
+     */
+    explicit KBlockedBloomFilter(size_t expectedItems, size_t bitsPerItem = 10)
+    {
+        size_t bits = (expectedItems > 0 ? expectedItems : 1) * bitsPerItem;
+        size_t blocks = 1;
+        while (blocks * 256 < bits)
+            blocks <<= 1;
+        blocks_.reset(new Block[blocks]);
+        blockCount_ = blocks;
+        clear();
+    }
+
+    void insert(size_t hash)
+    {
+        uint64_t h = mix(hash);
+        Block& block = blocks_[blockOf(h)];
+        uint32_t masks[8];
+        makeMasks(static_cast<uint32_t>(h), masks);
+        for (int i = 0; i < 8; ++i)
+            block.words[i] |= masks[i];
+    }
+
+    bool contains(size_t hash) const
+    {
+        uint64_t h = mix(hash);
+        const Block& block = blocks_[blockOf(h)];
+        uint32_t masks[8];
+        makeMasks(static_cast<uint32_t>(h), masks);
+        // 不提前退出 8 个通道一起计算后再合并 便于向量化
+        uint32_t missing = 0;
+        for (int i = 0; i < 8; ++i)
+            missing |= (block.words[i] & masks[i]) ^ masks[i];
+        return missing == 0;
+    }
+
+    // 插入并返回插入前是否可能已存在
+    bool testAndInsert(size_t hash)
+    {
+        uint64_t h = mix(hash);
+        Block& block = blocks_[blockOf(h)];
+        uint32_t masks[8];
+        makeMasks(static_cast<uint32_t>(h), masks);
+        uint32_t missing = 0;
+        for (int i = 0; i < 8; ++i)
+        {
+            missing |= (block.words[i] & masks[i]) ^ masks[i];
+            block.words[i] |= masks[i];
+        }
+        return missing == 0;
+    }
+
+    /**
+     * @brief 批量查询 out[i] = contains(hashes[i])
+     */
+    void containsBatch(const size_t* hashes, size_t n, bool* out) const
+    {
+        constexpr size_t kGroup = 16; // 每组先预取 再检查
+        size_t blockIndex[kGroup];
+        for (size_t base = 0; base < n; base += kGroup)
+        {
+            size_t count = n - base < kGroup ? n - base : kGroup;
+            for (size_t i = 0; i < count; ++i)
+            {
+                blockIndex[i] = blockOf(mix(hashes[base + i]));
+                prefetch(&blocks_[blockIndex[i]]);
+            }
+            for (size_t i = 0; i < count; ++i)
+                out[base + i] = contains(hashes[base + i]);
+        }
+    }
+
+    void clear()
+    {
+        std::memset(blocks_.get(), 0, blockCount_ * sizeof(Block));
+    }
+
+    size_t bytes() const { return blockCount_ * sizeof(Block); }
+
+private:
+    // std::hash 对整数是恒等映射 先打散再使用
+    static uint64_t mix(size_t hash)
+    {
+        uint64_t h = static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+        return h ^ (h >> 29);
+    }
+
+    // 高 32 位选块 低 32 位生成块内 8 个位置
+    size_t blockOf(uint64_t h) const
+    {
+        return static_cast<size_t>(((h >> 32) * blockCount_) >> 32);
+    }
+
+    static void makeMasks(uint32_t key, uint32_t masks[8])
+    {
+        static constexpr uint32_t kSalt[8] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                              0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+        for (int i = 0; i < 8; ++i)
+            masks[i] = 1U << ((key * kSalt[i]) >> 27);
+    }
+
+    static void prefetch(const void* address)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(address);
+#else
+        (void)address;
+#endif
+    }
+
+private:
+    std::unique_ptr<Block[]> blocks_;
+    size_t                   blockCount_;
+};
+
+} // namespace KamaCache
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "../KHashIndex.h"
+#include "../KICachePolicy.h"
+#include "KBlockedBloomFilter.h"
+
+namespace KamaCache
+{
+
+// 准入统计
+struct KAdmissionStats
+{
+    uint64_t admitted = 0;  // 允许写入内部缓存的次数
+    uint64_t rejected = 0;  // 首次出现被拒绝的次数
+    uint64_t rotations = 0; // 过滤器轮换次数
+
+    double admissionRate() const
+    {
+        uint64_t total = admitted + rejected;
+        return total > 0 ? static_cast<double>(admitted) / total : 0;
+    }
+};
+
+/**
+ * @brief 布隆过滤器门卫：可以包在任意 KICachePolicy 外面的准入层
+ *
+ * 核心设计：
+ * 1. key 在一个窗口内第二次被写入时才真正进入内部缓存，第一次只在门卫中留下记录，
+ *    只出现一次的 key 不会挤掉内部缓存中的有用数据。
+ * 2. 门卫由两个分块布隆过滤器轮换组成：写入只记录到当前过滤器，查询同时检查两个过滤器；
+ *    当前过滤器记录满 windowSize 次后成为旧过滤器，原来的旧过滤器清空后成为新的当前过滤器，
+ *    因此一个 key 的记录至少保留一个窗口，内存固定。
+ * 3. 被拒绝的写入通过 updateIfPresent 更新内部缓存中已有的该 key(门卫轮换后可能出现)，不会留下旧值，
+ *    也不会像一次访问那样提升它的淘汰优先级。
+ * 4. get 不经过门卫，直接访问内部缓存。
+ */
+template<typename Key, typename Value>
+class KDoorkeeperCache : public KICachePolicy<Key, Value>
+{
+public:
+    /**
+     * @brief 构造函数
+     *
+     * @param inner 被保护的缓存
+     * @param windowSize 每个过滤器记录的 key 数 默认取内部缓存容量的数倍
+     * @param bitsPerItem 布隆过滤器每个元素的位数
+     */
+    KDoorkeeperCache(std::unique_ptr<KICachePolicy<Key, Value>> inner, size_t windowSize, size_t bitsPerItem = 10)
+        : inner_(std::move(inner))
+        , windowSize_(windowSize > 0 ? windowSize : 1)
+        , current_(windowSize_, bitsPerItem)
+        , previous_(windowSize_, bitsPerItem)
+        , currentCount_(0)
+    {
+        inner_->setEvictCallback([this](const Key& key, const Value& value) { this->onEvict(key, value); });
+    }
+
+    ~KDoorkeeperCache() override = default;
+
+    void put(Key key, Value value) override
+    {
+        size_t hash = KHashOf(key);
+        if (admit(hash))
+        {
+            inner_->put(key, value);
+            return;
+        }
+        // 首次出现不准入 但内部缓存已有该 key 时必须更新 否则会留下旧值
+        inner_->updateIfPresent(key, value);
+    }
+
+    bool get(Key key, Value& value) override
+    {
+        return inner_->get(key, value);
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 不经过门卫 也不留下记录
+    bool updateIfPresent(Key key, Value value) override
+    {
+        return inner_->updateIfPresent(key, value);
+    }
+
+    /**
+     * @brief 批量写入 先用一次批量查询判断所有 key 是否已在门卫中
+     */
+    void putBatch(const std::vector<Key>& keys, const std::vector<Value>& values)
+    {
+        size_t n = keys.size() < values.size() ? keys.size() : values.size();
+        std::vector<size_t> hashes(n);
+        for (size_t i = 0; i < n; ++i)
+            hashes[i] = KHashOf(keys[i]);
+
+        std::unique_ptr<bool[]> seenCurrent(new bool[n]);
+        std::unique_ptr<bool[]> seenPrevious(new bool[n]);
+        std::vector<bool> admitted(n);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            current_.containsBatch(hashes.data(), n, seenCurrent.get());
+            previous_.containsBatch(hashes.data(), n, seenPrevious.get());
+            for (size_t i = 0; i < n; ++i)
+            {
+                // 同一批中重复出现的 key 第二次应当被准入 所以先前没见过的要逐个记录
+                admitted[i] = seenCurrent[i] || seenPrevious[i] ||
+                              current_.contains(hashes[i]) || previous_.contains(hashes[i]);
+                record(hashes[i], admitted[i]);
+            }
+        }
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (admitted[i])
+            {
+                inner_->put(keys[i], values[i]);
+            }
+            else
+            {
+                inner_->updateIfPresent(keys[i], values[i]);
+            }
+        }
+    }
+
+    // 过滤器窗口大小不变 只调整内部缓存
+    void setCapacity(size_t capacity) override { inner_->setCapacity(capacity); }
+
+    size_t trim(size_t maxEvictions) override { return inner_->trim(maxEvictions); }
+
+    KAdmissionStats stats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+    // 两个过滤器占用的内存
+    size_t filterBytes() const { return current_.bytes() + previous_.bytes(); }
+
+private:
+    bool admit(size_t hash)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bool seen = previous_.contains(hash) || current_.contains(hash);
+        record(hash, seen);
+        return seen;
+    }
+
+    // 记录一次写入 持有 mutex_
+    void record(size_t hash, bool seen)
+    {
+        if (seen)
+        {
+            ++stats_.admitted;
+            return;
+        }
+        ++stats_.rejected;
+        current_.insert(hash);
+        if (++currentCount_ >= windowSize_)
+        {
+            // 轮换：当前过滤器变为旧过滤器 清空原来的旧过滤器作为新的当前过滤器
+            std::swap(current_, previous_);
+            current_.clear();
+            currentCount_ = 0;
+            ++stats_.rotations;
+        }
+    }
+
+private:
+    std::unique_ptr<KICachePolicy<Key, Value>> inner_;        // 被保护的缓存
+    size_t                                     windowSize_;   // 每个过滤器记录的 key 数
+    KBlockedBloomFilter                        current_;      // 当前窗口的过滤器
+    KBlockedBloomFilter                        previous_;     // 上一个窗口的过滤器
+    size_t                                     currentCount_; // 当前过滤器已记录的 key 数
+    KAdmissionStats                            stats_;        // 准入统计
+    mutable std::mutex                         mutex_;        // 保护过滤器与统计
+};
+
+} // namespace KamaCache
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+
+namespace KamaCache
+{
+
+// 扫描检测的阈值
+struct KScanDetectorOptions
+{
+    size_t   streams = 64;        // 跟踪的访问流数量 流号按取模映射
+    uint32_t strideRun = 8;       // 连续多少次相同步长视为顺序/跨步扫描
+    int64_t  maxStride = 64;      // 步长绝对值超过它不视为跨步扫描
+    uint32_t missRun = 64;        // 连续多少次未命中视为一次性扫描 0 表示不检测
+};
+
+/**
+ * @brief 按访问流识别扫描的检测器
+ *
+ * 每个访问流(调用方或线程)独立记录：
+ * 1. 顺序/跨步扫描：整数 key 连续 strideRun 次以相同的非零步长变化(如 0,1,2,... 或 0,8,16,...)。
+ *    非整数 key 不做这项检测。
+ * 2. 一次性扫描：读取连续 missRun 次未命中，例如全表回填只会读取从未缓存过的 key。
+ *    写入(observeWrite)只参与步长检测，不计入未命中，只写不读的流不会因此被当成扫描。
+ * 任一条件成立时该流处于扫描状态，一旦出现不符合的访问立即退出扫描状态。
+ *
+ * 每个流槽位独占一条缓存行并有自己的锁，不同流的访问互不竞争。
+ */
+template<typename Key>
+class KScanDetector
+{
+private:
+    struct alignas(64) StreamState
+    {
+        mutable std::mutex mutex;          // 只保护本槽位
+        int64_t            lastKey = 0;
+        int64_t            stride = 0;
+        uint32_t           strideRun = 0;
+        uint32_t           missRun = 0;
+        bool               hasLast = false;
+    };
+
+public:
+    explicit KScanDetector(const KScanDetectorOptions& options = KScanDetectorOptions())
+        : options_(options)
+        , streamNum_(options.streams > 0 ? options.streams : 1)
+        , states_(new StreamState[streamNum_])
+    {}
+
+    /**
+     * @brief 记录流 stream 的一次访问
+     *
+     * @param missed 这次访问是否未命中
+     * @return 该流当前是否处于扫描状态
+     */
+    bool observe(uint64_t stream, const Key& key, bool missed)
+    {
+        StreamState& state = states_[stream % streamNum_];
+        std::lock_guard<std::mutex> lock(state.mutex);
+        observeStride(state, key);
+        state.missRun = missed ? state.missRun + 1 : 0;
+        return scanning(state);
+    }
+
+    // 记录流 stream 的一次没有先读的写入：只更新步长 不改变连续未命中计数
+    bool observeWrite(uint64_t stream, const Key& key)
+    {
+        StreamState& state = states_[stream % streamNum_];
+        std::lock_guard<std::mutex> lock(state.mutex);
+        observeStride(state, key);
+        return scanning(state);
+    }
+
+    // 不记录访问 只查询流是否处于扫描状态
+    bool isScanning(uint64_t stream) const
+    {
+        const StreamState& state = states_[stream % streamNum_];
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return scanning(state);
+    }
+
+    // 流上一次访问的 key 是否就是 key(用于区分 "未命中后回源写入" 与独立的写入)
+    bool isLastKey(uint64_t stream, const Key& key) const
+    {
+        const StreamState& state = states_[stream % streamNum_];
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return state.hasLast && sameKey(state, key);
+    }
+
+private:
+    bool scanning(const StreamState& state) const
+    {
+        return state.strideRun >= options_.strideRun ||
+               (options_.missRun > 0 && state.missRun >= options_.missRun);
+    }
+
+    template<typename K = Key>
+    typename std::enable_if<std::is_integral<K>::value>::type observeStride(StreamState& state, const K& key)
+    {
+        int64_t current = static_cast<int64_t>(key);
+        if (state.hasLast)
+        {
+            int64_t stride = current - state.lastKey;
+            bool strided = stride != 0 && stride <= options_.maxStride && -stride <= options_.maxStride;
+            if (strided && stride == state.stride)
+            {
+                ++state.strideRun;
+            }
+            else
+            {
+                state.stride = stride;
+                state.strideRun = strided ? 1 : 0;
+            }
+        }
+        state.lastKey = current;
+        state.hasLast = true;
+    }
+
+    // 非整数 key 只记录最后一次访问的哈希 用于 isLastKey
+    template<typename K = Key>
+    typename std::enable_if<!std::is_integral<K>::value>::type observeStride(StreamState& state, const K& key)
+    {
+        state.lastKey = static_cast<int64_t>(std::hash<K>{}(key));
+        state.hasLast = true;
+    }
+
+    template<typename K = Key>
+    static typename std::enable_if<std::is_integral<K>::value, bool>::type sameKey(const StreamState& state, const K& key)
+    {
+        return state.lastKey == static_cast<int64_t>(key);
+    }
+
+    template<typename K = Key>
+    static typename std::enable_if<!std::is_integral<K>::value, bool>::type sameKey(const StreamState& state, const K& key)
+    {
+        return state.lastKey == static_cast<int64_t>(std::hash<K>{}(key));
+    }
+
+private:
+    KScanDetectorOptions           options_;
+    size_t                         streamNum_; // 流槽位数
+    std::unique_ptr<StreamState[]> states_;    // 每个流槽位的状态
+};
+
+} // namespace KamaCache
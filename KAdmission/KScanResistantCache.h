@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+
+#include "../KICachePolicy.h"
+#include "KScanDetector.h"
+
+namespace KamaCache
+{
+
+// 扫描流中的写入如何处理
+enum class KScanAction
+{
+    Bypass,     // 不写入缓存
+    ColdInsert  // 通过 putCold 写入淘汰端 被再次访问前最先被淘汰
+};
+
+// 扫描检测统计
+struct KScanStats
+{
+    uint64_t puts = 0;     // 写入总次数
+    uint64_t scanPuts = 0; // 被识别为扫描的写入次数
+};
+
+/**
+ * @brief 抗扫描包装层：可以包在任意 KICachePolicy 外面
+ *
+ * 每次访问按访问流交给 KScanDetector，流处于扫描状态时，它的写入按 action 绕过缓存或写入冷端，
+ * 全表回填、批处理循环等一次性访问不会再冲掉交互请求的工作集。读取不受影响。
+ *
+ * 访问流默认按调用线程区分；同一线程上交错多个逻辑流时使用带 stream 参数的重载。
+ * 未命中后立刻回源写入同一个 key 视为同一次访问，只记录一次。
+ */
+template<typename Key, typename Value>
+class KScanResistantCache : public KICachePolicy<Key, Value>
+{
+public:
+    KScanResistantCache(std::unique_ptr<KICachePolicy<Key, Value>> inner,
+                        KScanAction action = KScanAction::Bypass,
+                        const KScanDetectorOptions& options = KScanDetectorOptions())
+        : inner_(std::move(inner))
+        , action_(action)
+        , detector_(options)
+        , puts_(0)
+        , scanPuts_(0)
+    {
+        inner_->setEvictCallback([this](const Key& key, const Value& value) { this->onEvict(key, value); });
+    }
+
+    ~KScanResistantCache() override = default;
+
+    void put(Key key, Value value) override
+    {
+        put(key, value, currentStream());
+    }
+
+    void put(const Key& key, const Value& value, uint64_t stream)
+    {
+        puts_.fetch_add(1, std::memory_order_relaxed);
+        bool scanning = detector_.isLastKey(stream, key)
+            ? detector_.isScanning(stream)
+            : detector_.observeWrite(stream, key); // 没有先读的写入只参与步长检测 不算未命中
+        if (!scanning)
+        {
+            inner_->put(key, value);
+            return;
+        }
+
+        scanPuts_.fetch_add(1, std::memory_order_relaxed);
+        if (action_ == KScanAction::ColdInsert)
+        {
+            inner_->putCold(key, value);
+            return;
+        }
+        // 绕过时如果缓存中已有该 key 仍需更新 否则会留下旧值；更新不算一次访问 扫描不会提升它
+        inner_->updateIfPresent(key, value);
+    }
+
+    bool get(Key key, Value& value) override
+    {
+        return get(key, value, currentStream());
+    }
+
+    bool get(const Key& key, Value& value, uint64_t stream)
+    {
+        bool hit = inner_->get(key, value);
+        detector_.observe(stream, key, !hit);
+        return hit;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 不经过扫描检测
+    bool updateIfPresent(Key key, Value value) override
+    {
+        return inner_->updateIfPresent(key, value);
+    }
+
+    void setCapacity(size_t capacity) override { inner_->setCapacity(capacity); }
+
+    size_t trim(size_t maxEvictions) override { return inner_->trim(maxEvictions); }
+
+    KScanStats stats() const
+    {
+        KScanStats result;
+        result.puts = puts_.load(std::memory_order_relaxed);
+        result.scanPuts = scanPuts_.load(std::memory_order_relaxed);
+        return result;
+    }
+
+private:
+    static uint64_t currentStream()
+    {
+        return std::hash<std::thread::id>{}(std::this_thread::get_id());
+    }
+
+private:
+    std::unique_ptr<KICachePolicy<Key, Value>> inner_;    // 被保护的缓存
+    KScanAction                                action_;   // 扫描写入的处理方式
+    KScanDetector<Key>                         detector_; // 按流的扫描检测器
+    std::atomic<uint64_t>                      puts_;     // 写入总次数
+    std::atomic<uint64_t>                      scanPuts_; // 扫描写入次数
+};
+
+} // namespace KamaCache
@@ -28,6 +28,9 @@ public:
     {
         // lruPart_ = std::make_unique<ArcLruPart<Key, Value>>(capacity, transformThreshold);
         // lfuPart_ = std::make_unique<ArcLfuPart<Key, Value>>(capacity, transformThreshold);
+        // 两个部分淘汰的节点统一转交给基类的淘汰回调
+        lruPart_->setEvictCallback([this](const Key& key, const Value& value) { this->onEvict(key, value); });
+        lfuPart_->setEvictCallback([this](const Key& key, const Value& value) { this->onEvict(key, value); });
     }
 
     ~KArcCache() override = default;
@@ -40,18 +43,19 @@ public:
      */
     void put(Key key, Value value) override 
     {
-        checkGhostCaches(key); // 触发幽灵命中 更新缓存空间大小
+        size_t hash = KHashOf(key); // 只计算一次哈希 传给两个部分的索引与幽灵缓存
+        checkGhostCaches(key, hash); // 触发幽灵命中 更新缓存空间大小
 
-        bool inLfu = lfuPart_->contain(key); // 检查 LFU 部分是否存在该键
+        bool inLfu = lfuPart_->contain(key, hash); // 检查 LFU 部分是否存在该键
         if (inLfu) 
         {
-            lfuPart_->put(key, value); // lfu 更新 lfu的插入只由LRU控制
+            lfuPart_->put(key, value, hash); // lfu 更新 lfu的插入只由LRU控制
         } else {
             bool shouldTransform = false; // 检查是否需要晋升
-            lruPart_->put(key, value, shouldTransform);
+            lruPart_->put(key, value, hash, shouldTransform);
             if (shouldTransform) { // 判断晋升
-                lruPart_->deleteNodeFromMain(key);
-                lfuPart_->put(key, value);
+                lruPart_->deleteNodeFromMain(key, hash);
+                lfuPart_->put(key, value, hash);
             }
         }
     }
@@ -66,20 +70,21 @@ public:
      */
     bool get(Key key, Value& value) override 
     {
-        checkGhostCaches(key);
+        size_t hash = KHashOf(key);
+        checkGhostCaches(key, hash);
 
         // 晋升函数
         bool shouldTransform = false;
-        if (lruPart_->get(key, value, shouldTransform)) // 如果LRU中有，判断完是否晋升后直接返回
+        if (lruPart_->get(key, value, hash, shouldTransform)) // 如果LRU中有，判断完是否晋升后直接返回
         {
             if (shouldTransform) 
             {
-                lruPart_->deleteNodeFromMain(key);
-                lfuPart_->put(key, value);
+                lruPart_->deleteNodeFromMain(key, hash);
+                lfuPart_->put(key, value, hash);
             }
             return true;
         }
-        return lfuPart_->get(key, value);   // 如果LRU中没有再判断LFU 最后返回
+        return lfuPart_->get(key, value, hash);   // 如果LRU中没有再判断LFU 最后返回
     }
 
     Value get(Key key) override  // 复用
@@ -89,19 +94,54 @@ public:
         return value;
     }
 
+    // 不检查幽灵缓存 也不触发晋升
+    bool updateIfPresent(Key key, Value value) override
+    {
+        size_t hash = KHashOf(key);
+        return lfuPart_->update(key, value, hash) || lruPart_->update(key, value, hash);
+    }
+
+    /**
+     * @brief 运行期调整容量 capacity 与构造参数含义相同(单个部分的初始大小)
+     * 两部分的总容量变为 2 * capacity，按当前自适应得到的比例分配，幽灵缓存同步调整。
+     * 
+     * @param capacity 
+     */
+    void setCapacity(size_t capacity) override
+    {
+        size_t lruCapacity = lruPart_->capacity();
+        size_t total = lruCapacity + lfuPart_->capacity();
+        size_t newTotal = 2 * capacity;
+        size_t newLru = total > 0 ? static_cast<size_t>(static_cast<double>(lruCapacity) / total * newTotal) : capacity;
+        lruPart_->setCapacity(newLru, capacity);
+        lfuPart_->setCapacity(newTotal - newLru, capacity);
+        capacity_ = capacity;
+    }
+
+    // LRU 部分最多用掉一半配额(向上取整) LFU 部分用剩下的 两部分合计不超过 maxEvictions
+    size_t trim(size_t maxEvictions) override
+    {
+        size_t lruBudget = (maxEvictions + 1) / 2;
+        size_t lfuBudget = maxEvictions - lruBudget;
+        size_t remaining = lruPart_->trim(lruBudget);
+        lfuBudget += lruBudget; // LRU 部分未用完的配额
+        return remaining + lfuPart_->trim(lfuBudget);
+    }
+
 private:
     /**
      * @brief 利用幽灵缓存动态调整缓存空间大小 以面对不同情况
      * 
      * @param key 
+     * @param hash key 的哈希值
      * @return true 
      * @return false 
      */
-    bool checkGhostCaches(Key key) 
+    bool checkGhostCaches(const Key& key, size_t hash) 
     {
         bool inGhost = false;
         // 如果在 LRU 的幽灵区命中了 -> 说明 LRU 空间太小了 
-        if (lruPart_->checkGhost(key)) 
+        if (lruPart_->checkGhost(key, hash)) 
         {
             // 削减 LFU 的容量，增加 LRU 的容量 如果可以的话 decreaseCapacity会返回缩减是否成功
             if (lfuPart_->decreaseCapacity()) 
@@ -111,7 +151,7 @@ private:
             inGhost = true;
         } 
         // 反之，如果在 LFU 的幽灵区命中 -> 说明 LFU 空间太小
-        else if (lfuPart_->checkGhost(key)) 
+        else if (lfuPart_->checkGhost(key, hash)) 
         {
             // 削减 LRU，增加 LFU 如果可以的话 decreaseCapacity会返回缩减是否成功
             if (lruPart_->decreaseCapacity()) 
@@ -15,22 +15,25 @@ class ArcNode
 private:
     Key key_;
     Value value_;
+    size_t hash_; // key 的哈希值 插入时计算一次 淘汰与移入幽灵缓存时直接复用
     size_t accessCount_;
     std::weak_ptr<ArcNode> prev_;
     std::shared_ptr<ArcNode> next_;
 
 public:
-    ArcNode() : accessCount_(1), next_(nullptr) {}
+    ArcNode() : hash_(0), accessCount_(1), next_(nullptr) {}
     
-    ArcNode(Key key, Value value) 
+    ArcNode(Key key, Value value, size_t hash) 
         : key_(key)
         , value_(value)
+        , hash_(hash)
         , accessCount_(1)
         , next_(nullptr) 
     {}
 
     // Getters
-    Key getKey() const { return key_; }
+    const Key& getKey() const { return key_; }
+    size_t getHash() const { return hash_; }
     Value getValue() const { return value_; }
     size_t getAccessCount() const { return accessCount_; }
     
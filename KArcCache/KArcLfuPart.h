@@ -1,6 +1,8 @@
 #pragma once
 
 #include "KArcCacheNode.h"
+#include "../KHashIndex.h"
+#include <functional>
 #include <unordered_map>
 #include <map>
 #include <mutex>
@@ -18,7 +20,8 @@ class ArcLfuPart
 public:
     using NodeType = ArcNode<Key, Value>;
     using NodePtr = std::shared_ptr<NodeType>; // 构建指针
-    using NodeMap = std::unordered_map<Key, NodePtr>; // 用于O(1)查找的LFU指针表
+    using NodeMap = KHashIndex<Key, NodePtr>; // 用于O(1)查找的LFU指针表 保存节点哈希
+    using EvictCallback = std::function<void(const Key&, const Value&)>; // 淘汰回调
     using FreqMap = std::map<size_t, std::list<NodePtr>>; // 频率表与双向链表
     /**
      * @brief 构造函数
@@ -39,21 +42,36 @@ public:
      * 
      * @param key 
      * @param value 
+     * @param hash key 的哈希值 由 KArcCache 计算一次后传入
      * @return true 
      * @return false 
      */
-    bool put(Key key, Value value) 
+    bool put(const Key& key, const Value& value, size_t hash) 
     {
-        if (capacity_ == 0) 
-            return false;
         // 锁住整个LFU
         std::lock_guard<std::mutex> lock(mutex_);
-        auto it = mainCache_.find(key);
-        if (it != mainCache_.end())     // 如果命中缓存 则更新
+        NodePtr* node = mainCache_.find(key, hash);
+        if (node)     // 如果命中缓存 则更新
         {
-            return updateExistingNode(it->second, value);
+            return updateExistingNode(*node, value);
         }
-        return addNewNode(key, value);  // 未命中缓存 则插入
+        if (capacity_ == 0)
+        {
+            trimBatch();
+            return false;
+        }
+        return addNewNode(key, value, hash);  // 未命中缓存 则插入
+    }
+
+    // 只更新主缓存中已存在节点的值 不改变访问状态
+    bool update(const Key& key, const Value& value, size_t hash)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        NodePtr* node = mainCache_.find(key, hash);
+        if (!node)
+            return false;
+        (*node)->setValue(value);
+        return true;
     }
 
     /**
@@ -61,43 +79,45 @@ public:
      * 
      * @param key 
      * @param value 
+     * @param hash key 的哈希值
      * @return true 
      * @return false 
      */
-    bool get(Key key, Value& value) 
+    bool get(const Key& key, Value& value, size_t hash) 
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        auto it = mainCache_.find(key);
+        NodePtr* node = mainCache_.find(key, hash);
         // 映射表中存在 就更新 提高访问频次
-        if (it != mainCache_.end()) 
+        if (node) 
         {
-            updateNodeFrequency(it->second);
-            value = it->second->getValue();
+            updateNodeFrequency(*node);
+            value = (*node)->getValue();
             return true;
         }
         return false;
     }
 
     // 查找LFU的缓存
-    bool contain(Key key)
+    bool contain(const Key& key, size_t hash)
     {
-        return mainCache_.find(key) != mainCache_.end();
+        return mainCache_.contains(key, hash);
     }
 
     /**
      * @brief 幽灵缓存命中 将其从幽灵缓存中删除
      * 
      * @param key 
+     * @param hash key 的哈希值
      * @return true 返回幽灵缓存是否命中
      * @return false 
      */
-    bool checkGhost(Key key) 
+    bool checkGhost(const Key& key, size_t hash) 
     {
-        auto it = ghostCache_.find(key);
-        if (it != ghostCache_.end()) 
+        NodePtr* node = ghostCache_.find(key, hash);
+        if (node) 
         {
-            removeFromGhost(it->second);
-            ghostCache_.erase(it);
+            removeFromGhost(*node);
+            ghostCache_.erase(key, hash);
             return true;
         }
         return false;
@@ -123,7 +143,60 @@ public:
         return true;
     }
 
+    /**
+     * @brief 设置淘汰回调 节点离开主缓存(进入幽灵缓存)时调用 由 KArcCache 统一注册
+     * 
+     * @param callback 
+     */
+    void setEvictCallback(EvictCallback callback) { evictCallback_ = std::move(callback); }
+
+    /**
+     * @brief 运行期调整容量 缩容时不立即淘汰 由之后的写入或 trim 分批完成
+     * 
+     * @param capacity 主缓存容量
+     * @param ghostCapacity 幽灵缓存容量
+     */
+    void setCapacity(size_t capacity, size_t ghostCapacity)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capacity_ = capacity;
+        ghostCapacity_ = ghostCapacity;
+    }
+
+    size_t capacity()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return capacity_;
+    }
+
+    // 最多淘汰 budget 个节点(收缩幽灵缓存也计入) budget 减去实际用掉的数量 返回之后仍超出的数量
+    size_t trim(size_t& budget)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return trimLocked(budget);
+    }
+
 private:
+    static constexpr size_t kTrimBatch = 8; // 每次写入额外淘汰的上限 与 KICachePolicy 一致
+
+    // 先淘汰主缓存中多出的节点 再收缩幽灵缓存
+    // 写入时顺带回收 最多 kTrimBatch 个
+    void trimBatch()
+    {
+        size_t budget = kTrimBatch;
+        trimLocked(budget);
+    }
+
+    // maxEvictions 按引用传入 返回时为未用完的配额
+    size_t trimLocked(size_t& maxEvictions)
+    {
+        for (; maxEvictions > 0 && mainCache_.size() > capacity_; --maxEvictions)
+            evictLeastFrequent();
+        for (; maxEvictions > 0 && ghostCache_.size() > ghostCapacity_; --maxEvictions)
+            removeOldestGhost();
+        return mainCache_.size() > capacity_ ? mainCache_.size() - capacity_ : 0;
+    }
+
     /**
      * @brief 初始化一个LFU缓存 包括了幽灵表的头尾哨兵节点
      * 
@@ -159,16 +232,17 @@ private:
      * @return true 
      * @return false 
      */
-    bool addNewNode(const Key& key, const Value& value) 
+    bool addNewNode(const Key& key, const Value& value, size_t hash) 
     {
+        trimBatch(); // 缩容后多出的节点分批淘汰
         // LFU容量超出 则需要清理缓存
         if (mainCache_.size() >= capacity_) 
         {
             evictLeastFrequent();
         }
 
-        NodePtr newNode = std::make_shared<NodeType>(key, value);
-        mainCache_[key] = newNode;
+        NodePtr newNode = std::make_shared<NodeType>(key, value, hash);
+        mainCache_.insert(hash, newNode);
         
         // 将新节点添加到频率为1的列表中
         if (freqMap_.find(1) == freqMap_.end()) 
@@ -255,8 +329,10 @@ private:
         // 将节点移到幽灵缓存
         addToGhost(leastNode);
         
-        // 从主缓存中移除键值对
-        mainCache_.erase(leastNode->getKey());
+        // 从主缓存中移除键值对 按节点保存的哈希删除 不再对 key 重新求哈希
+        mainCache_.eraseNode(leastNode);
+        if (evictCallback_)
+            evictCallback_(leastNode->getKey(), leastNode->getValue());
     }
 
     void removeFromGhost(NodePtr node) 
@@ -282,7 +358,7 @@ private:
             ghostTail_->prev_.lock()->next_ = node;
         }
         ghostTail_->prev_ = node;
-        ghostCache_[node->getKey()] = node;
+        ghostCache_.insert(node->getHash(), node); // 复用节点中的哈希值
     }
 
     void removeOldestGhost() 
@@ -293,7 +369,7 @@ private:
         {
             removeFromGhost(oldestGhost);
             // 从幽灵缓存中清除键值对
-            ghostCache_.erase(oldestGhost->getKey());
+            ghostCache_.eraseNode(oldestGhost);
         }
     }
 
@@ -310,6 +386,8 @@ private:
     
     NodePtr ghostHead_;  // 幽灵表的哨兵头
     NodePtr ghostTail_;  // 幽灵表的哨兵尾
+
+    EvictCallback evictCallback_; // 淘汰回调 为空时不做任何事
 };
 
 } // namespace KamaCache
\ No newline at end of file
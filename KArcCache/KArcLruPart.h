@@ -1,6 +1,8 @@
 #pragma once
 
 #include "KArcCacheNode.h"
+#include "../KHashIndex.h"
+#include <functional>
 #include <unordered_map>
 #include <mutex>
 
@@ -13,7 +15,8 @@ class ArcLruPart
 public:
     using NodeType = ArcNode<Key, Value>;
     using NodePtr = std::shared_ptr<NodeType>;
-    using NodeMap = std::unordered_map<Key, NodePtr>;
+    using NodeMap = KHashIndex<Key, NodePtr>;
+    using EvictCallback = std::function<void(const Key&, const Value&)>;
 
     /**
      * @brief 构造函数
@@ -34,22 +37,38 @@ public:
      * 
      * @param key 
      * @param value 
+     * @param hash key 的哈希值 由 KArcCache 计算一次后传入
      * @param shouldTransform
      * @return true 
      * @return false 
      */
-    bool put(Key key, Value value, bool& shouldTransform) 
+    bool put(const Key& key, const Value& value, size_t hash, bool& shouldTransform) 
     {
-        if (capacity_ == 0) return false;
         // 查找缓存表 更新数据/写入数据
         std::lock_guard<std::mutex> lock(mutex_);
-        auto it = mainCache_.find(key);
-        if (it != mainCache_.end()) 
+        NodePtr* node = mainCache_.find(key, hash);
+        if (node) 
         {
-            shouldTransform = checkTransform(it->second);
-            return updateExistingNode(it->second, value); // 更新
+            shouldTransform = checkTransform(*node);
+            return updateExistingNode(*node, value); // 更新
         }
-        return addNewNode(key, value);
+        if (capacity_ == 0)
+        {
+            trimBatch();
+            return false;
+        }
+        return addNewNode(key, value, hash);
+    }
+
+    // 只更新主缓存中已存在节点的值 不改变访问状态
+    bool update(const Key& key, const Value& value, size_t hash)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        NodePtr* node = mainCache_.find(key, hash);
+        if (!node)
+            return false;
+        (*node)->setValue(value);
+        return true;
     }
 
     /**
@@ -57,18 +76,19 @@ public:
      * 
      * @param key 
      * @param value 浅拷贝 用于返回数值
+     * @param hash key 的哈希值
      * @param shouldTransform 浅拷贝 用于ARC判断是否加入LFU中
      * @return true 返回布尔型 用于判断是否找到该节点
      * @return false 
      */
-    bool get(Key key, Value& value, bool& shouldTransform) 
+    bool get(const Key& key, Value& value, size_t hash, bool& shouldTransform) 
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        auto it = mainCache_.find(key);
-        if (it != mainCache_.end()) 
+        NodePtr* node = mainCache_.find(key, hash);
+        if (node) 
         {
-            shouldTransform = updateNodeAccess(it->second);
-            value = it->second->getValue();
+            shouldTransform = updateNodeAccess(*node);
+            value = (*node)->getValue();
             return true;
         }
         return false;
@@ -78,15 +98,16 @@ public:
      * @brief 幽灵缓存命中 将其从幽灵缓存中删除
      * 
      * @param key 
+     * @param hash key 的哈希值
      * @return true 
      * @return false 
      */
-    bool checkGhost(Key key) 
+    bool checkGhost(const Key& key, size_t hash) 
     {
-        auto it = ghostCache_.find(key);
-        if (it != ghostCache_.end()) {
-            removeFromGhost(it->second);
-            ghostCache_.erase(it);
+        NodePtr* node = ghostCache_.find(key, hash);
+        if (node) {
+            removeFromGhost(*node);
+            ghostCache_.erase(key, hash);
             return true;
         }
         return false;
@@ -114,20 +135,76 @@ public:
         return true;
     }
 
-    void deleteNodeFromMain(Key key) {
-        auto it = mainCache_.find(key);
-        if (it != mainCache_.end()) {
-            auto node = it->second;
+    // 晋升到 LFU 的节点从主链表与索引中一起删除 否则索引中残留的节点会让条目数与链表不一致
+    void deleteNodeFromMain(const Key& key, size_t hash) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        NodePtr* found = mainCache_.find(key, hash);
+        if (found) {
+            auto node = *found;
             if (!node->prev_.expired() && node->next_) {
             auto prev = node->prev_.lock();
             prev->next_ = node->next_;
             node->next_->prev_ = node->prev_;
             node->next_ = nullptr; // 清空指针，防止悬垂引用
             }
+            mainCache_.eraseNode(node);
         }
     }
 
+    /**
+     * @brief 设置淘汰回调 节点离开主缓存(进入幽灵缓存)时调用 由 KArcCache 统一注册
+     * 
+     * @param callback 
+     */
+    void setEvictCallback(EvictCallback callback) { evictCallback_ = std::move(callback); }
+
+    /**
+     * @brief 运行期调整容量 缩容时不立即淘汰 由之后的写入或 trim 分批完成
+     * 
+     * @param capacity 主缓存容量
+     * @param ghostCapacity 幽灵缓存容量
+     */
+    void setCapacity(size_t capacity, size_t ghostCapacity)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capacity_ = capacity;
+        ghostCapacity_ = ghostCapacity;
+    }
+
+    size_t capacity()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return capacity_;
+    }
+
+    // 最多淘汰 budget 个节点(收缩幽灵缓存也计入) budget 减去实际用掉的数量 返回之后仍超出的数量
+    size_t trim(size_t& budget)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return trimLocked(budget);
+    }
+
 private:
+    static constexpr size_t kTrimBatch = 8; // 每次写入额外淘汰的上限 与 KICachePolicy 一致
+
+    // 先淘汰主缓存中多出的节点 再收缩幽灵缓存
+    // 写入时顺带回收 最多 kTrimBatch 个
+    void trimBatch()
+    {
+        size_t budget = kTrimBatch;
+        trimLocked(budget);
+    }
+
+    // maxEvictions 按引用传入 返回时为未用完的配额
+    size_t trimLocked(size_t& maxEvictions)
+    {
+        for (; maxEvictions > 0 && mainCache_.size() > capacity_; --maxEvictions)
+            evictLeastRecent();
+        for (; maxEvictions > 0 && ghostCache_.size() > ghostCapacity_; --maxEvictions)
+            removeOldestGhost();
+        return mainCache_.size() > capacity_ ? mainCache_.size() - capacity_ : 0;
+    }
+
     /**
      * @brief 初始化函数 构造缓存表与幽灵表的哨兵节点
      * 
@@ -152,15 +229,16 @@ private:
         return true;
     }
 
-    bool addNewNode(const Key& key, const Value& value) 
+    bool addNewNode(const Key& key, const Value& value, size_t hash) 
     {
+        trimBatch(); // 缩容后多出的节点分批淘汰
         if (mainCache_.size() >= capacity_) 
         {   
             evictLeastRecent(); // 驱逐最近最少访问
         }
 
-        NodePtr newNode = std::make_shared<NodeType>(key, value);
-        mainCache_[key] = newNode;
+        NodePtr newNode = std::make_shared<NodeType>(key, value, hash);
+        mainCache_.insert(hash, newNode);
         addToFront(newNode);
         return true;
     }
@@ -237,8 +315,10 @@ private:
         }
         addToGhost(leastRecent);
 
-        // 从主缓存映射中移除
-        mainCache_.erase(leastRecent->getKey());
+        // 从主缓存映射中移除 按节点保存的哈希删除 不再对 key 重新求哈希
+        mainCache_.eraseNode(leastRecent);
+        if (evictCallback_)
+            evictCallback_(leastRecent->getKey(), leastRecent->getValue());
     }
 
     void removeFromMain(NodePtr node) 
@@ -272,8 +352,8 @@ private:
         ghostHead_->next_->prev_ = node;
         ghostHead_->next_ = node;
         
-        // 添加到幽灵缓存映射
-        ghostCache_[node->getKey()] = node;
+        // 添加到幽灵缓存映射 复用节点中的哈希值
+        ghostCache_.insert(node->getHash(), node);
     }
 
     void removeOldestGhost() 
@@ -284,7 +364,7 @@ private:
             return;
 
         removeFromGhost(oldestGhost);
-        ghostCache_.erase(oldestGhost->getKey());
+        ghostCache_.eraseNode(oldestGhost);
     }
     
 
@@ -303,6 +383,8 @@ private:
     // 淘汰链表
     NodePtr ghostHead_; // 幽灵缓存的哨兵节点头
     NodePtr ghostTail_; // 幽灵缓存的哨兵节点尾
+
+    EvictCallback evictCallback_; // 淘汰回调 为空时不做任何事
 };
 
 } // namespace KamaCache
\ No newline at end of file
@@ -0,0 +1,303 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+
+#include "../KHashIndex.h"
+#include "../KICachePolicy.h"
+#include "../KShardedCache.h"
+
+namespace KamaCache
+{
+
+template<typename Key, typename Value> class KCarCache;
+
+/**
+ * @brief CAR 缓存节点
+ * 驻留节点位于时钟 T1/T2 中，幽灵节点位于 B1/B2 中只保留 key 与哈希。
+ */
+template<typename Key, typename Value>
+class CarNode
+{
+private:
+    enum class Where { T1, T2, B1, B2 };
+    using ListIter = typename std::list<std::shared_ptr<CarNode>>::iterator;
+
+    Key               key_;
+    Value             value_;
+    size_t            hash_;       // key 的哈希值
+    std::atomic<bool> referenced_; // 引用位 命中时在共享锁下置位
+    Where             where_;      // 所在的列表
+    ListIter          pos_;        // 在所在列表中的位置
+
+public:
+    CarNode(Key key, Value value, size_t hash)
+        : key_(key)
+        , value_(value)
+        , hash_(hash)
+        , referenced_(false)
+        , where_(Where::T1)
+    {}
+
+    const Key& getKey() const { return key_; }
+    size_t getHash() const { return hash_; }
+    Value getValue() const { return value_; }
+    void setValue(const Value& value) { value_ = value; }
+
+    friend class KCarCache<Key, Value>;
+};
+
+/**
+ * @brief CAR (Clock with Adaptive Replacement) 淘汰策略
+ *
+ * 与 KArcCache 一样按 "最近访问一次(T1)" 与 "访问过多次(T2)" 划分缓存，
+ * 并根据幽灵列表 B1/B2 的命中自适应调整 T1 的目标大小 p_，区别在于：
+ * 1. T1、T2 是时钟(FIFO + 引用位)而不是 LRU 链表，命中只在共享锁下设置原子引用位，
+ *    不移动节点、不在 LRU/LFU 两部分之间迁移，多个读者可以并发命中。
+ * 2. 所有结构调整集中在未命中后的淘汰中：时钟指针扫描到引用位为 1 的 T1 节点时将其移入 T2，
+ *    扫描到引用位为 1 的 T2 节点时清零后放回队尾，遇到引用位为 0 的节点才淘汰并记入对应的幽灵列表。
+ * 3. 幽灵命中时按 |B2|/|B1| (或 |B1|/|B2|) 调整 p_，与 ARC 的自适应规则相同，
+ *    幽灵列表总长度不超过容量，元数据内存有界。
+ */
+template<typename Key, typename Value>
+class KCarCache : public KICachePolicy<Key, Value>
+{
+public:
+    using NodeType = CarNode<Key, Value>;
+    using NodePtr = std::shared_ptr<NodeType>;
+    using NodeList = std::list<NodePtr>;
+    using NodeMap = KHashIndex<Key, NodePtr>;
+    using Where = typename NodeType::Where;
+
+    explicit KCarCache(size_t capacity = 10)
+        : capacity_(capacity)
+        , p_(0)
+    {}
+
+    ~KCarCache() override = default;
+
+    void put(Key key, Value value) override
+    {
+        put(key, value, KHashOf(key));
+    }
+
+    // 使用调用方预先算好的哈希值 要求 hash == KHashOf(key)
+    void put(const Key& key, const Value& value, size_t hash)
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        NodePtr* found = nodeMap_.find(key, hash);
+        NodePtr node = found ? *found : nullptr;
+        if (node && (node->where_ == Where::T1 || node->where_ == Where::T2))
+        {
+            node->setValue(value);
+            node->referenced_.store(true, std::memory_order_relaxed);
+            return;
+        }
+
+        if (capacity_ == 0)
+        {
+            trimLocked(this->kTrimBatch);
+            return;
+        }
+        trimLocked(this->kTrimBatch);
+        if (t1_.size() + t2_.size() >= capacity_)
+        {
+            replace();
+            if (!node)
+            {
+                // 新 key 不在幽灵列表中 控制幽灵列表的长度
+                if (t1_.size() + b1_.size() >= capacity_)
+                    discardGhost(b1_);
+                else if (t1_.size() + t2_.size() + b1_.size() + b2_.size() >= 2 * capacity_)
+                    discardGhost(b2_);
+            }
+        }
+
+        if (!node)
+        {
+            node = std::make_shared<NodeType>(key, value, hash);
+            pushBack(t1_, node, Where::T1);
+            nodeMap_.insert(hash, node);
+            return;
+        }
+
+        // 幽灵命中：按两个幽灵列表的长度比调整 T1 的目标大小 然后直接进入 T2
+        if (node->where_ == Where::B1)
+        {
+            size_t delta = std::max<size_t>(1, b2_.size() / std::max<size_t>(1, b1_.size()));
+            p_ = std::min(p_ + delta, capacity_);
+            b1_.erase(node->pos_);
+        }
+        else
+        {
+            size_t delta = std::max<size_t>(1, b1_.size() / std::max<size_t>(1, b2_.size()));
+            p_ = p_ > delta ? p_ - delta : 0;
+            b2_.erase(node->pos_);
+        }
+        node->setValue(value);
+        node->referenced_.store(false, std::memory_order_relaxed);
+        pushBack(t2_, node, Where::T2);
+    }
+
+    bool get(Key key, Value& value) override
+    {
+        return get(key, value, KHashOf(key));
+    }
+
+    // 命中只需共享锁：设置原子引用位并拷贝数据 不修改任何列表
+    bool get(const Key& key, Value& value, size_t hash)
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        const NodeMap& index = nodeMap_;
+        const NodePtr* found = index.find(key, hash);
+        if (!found)
+            return false;
+        const NodePtr& node = *found;
+        if (node->where_ != Where::T1 && node->where_ != Where::T2)
+            return false; // 幽灵节点只有 key 没有数据
+        // 已经置位时不再写 避免多个读者反复写同一缓存行
+        if (!node->referenced_.load(std::memory_order_relaxed))
+            node->referenced_.store(true, std::memory_order_relaxed);
+        value = node->getValue();
+        return true;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 只更新 T1/T2 中节点的值 不设置引用位 幽灵节点视为不存在
+    bool updateIfPresent(Key key, Value value) override
+    {
+        size_t hash = KHashOf(key);
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        NodePtr* found = nodeMap_.find(key, hash);
+        if (!found || ((*found)->where_ != Where::T1 && (*found)->where_ != Where::T2))
+            return false;
+        (*found)->setValue(value);
+        return true;
+    }
+
+    // 当前 T1 的目标大小 用于观察自适应过程
+    size_t target() const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return p_;
+    }
+
+    void setCapacity(size_t capacity) override
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        capacity_ = capacity;
+        p_ = std::min(p_, capacity_);
+    }
+
+    size_t trim(size_t maxEvictions) override
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        return trimLocked(maxEvictions);
+    }
+
+private:
+    // 先淘汰多出的驻留节点 再把幽灵列表的总长度收缩到 2 * capacity 以内
+    size_t trimLocked(size_t maxEvictions)
+    {
+        for (; maxEvictions > 0 && t1_.size() + t2_.size() > capacity_; --maxEvictions)
+            replace();
+        for (; maxEvictions > 0 && t1_.size() + t2_.size() + b1_.size() + b2_.size() > 2 * capacity_; --maxEvictions)
+        {
+            if (b1_.empty() && b2_.empty())
+                break;
+            discardGhost(b1_.size() >= b2_.size() ? b1_ : b2_);
+        }
+        size_t resident = t1_.size() + t2_.size();
+        return resident > capacity_ ? resident - capacity_ : 0;
+    }
+
+    // 列表头为最旧(时钟指针所在位置) 列表尾为最新
+    static void pushBack(NodeList& list, const NodePtr& node, Where where)
+    {
+        node->where_ = where;
+        node->pos_ = list.insert(list.end(), node);
+    }
+
+    // 在列表之间移动节点 splice 不会使迭代器失效
+    static void moveBack(NodeList& to, NodeList& from, const NodePtr& node, Where where)
+    {
+        to.splice(to.end(), from, node->pos_);
+        node->where_ = where;
+    }
+
+    /**
+     * @brief 时钟淘汰：按目标大小 p_ 选择从 T1 还是 T2 淘汰 淘汰恰好一个驻留节点
+     */
+    void replace()
+    {
+        while (true)
+        {
+            if (!t1_.empty() && (t1_.size() >= std::max<size_t>(1, p_) || t2_.empty()))
+            {
+                NodePtr node = t1_.front();
+                if (!node->referenced_.load(std::memory_order_relaxed))
+                {
+                    demote(t1_, b1_, node, Where::B1);
+                    return;
+                }
+                // 在 T1 中被再次访问过 说明访问不止一次 移入 T2
+                node->referenced_.store(false, std::memory_order_relaxed);
+                moveBack(t2_, t1_, node, Where::T2);
+            }
+            else
+            {
+                NodePtr node = t2_.front();
+                if (!node->referenced_.load(std::memory_order_relaxed))
+                {
+                    demote(t2_, b2_, node, Where::B2);
+                    return;
+                }
+                node->referenced_.store(false, std::memory_order_relaxed);
+                moveBack(t2_, t2_, node, Where::T2);
+            }
+        }
+    }
+
+    // 淘汰驻留节点 只保留 key 放入幽灵列表
+    void demote(NodeList& from, NodeList& ghost, const NodePtr& node, Where where)
+    {
+        this->onEvict(node->getKey(), node->getValue());
+        node->setValue(Value{});
+        moveBack(ghost, from, node, where);
+    }
+
+    void discardGhost(NodeList& ghost)
+    {
+        if (ghost.empty())
+            return;
+        NodePtr node = ghost.front();
+        ghost.pop_front();
+        nodeMap_.eraseNode(node);
+    }
+
+private:
+    size_t                    capacity_; // 驻留条目的最大数量
+    size_t                    p_;        // T1 的目标大小 由幽灵命中自适应调整
+    NodeList                  t1_;       // 最近只访问过一次的驻留节点
+    NodeList                  t2_;       // 访问过多次的驻留节点
+    NodeList                  b1_;       // 从 T1 淘汰的幽灵节点
+    NodeList                  b2_;       // 从 T2 淘汰的幽灵节点
+    NodeMap                   nodeMap_;  // key -> 节点 的索引 包含幽灵节点
+    mutable std::shared_mutex mutex_;    // 读写锁 命中走共享锁 修改结构走独占锁
+};
+
+// CAR 的分片版本：命中只需分片内的共享锁
+template<typename Key, typename Value>
+using KHashCarCache = KShardedCache<Key, Value, KCarCache<Key, Value>>;
+
+} // namespace KamaCache
@@ -0,0 +1,398 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "../KICachePolicy.h"
+#include "KCachePolicies.h"
+#include "KEvictionPolicies.h"
+#include "KLockPolicies.h"
+
+namespace KamaCache
+{
+
+// KCache 的节点：淘汰策略的侵入式字段通过 CRTP 继承进来
+template<typename Key, typename Value, typename Eviction>
+struct KCacheNode : Eviction::template Hook<KCacheNode<Key, Value, Eviction>>
+{
+    using KeyType = Key;
+
+    Key    key{};
+    Value  value{};
+    size_t hash = 0;
+    KCacheNode* nextFree = nullptr; // 空闲链表
+
+    const Key& getKey() const { return key; }
+    size_t getHash() const { return hash; }
+};
+
+/**
+ * @brief 编译期组合的缓存
+ *
+ * 原有各策略通过 KICachePolicy 的虚函数调用，并且各自固定使用 unordered_map 索引、std::mutex 与各自的节点分配。
+ * KCache 把这几部分拆成模板参数，在编译期组合出一个没有虚函数、可以完全内联的缓存：
+ * - Eviction：淘汰策略 KLruEviction / KLfuEviction / KArcEviction (KEvictionPolicies.h)
+ * - Index：   索引策略 KOpenAddressIndex / KStdMapIndex
+ * - Lock：    锁策略   KMutexLock / KNoLock / KSpinLock / KSharedMutexLock / KFlatCombiningLock (KLockPolicies.h)
+ * - Admission：准入策略 KAdmitAll / KDoorkeeperAdmission
+ * - Stats：   统计策略 KNoStats / KCountingStats
+ * 节点在构造时一次性分配(扩容时追加)，淘汰后直接复用，不在访问路径上分配内存。
+ *
+ * 锁策略支持共享读(KSharedMutexLock)时，读操作在共享锁下只查找与复制值，不修改淘汰顺序；
+ * 命中的节点记录到一个有损的环形读缓冲区，由下一次持有独占锁的写操作(或读缓冲区写满时抢到独占锁的读线程)
+ * 统一补做 onAccess。缓冲区被覆盖的记录直接丢弃，淘汰顺序因此是近似的。
+ * 需要运行期多态时用 KCachePolicyAdapter 包装成 KICachePolicy。
+ */
+template<typename Key, typename Value,
+         typename Eviction = KLruEviction,
+         typename Index = KOpenAddressIndex,
+         typename Lock = KMutexLock,
+         typename Admission = KAdmitAll,
+         typename Stats = KNoStats>
+class KCache
+{
+public:
+    using Node = KCacheNode<Key, Value, Eviction>;
+    using EvictCallback = std::function<void(const Key&, const Value&)>;
+
+    explicit KCache(size_t capacity)
+        : capacity_(capacity)
+        , poolSize_(capacity)
+        , nodes_(new Node[capacity > 0 ? capacity : 1])
+        , used_(0)
+        , freeList_(nullptr)
+        , index_(capacity)
+        , eviction_(capacity)
+        , admission_(capacity)
+        , readBuffer_(Lock::kSharedReads ? new ReadBuffer : nullptr)
+    {}
+
+    void put(const Key& key, const Value& value)
+    {
+        put(key, value, KHashOf(key));
+    }
+
+    // 使用调用方预先算好的哈希值 要求 hash == KHashOf(key)
+    void put(const Key& key, const Value& value, size_t hash)
+    {
+        lock_.execute([&] {
+            drainReads();
+            Node** found = index_.find(key, hash);
+            if (found)
+            {
+                Node* node = *found;
+                node->value = value;
+                eviction_.onAccess(node);
+                return;
+            }
+            if (capacity_ == 0)
+            {
+                trimLocked(kTrimBatch);
+                return;
+            }
+            if (!admission_.admit(hash))
+            {
+                stats_.reject();
+                return;
+            }
+
+            Node* node = acquireNode();
+            node->key = key;
+            node->value = value;
+            node->hash = hash;
+            index_.insert(hash, node);
+            eviction_.onInsert(node);
+        });
+    }
+
+    bool get(const Key& key, Value& value)
+    {
+        return get(key, value, KHashOf(key));
+    }
+
+    bool get(const Key& key, Value& value, size_t hash)
+    {
+        return getImpl(key, value, hash, std::integral_constant<bool, Lock::kSharedReads>());
+    }
+
+    Value get(const Key& key)
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 只更新已存在条目的值 不通知淘汰策略 也不经过准入
+    bool updateIfPresent(const Key& key, const Value& value)
+    {
+        size_t hash = KHashOf(key);
+        bool updated = false;
+        lock_.execute([&] {
+            Node** found = index_.find(key, hash);
+            if (!found)
+                return;
+            (*found)->value = value;
+            updated = true;
+        });
+        return updated;
+    }
+
+    bool remove(const Key& key)
+    {
+        size_t hash = KHashOf(key);
+        bool removed = false;
+        lock_.execute([&] {
+            drainReads();
+            Node** found = index_.find(key, hash);
+            if (!found)
+                return;
+            Node* node = *found;
+            eviction_.onErase(node);
+            index_.eraseNode(node);
+            node->nextFree = freeList_;
+            freeList_ = node;
+            removed = true;
+        });
+        return removed;
+    }
+
+    // 淘汰回调 只在容量淘汰时调用 持有缓存锁
+    void setEvictCallback(EvictCallback callback)
+    {
+        lock_.execute([&] { evictCallback_ = std::move(callback); });
+    }
+
+    size_t size()
+    {
+        size_t result = 0;
+        lock_.execute([&] { result = index_.size(); });
+        return result;
+    }
+
+    size_t capacity()
+    {
+        size_t result = 0;
+        lock_.execute([&] { result = capacity_; });
+        return result;
+    }
+
+    /**
+     * @brief 运行期调整容量
+     *
+     * 扩容超过节点池大小时追加一块节点池，新节点全部放入空闲链表，已有节点的地址不变；缩容不释放节点池。
+     * 缩容时不立即淘汰，由之后的写入每次最多多淘汰 kTrimBatch 个，或由 trim 分批完成。
+     */
+    void setCapacity(size_t capacity)
+    {
+        lock_.execute([&] {
+            if (capacity > poolSize_)
+            {
+                size_t extra = capacity - poolSize_;
+                std::unique_ptr<Node[]> pool(new Node[extra]);
+                for (size_t i = 0; i < extra; ++i)
+                {
+                    pool[i].nextFree = freeList_;
+                    freeList_ = &pool[i];
+                }
+                extraPools_.push_back(std::move(pool));
+                poolSize_ = capacity;
+            }
+            capacity_ = capacity;
+            eviction_.resize(capacity);
+        });
+    }
+
+    // 最多淘汰 maxEvictions 个超出容量的节点 返回之后仍超出的数量
+    size_t trim(size_t maxEvictions)
+    {
+        size_t remaining = 0;
+        lock_.execute([&] {
+            drainReads();
+            remaining = trimLocked(maxEvictions);
+        });
+        return remaining;
+    }
+
+    // 统计数据的快照
+    Stats stats()
+    {
+        std::unique_ptr<Stats> result;
+        lock_.execute([&] { result.reset(new Stats(stats_)); });
+        return *result;
+    }
+
+private:
+    static constexpr size_t kReadBufferSize = 128;
+    static constexpr size_t kTrimBatch = 8; // 缩容后每次写入额外淘汰的上限
+
+    // 共享读模式下记录命中节点的有损环形缓冲区
+    struct ReadBuffer
+    {
+        std::atomic<Node*>    slots[kReadBufferSize] = {};
+        std::atomic<uint32_t> writeIndex{0};
+    };
+
+    // 独占执行的读取：命中时直接更新淘汰顺序
+    bool getImpl(const Key& key, Value& value, size_t hash, std::false_type)
+    {
+        bool hit = false;
+        lock_.execute([&] {
+            Node** found = index_.find(key, hash);
+            if (!found)
+                return;
+            Node* node = *found;
+            eviction_.onAccess(node);
+            value = node->value;
+            hit = true;
+        });
+        if (hit)
+            stats_.hit();
+        else
+            stats_.miss();
+        return hit;
+    }
+
+    // 共享锁下的读取：只查找与复制值 命中记录到读缓冲区
+    bool getImpl(const Key& key, Value& value, size_t hash, std::true_type)
+    {
+        Node* node = nullptr;
+        lock_.executeShared([&] {
+            Node** found = index_.find(key, hash);
+            if (!found)
+                return;
+            node = *found;
+            value = node->value;
+        });
+        if (!node)
+        {
+            stats_.miss();
+            return false;
+        }
+        stats_.hit();
+        uint32_t index = readBuffer_->writeIndex.fetch_add(1, std::memory_order_relaxed);
+        readBuffer_->slots[index % kReadBufferSize].store(node, std::memory_order_relaxed);
+        if (index % kReadBufferSize == kReadBufferSize - 1)
+            lock_.tryExecute([this] { drainReads(); });
+        return true;
+    }
+
+    // 补做读缓冲区中记录的访问 持有独占锁
+    // 节点可能已被淘汰或复用：仍在索引中才补做 复用后换成其他 key 的节点会被多提升一次 不影响正确性
+    void drainReads()
+    {
+        if (!Lock::kSharedReads)
+            return;
+        for (std::atomic<Node*>& slot : readBuffer_->slots)
+        {
+            Node* node = slot.exchange(nullptr, std::memory_order_relaxed);
+            if (!node)
+                continue;
+            Node** found = index_.find(node->key, node->hash);
+            if (found && *found == node)
+                eviction_.onAccess(node);
+        }
+    }
+
+    // 取得一个空闲节点 缓存已满时淘汰一个节点并复用它 持有锁
+    Node* acquireNode()
+    {
+        trimLocked(kTrimBatch);
+        if (index_.size() >= capacity_)
+            return evictOne();
+        if (freeList_)
+        {
+            Node* node = freeList_;
+            freeList_ = node->nextFree;
+            return node;
+        }
+        return &nodes_[used_++];
+    }
+
+    // 淘汰一个节点并返回它 持有锁
+    Node* evictOne()
+    {
+        Node* victim = eviction_.victim();
+        eviction_.onEvict(victim);
+        index_.eraseNode(victim);
+        stats_.evict();
+        if (evictCallback_)
+            evictCallback_(victim->key, victim->value);
+        return victim;
+    }
+
+    // 被淘汰的节点归还空闲链表 持有锁
+    size_t trimLocked(size_t maxEvictions)
+    {
+        while (maxEvictions-- > 0 && index_.size() > capacity_)
+        {
+            Node* node = evictOne();
+            node->nextFree = freeList_;
+            freeList_ = node;
+        }
+        return index_.size() > capacity_ ? index_.size() - capacity_ : 0;
+    }
+
+private:
+    using IndexType = typename Index::template type<Key, Node>;
+    using EvictionType = typename Eviction::template Policy<Node>;
+
+    size_t                      capacity_;
+    size_t                      poolSize_;   // 所有节点池的节点总数 不小于容量
+    std::unique_ptr<Node[]>     nodes_;      // 构造时的节点池 地址不变 索引与淘汰策略直接保存节点指针
+    size_t                      used_;       // nodes_ 中已经分配过的节点数
+    std::vector<std::unique_ptr<Node[]>> extraPools_; // 扩容时追加的节点池 节点在追加时全部放入空闲链表
+    Node*                       freeList_;   // remove 归还的节点
+    IndexType                   index_;
+    EvictionType                eviction_;
+    Admission                   admission_;
+    Stats                       stats_;
+    EvictCallback               evictCallback_;
+    std::unique_ptr<ReadBuffer> readBuffer_; // 只在共享读模式下分配
+    Lock                        lock_;
+};
+
+/**
+ * @brief 把任意 KCache 组合包装成 KICachePolicy 需要运行期选择策略时使用
+ *
+ * 每次调用多一次虚函数分发，组合内部的调用仍然是内联的。
+ */
+template<typename Key, typename Value, typename Cache>
+class KCachePolicyAdapter : public KICachePolicy<Key, Value>
+{
+public:
+    template<typename... Args>
+    explicit KCachePolicyAdapter(Args&&... args)
+        : cache_(std::forward<Args>(args)...)
+    {
+        cache_.setEvictCallback([this](const Key& key, const Value& value) { this->onEvict(key, value); });
+    }
+
+    ~KCachePolicyAdapter() override = default;
+
+    void put(Key key, Value value) override { cache_.put(key, value); }
+    bool get(Key key, Value& value) override { return cache_.get(key, value); }
+    Value get(Key key) override { return cache_.get(key); }
+    bool updateIfPresent(Key key, Value value) override { return cache_.updateIfPresent(key, value); }
+    void setCapacity(size_t capacity) override { cache_.setCapacity(capacity); }
+    size_t trim(size_t maxEvictions) override { return cache_.trim(maxEvictions); }
+
+    Cache& cache() { return cache_; }
+
+private:
+    Cache cache_;
+};
+
+// 常用组合
+template<typename Key, typename Value>
+using KStaticLruCache = KCache<Key, Value, KLruEviction>;
+
+template<typename Key, typename Value>
+using KStaticLfuCache = KCache<Key, Value, KLfuEviction>;
+
+template<typename Key, typename Value>
+using KStaticArcCache = KCache<Key, Value, KArcEviction>;
+
+} // namespace KamaCache
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+
+#include "../KHashIndex.h"
+#include "../KAdmission/KBlockedBloomFilter.h"
+#include "KLockPolicies.h"
+
+namespace KamaCache
+{
+
+// =========================================================================
+// KCache 的索引、锁、准入、统计策略
+//
+// 每个策略都是普通的类，KCache 以模板参数的形式组合它们，所有调用在编译期确定并可以内联。
+// 淘汰策略见 KEvictionPolicies.h，锁策略见 KLockPolicies.h。
+// 索引策略通过嵌套模板 type<Key, Node> 得到具体的索引类型。
+// =========================================================================
+
+// ---------------------------- 索引策略 ----------------------------
+
+// 开放寻址索引 使用预计算哈希 (默认)
+struct KOpenAddressIndex
+{
+    template<typename Key, typename Node>
+    using type = KHashIndex<Key, Node*>;
+};
+
+// std::unordered_map 索引 与原有各策略的实现方式一致 用于对比
+struct KStdMapIndex
+{
+    template<typename Key, typename Node>
+    class type
+    {
+    public:
+        explicit type(size_t capacity) { map_.reserve(capacity); }
+
+        Node** find(const Key& key, size_t)
+        {
+            auto it = map_.find(key);
+            return it == map_.end() ? nullptr : &it->second;
+        }
+
+        void insert(size_t, Node* node) { map_.emplace(node->getKey(), node); }
+        void eraseNode(Node* node) { map_.erase(node->getKey()); }
+        size_t size() const { return map_.size(); }
+        void clear() { map_.clear(); }
+
+    private:
+        std::unordered_map<Key, Node*> map_;
+    };
+};
+
+// ---------------------------- 锁策略 ----------------------------
+// 见 KLockPolicies.h
+
+// ---------------------------- 准入策略 ----------------------------
+
+// 全部准入
+struct KAdmitAll
+{
+    explicit KAdmitAll(size_t) {}
+    bool admit(size_t) { return true; }
+};
+
+/**
+ * @brief 布隆过滤器门卫准入 与 KDoorkeeperCache 相同：key 在一个窗口内第二次写入才被准入
+ */
+class KDoorkeeperAdmission
+{
+public:
+    // 窗口大小取缓存容量的 4 倍
+    explicit KDoorkeeperAdmission(size_t capacity)
+        : windowSize_(capacity > 0 ? capacity * 4 : 1)
+        , current_(windowSize_)
+        , previous_(windowSize_)
+        , currentCount_(0)
+    {}
+
+    bool admit(size_t hash)
+    {
+        if (current_.contains(hash) || previous_.contains(hash))
+            return true;
+        current_.insert(hash);
+        if (++currentCount_ >= windowSize_)
+        {
+            std::swap(current_, previous_);
+            current_.clear();
+            currentCount_ = 0;
+        }
+        return false;
+    }
+
+private:
+    size_t              windowSize_;
+    KBlockedBloomFilter current_;
+    KBlockedBloomFilter previous_;
+    size_t              currentCount_;
+};
+
+// ---------------------------- 统计策略 ----------------------------
+
+// 不统计 所有调用编译后为空
+struct KNoStats
+{
+    void hit() {}
+    void miss() {}
+    void evict() {}
+    void reject() {}
+};
+
+// 计数统计 共享锁下的读命中会被并发记录 因此使用 relaxed 原子计数
+struct KCountingStats
+{
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> evictions{0};
+    std::atomic<uint64_t> rejections{0}; // 被准入策略拒绝的写入
+
+    KCountingStats() = default;
+
+    KCountingStats(const KCountingStats& other)
+        : hits(other.hits.load(std::memory_order_relaxed))
+        , misses(other.misses.load(std::memory_order_relaxed))
+        , evictions(other.evictions.load(std::memory_order_relaxed))
+        , rejections(other.rejections.load(std::memory_order_relaxed))
+    {}
+
+    void hit() { hits.fetch_add(1, std::memory_order_relaxed); }
+    void miss() { misses.fetch_add(1, std::memory_order_relaxed); }
+    void evict() { evictions.fetch_add(1, std::memory_order_relaxed); }
+    void reject() { rejections.fetch_add(1, std::memory_order_relaxed); }
+
+    double hitRate() const
+    {
+        uint64_t h = hits.load(std::memory_order_relaxed);
+        uint64_t total = h + misses.load(std::memory_order_relaxed);
+        return total > 0 ? static_cast<double>(h) / total : 0;
+    }
+};
+
+} // namespace KamaCache
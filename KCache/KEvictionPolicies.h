@@ -0,0 +1,388 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "../KHashIndex.h"
+
+namespace KamaCache
+{
+
+// =========================================================================
+// KCache 的淘汰策略
+//
+// 每个淘汰策略是一个标签类，包含两个嵌套模板：
+// - Hook<Node>：嵌入缓存节点的侵入式字段(链表指针、频次等)，节点以 CRTP 方式继承它。
+// - Policy<Node>：淘汰逻辑，KCache 在持有锁时调用：
+//     Policy(capacity)
+//     void  resize(capacity) 缓存容量在运行期改变
+//     void  onInsert(Node*)  新节点写入
+//     void  onAccess(Node*)  命中(读取或覆盖写入)
+//     Node* victim()         选出下一个被淘汰的节点 只在缓存非空时调用
+//     void  onEvict(Node*)   节点因容量被淘汰(可记录幽灵条目)
+//     void  onErase(Node*)   节点被显式删除
+// 节点不由策略分配，策略只维护顺序，因此同一份淘汰逻辑可以与任意索引、锁组合。
+// =========================================================================
+
+namespace detail
+{
+
+// 侵入式双向链表 头为最久未访问 尾为最近访问
+template<typename Node>
+struct KIntrusiveList
+{
+    Node*  head = nullptr;
+    Node*  tail = nullptr;
+    size_t size = 0;
+
+    void pushBack(Node* node)
+    {
+        node->prev = tail;
+        node->next = nullptr;
+        if (tail) tail->next = node; else head = node;
+        tail = node;
+        ++size;
+    }
+
+    void unlink(Node* node)
+    {
+        if (node->prev) node->prev->next = node->next; else head = node->next;
+        if (node->next) node->next->prev = node->prev; else tail = node->prev;
+        node->prev = node->next = nullptr;
+        --size;
+    }
+
+    void moveToBack(Node* node)
+    {
+        if (tail == node)
+            return;
+        unlink(node);
+        pushBack(node);
+    }
+
+    bool empty() const { return size == 0; }
+};
+
+} // namespace detail
+
+// ---------------------------- LRU ----------------------------
+
+// 与 KLruCache 相同的逻辑：命中移到最近端 淘汰最久未访问端
+struct KLruEviction
+{
+    template<typename Node>
+    struct Hook
+    {
+        Node* prev = nullptr;
+        Node* next = nullptr;
+    };
+
+    template<typename Node>
+    class Policy
+    {
+    public:
+        explicit Policy(size_t) {}
+
+        void resize(size_t) {}
+        void onInsert(Node* node) { list_.pushBack(node); }
+        void onAccess(Node* node) { list_.moveToBack(node); }
+        Node* victim() { return list_.head; }
+        void onEvict(Node* node) { list_.unlink(node); }
+        void onErase(Node* node) { list_.unlink(node); }
+
+    private:
+        detail::KIntrusiveList<Node> list_;
+    };
+};
+
+// ---------------------------- LFU ----------------------------
+
+// 与 KLfuCache 结构相同的 O(1) 频次链表：每个频次一条链表 记录最小频次 同频次按 LRU 淘汰
+// 老化方式不同：KLfuCache 在平均频次超过 maxAverageNum 时把所有结点的频次减去 maxAverageNum / 2，
+// 这里没有老化，频次在 kMaxFreq 封顶，封顶的条目之间按 LRU 淘汰，因此两者的命中率并不完全相同
+struct KLfuEviction
+{
+    static constexpr size_t kMaxFreq = 255;
+
+    template<typename Node>
+    struct Hook
+    {
+        Node*  prev = nullptr;
+        Node*  next = nullptr;
+        size_t freq = 0;
+    };
+
+    template<typename Node>
+    class Policy
+    {
+    public:
+        explicit Policy(size_t)
+            : lists_(kMaxFreq + 1)
+            , minFreq_(1)
+        {}
+
+        void resize(size_t) {}
+
+        void onInsert(Node* node)
+        {
+            node->freq = 1;
+            lists_[1].pushBack(node);
+            minFreq_ = 1;
+        }
+
+        void onAccess(Node* node)
+        {
+            size_t freq = node->freq;
+            if (freq == kMaxFreq)
+            {
+                lists_[freq].moveToBack(node);
+                return;
+            }
+            lists_[freq].unlink(node);
+            node->freq = freq + 1;
+            lists_[freq + 1].pushBack(node);
+            if (freq == minFreq_ && lists_[freq].empty())
+                minFreq_ = freq + 1;
+        }
+
+        Node* victim()
+        {
+            // 删除可能让最小频次的链表变空 向上找到第一个非空链表
+            while (minFreq_ < kMaxFreq && lists_[minFreq_].empty())
+                ++minFreq_;
+            return lists_[minFreq_].head;
+        }
+
+        void onEvict(Node* node) { lists_[node->freq].unlink(node); }
+        void onErase(Node* node) { lists_[node->freq].unlink(node); }
+
+    private:
+        std::vector<detail::KIntrusiveList<Node>> lists_;   // 下标为频次
+        size_t                                    minFreq_; // 最小频次 可能偏小 由 victim 修正
+    };
+};
+
+// ---------------------------- ARC ----------------------------
+
+/**
+ * @brief 教科书式的 ARC(Megiddo & Modha)：T1(最近只访问一次) T2(至少两次) 与各自的幽灵列表 B1 / B2
+ *
+ * 写入时 key 若在 B1 中，说明 T1 偏小，增大 T1 的目标大小 p；在 B2 中则减小 p，两种情况都直接进入 T2。
+ * 淘汰时 T1 超过 p 则从 T1 淘汰，否则从 T2 淘汰，被淘汰的 key 进入对应的幽灵列表。
+ *
+ * 它不是 KArcCache 的移植：KArcCache 由独立加锁的 LRU 与 LFU 两部分组成，访问 transformThreshold 次才晋升，
+ * LFU 部分按频次淘汰，总容量为两部分之和，命中率与这里不同，两者不能直接比较。
+ */
+struct KArcEviction
+{
+    template<typename Node>
+    struct Hook
+    {
+        Node* prev = nullptr;
+        Node* next = nullptr;
+        bool  frequent = false; // 是否在 T2 中
+    };
+
+    template<typename Node>
+    class Policy
+    {
+    private:
+        using Key = typename Node::KeyType;
+
+        // 幽灵条目 只保存 key 与哈希 从预分配的槽位中取用
+        struct Ghost
+        {
+            Key    key{};
+            size_t hash = 0;
+            Ghost* prev = nullptr;
+            Ghost* next = nullptr;
+            bool   frequent = false; // 是否在 B2 中
+
+            const Key& getKey() const { return key; }
+            size_t getHash() const { return hash; }
+        };
+
+    public:
+        explicit Policy(size_t capacity)
+            : capacity_(capacity > 0 ? capacity : 1)
+            , p_(0)
+            , ghosts_(new Ghost[capacity_])
+            , freeGhosts_(nullptr)
+            , ghostIndex_(capacity_)
+        {
+            linkFreeGhosts();
+        }
+
+        /**
+         * @brief p 与幽灵列表的上限随容量变化
+         *
+         * 幽灵槽位按新容量重新分配，按新上限从最旧端丢弃多出的幽灵条目，其余保持原有顺序。
+         * 只在 setCapacity 时调用，不在访问路径上。
+         */
+        void resize(size_t capacity)
+        {
+            capacity_ = capacity > 0 ? capacity : 1;
+            p_ = std::min(p_, capacity_);
+            while (b1_.size + b2_.size > capacity_)
+                dropGhost(b2_.empty() ? b1_.head : b2_.head);
+
+            std::vector<std::pair<Key, std::pair<size_t, bool>>> kept;
+            kept.reserve(b1_.size + b2_.size);
+            for (Ghost* ghost = b1_.head; ghost; ghost = ghost->next)
+                kept.emplace_back(std::move(ghost->key), std::make_pair(ghost->hash, false));
+            for (Ghost* ghost = b2_.head; ghost; ghost = ghost->next)
+                kept.emplace_back(std::move(ghost->key), std::make_pair(ghost->hash, true));
+
+            b1_ = detail::KIntrusiveList<Ghost>();
+            b2_ = detail::KIntrusiveList<Ghost>();
+            ghosts_.reset(new Ghost[capacity_]);
+            ghostIndex_ = KHashIndex<Key, Ghost*>(capacity_);
+            linkFreeGhosts();
+            for (auto& entry : kept)
+                pushGhost(std::move(entry.first), entry.second.first, entry.second.second);
+        }
+
+        void onInsert(Node* node)
+        {
+            Ghost** found = ghostIndex_.find(node->getKey(), node->getHash());
+            if (found && !(*found)->frequent)
+            {
+                size_t delta = std::max<size_t>(1, b2_.size / std::max<size_t>(1, b1_.size));
+                p_ = std::min(capacity_, p_ + delta);
+                dropGhost(*found);
+                pushFrequent(node);
+                return;
+            }
+            if (found)
+            {
+                size_t delta = std::max<size_t>(1, b1_.size / std::max<size_t>(1, b2_.size));
+                p_ = p_ > delta ? p_ - delta : 0;
+                dropGhost(*found);
+                pushFrequent(node);
+                return;
+            }
+            // 保持 |T1| + |B1| <= c
+            if (t1_.size + b1_.size >= capacity_ && !b1_.empty())
+                dropGhost(b1_.head);
+            node->frequent = false;
+            t1_.pushBack(node);
+        }
+
+        void onAccess(Node* node)
+        {
+            if (node->frequent)
+            {
+                t2_.moveToBack(node);
+                return;
+            }
+            t1_.unlink(node);
+            pushFrequent(node);
+        }
+
+        Node* victim()
+        {
+            if (!t1_.empty() && (t1_.size > p_ || t2_.empty()))
+                return t1_.head;
+            return t2_.head;
+        }
+
+        void onEvict(Node* node)
+        {
+            if (node->frequent)
+                t2_.unlink(node);
+            else
+                t1_.unlink(node);
+            addGhost(node);
+        }
+
+        void onErase(Node* node)
+        {
+            if (node->frequent)
+                t2_.unlink(node);
+            else
+                t1_.unlink(node);
+        }
+
+        // T1 的目标大小
+        size_t target() const { return p_; }
+
+        // B1 / B2 中的幽灵条目数
+        size_t recentGhosts() const { return b1_.size; }
+        size_t frequentGhosts() const { return b2_.size; }
+
+    private:
+        void pushFrequent(Node* node)
+        {
+            node->frequent = true;
+            t2_.pushBack(node);
+        }
+
+        /**
+         * @brief 记录被淘汰节点的幽灵条目 上限与论文一致
+         *
+         * - |T1| + |B1| <= c：超出时丢弃 B1 最旧的条目，B1 为空(T1 独占 c)时不记录；
+         * - |T1| + |T2| + |B1| + |B2| <= 2c：缓存写满时即 |B1| + |B2| <= c，超出时优先丢弃 B2 最旧的条目。
+         * 幽灵条目最多 c 个，槽位与索引在构造时按 c 预分配，淘汰时不分配内存。
+         */
+        void addGhost(Node* node)
+        {
+            bool frequent = node->frequent;
+            if (!frequent)
+            {
+                while (t1_.size + b1_.size + 1 > capacity_ && !b1_.empty())
+                    dropGhost(b1_.head);
+                if (t1_.size + 1 > capacity_)
+                    return;
+            }
+            while (b1_.size + b2_.size + 1 > capacity_)
+                dropGhost(b2_.empty() ? b1_.head : b2_.head);
+            pushGhost(node->getKey(), node->getHash(), frequent);
+        }
+
+        template<typename K>
+        void pushGhost(K&& key, size_t hash, bool frequent)
+        {
+            Ghost* ghost = freeGhosts_;
+            freeGhosts_ = ghost->next;
+            ghost->key = std::forward<K>(key);
+            ghost->hash = hash;
+            ghost->frequent = frequent;
+            (frequent ? b2_ : b1_).pushBack(ghost);
+            ghostIndex_.insert(hash, ghost);
+        }
+
+        void dropGhost(Ghost* ghost)
+        {
+            (ghost->frequent ? b2_ : b1_).unlink(ghost);
+            ghostIndex_.eraseNode(ghost);
+            ghost->next = freeGhosts_;
+            freeGhosts_ = ghost;
+        }
+
+        void linkFreeGhosts()
+        {
+            freeGhosts_ = nullptr;
+            for (size_t i = capacity_; i > 0; --i)
+            {
+                ghosts_[i - 1].next = freeGhosts_;
+                freeGhosts_ = &ghosts_[i - 1];
+            }
+        }
+
+    private:
+        size_t                          capacity_;
+        size_t                          p_;          // T1 的目标大小
+        detail::KIntrusiveList<Node>    t1_;
+        detail::KIntrusiveList<Node>    t2_;
+        std::unique_ptr<Ghost[]>        ghosts_;     // capacity 个幽灵槽位
+        Ghost*                          freeGhosts_; // 空闲槽位链表
+        detail::KIntrusiveList<Ghost>   b1_;
+        detail::KIntrusiveList<Ghost>   b2_;
+        KHashIndex<Key, Ghost*>         ghostIndex_; // key -> 幽灵槽位 按 c 预留 不会扩容
+    };
+};
+
+} // namespace KamaCache
@@ -0,0 +1,256 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#define KCACHE_CPU_RELAX() _mm_pause()
+#elif defined(__aarch64__)
+#define KCACHE_CPU_RELAX() asm volatile("yield")
+#else
+#define KCACHE_CPU_RELAX() ((void)0)
+#endif
+
+namespace KamaCache
+{
+
+// =========================================================================
+// KCache 的锁策略
+//
+// 锁策略不暴露 lock / unlock，而是执行一段临界区代码：
+//     template<typename F> void execute(F&& f)      互斥执行 f
+//     static constexpr bool kSharedReads             为 true 时额外提供 executeShared，
+//                                                    读操作可以并发执行(不能修改淘汰顺序)
+// 这样平板合并(flat combining)这类 "由别的线程代为执行" 的策略也能作为锁策略使用。
+// =========================================================================
+
+// 不加锁 用于单线程场景(例如每个线程独占一个实例的流水线阶段)
+struct KNoLock
+{
+    static constexpr bool kSharedReads = false;
+
+    template<typename F>
+    void execute(F&& f) { f(); }
+};
+
+// 互斥锁 与原有各策略相同
+class KMutexLock
+{
+public:
+    static constexpr bool kSharedReads = false;
+
+    template<typename F>
+    void execute(F&& f)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        f();
+    }
+
+private:
+    std::mutex mutex_;
+};
+
+/**
+ * @brief TTAS 自旋锁 带指数退避
+ *
+ * 先只读地等待锁变为空闲(只读期间锁所在缓存行可以在各核共享)，看到空闲再尝试交换，
+ * 失败后等待的 pause 次数翻倍，超过上限后让出 CPU，避免持锁线程被调度出去时空转。
+ * 临界区很短且线程数不超过核数时比互斥锁少一次内核态切换。
+ */
+class alignas(64) KSpinLock
+{
+public:
+    static constexpr bool kSharedReads = false;
+
+    void lock()
+    {
+        uint32_t backoff = 1;
+        while (true)
+        {
+            if (!locked_.load(std::memory_order_relaxed) && !locked_.exchange(true, std::memory_order_acquire))
+                return;
+            if (backoff <= kMaxBackoff)
+            {
+                for (uint32_t i = 0; i < backoff; ++i)
+                    KCACHE_CPU_RELAX();
+                backoff <<= 1;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void unlock() { locked_.store(false, std::memory_order_release); }
+
+    // f 抛出异常时同样释放锁
+    template<typename F>
+    void execute(F&& f)
+    {
+        std::lock_guard<KSpinLock> lock(*this);
+        f();
+    }
+
+private:
+    static constexpr uint32_t kMaxBackoff = 1024;
+
+    std::atomic<bool> locked_{false};
+};
+
+/**
+ * @brief 读写锁：读操作在共享锁下并发执行
+ *
+ * 共享锁下不能修改淘汰顺序，KCache 把读命中记录到有损的读缓冲区，由持有独占锁的写操作批量补做。
+ */
+class KSharedMutexLock
+{
+public:
+    static constexpr bool kSharedReads = true;
+
+    template<typename F>
+    void execute(F&& f)
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        f();
+    }
+
+    template<typename F>
+    void executeShared(F&& f)
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        f();
+    }
+
+    // 读线程在读缓冲区写满时尝试代为补做 拿不到独占锁就放弃
+    template<typename F>
+    bool tryExecute(F&& f)
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_, std::try_to_lock);
+        if (!lock.owns_lock())
+            return false;
+        f();
+        return true;
+    }
+
+private:
+    std::shared_mutex mutex_;
+};
+
+/**
+ * @brief 平板合并(flat combining)
+ *
+ * 每个线程把要执行的操作发布到自己的槽位，然后尝试成为合并者：拿到合并锁的线程依次执行所有槽位中的操作，
+ * 其他线程只需等待自己的操作被标记完成。高并发下缓存的数据结构始终只被一个核访问，
+ * 锁和节点的缓存行不再在各核间来回传递，一次加锁可以完成一批操作。
+ *
+ * 槽位按线程编号取模分配，槽位数之外的线程与其他线程共用槽位(发布时等待槽位空闲)。
+ * 操作抛出的异常由合并者捕获并交还发布者，在发布者的 execute 中重新抛出，合并锁照常释放。
+ */
+class KFlatCombiningLock
+{
+public:
+    static constexpr bool kSharedReads = false;
+
+    template<typename F>
+    void execute(F&& f)
+    {
+        Operation op;
+        op.run = [](void* ctx) { (*static_cast<typename std::remove_reference<F>::type*>(ctx))(); };
+        op.ctx = &f;
+
+        Slot& slot = slots_[slotOfThread()];
+        Operation* expected = nullptr;
+        // 与其他线程共用槽位时 等待对方的操作被执行 等待期间也尝试合并
+        while (!slot.pending.compare_exchange_weak(expected, &op, std::memory_order_release,
+                                                   std::memory_order_relaxed))
+        {
+            expected = nullptr;
+            tryCombine();
+        }
+
+        uint32_t spins = 0;
+        while (!op.done.load(std::memory_order_acquire))
+        {
+            if (tryCombine())
+                continue;
+            if (++spins < kSpinsBeforeYield)
+                KCACHE_CPU_RELAX();
+            else
+                std::this_thread::yield();
+        }
+        if (op.error)
+            std::rethrow_exception(op.error);
+    }
+
+private:
+    static constexpr size_t   kSlots = 64;
+    static constexpr uint32_t kSpinsBeforeYield = 64;
+
+    struct Operation
+    {
+        void (*run)(void*) = nullptr;
+        void*              ctx = nullptr;
+        std::exception_ptr error;       // 操作抛出的异常 done 之前由合并者写入
+        std::atomic<bool>  done{false};
+    };
+
+    // 离开作用域时释放合并锁
+    struct CombineGuard
+    {
+        std::atomic<bool>& combining;
+        ~CombineGuard() { combining.store(false, std::memory_order_release); }
+    };
+
+    struct alignas(64) Slot
+    {
+        std::atomic<Operation*> pending{nullptr};
+    };
+
+    static size_t slotOfThread()
+    {
+        static std::atomic<size_t> nextThread{0};
+        thread_local size_t slot = nextThread.fetch_add(1, std::memory_order_relaxed) % kSlots;
+        return slot;
+    }
+
+    // 成为合并者并执行所有已发布的操作 没拿到合并锁时返回 false
+    bool tryCombine()
+    {
+        if (combining_.load(std::memory_order_relaxed) ||
+            combining_.exchange(true, std::memory_order_acquire))
+            return false;
+        CombineGuard guard{combining_};
+        for (Slot& slot : slots_)
+        {
+            Operation* op = slot.pending.load(std::memory_order_acquire);
+            if (!op)
+                continue;
+            try
+            {
+                op->run(op->ctx);
+            }
+            catch (...)
+            {
+                op->error = std::current_exception();
+            }
+            // 先清空槽位再标记完成 标记之后发布者可能立即返回并销毁 op
+            slot.pending.store(nullptr, std::memory_order_relaxed);
+            op->done.store(true, std::memory_order_release);
+        }
+        return true;
+    }
+
+private:
+    Slot                           slots_[kSlots];
+    alignas(64) std::atomic<bool>  combining_{false}; // 合并锁
+};
+
+} // namespace KamaCache
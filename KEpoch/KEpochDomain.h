@@ -0,0 +1,264 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace KamaCache
+{
+
+// 回收统计
+struct KEpochStats
+{
+    uint64_t retired = 0;   // 累计退役的对象数
+    uint64_t reclaimed = 0; // 累计真正释放的对象数
+    uint64_t epoch = 0;     // 当前全局纪元
+};
+
+/**
+ * @brief 基于纪元(epoch)的内存回收
+ *
+ * 无锁读者在读取共享节点前进入临界区(KEpochGuard)，宣告自己观察到的全局纪元；
+ * 写者把摘除的节点交给 retire，记下当时的全局纪元 e，而不是立即释放。
+ * 全局纪元只有在所有活跃读者都已宣告当前纪元时才能前进，因此纪元前进到 e + 2 时，
+ * 退役时可能还在读取该节点的读者(纪元为 e - 1 或 e)都已离开，节点可以安全释放。
+ *
+ * 读者的进入与退出只读写自己独占缓存行的纪元记录，不接触任何共享写入的数据；
+ * 退役列表由一把锁保护，退役通常发生在写者已持有缓存锁的淘汰路径上，额外开销很小。
+ * 进程内使用一个全局实例 KEpochDomain::global()。线程的纪元记录挂在一条只增不删的无锁链表上，
+ * 线程退出时归还记录供之后的线程复用，链表长度等于同时持有记录的线程数的峰值，线程数没有上限。
+ */
+class KEpochDomain
+{
+private:
+    static constexpr uint64_t kInactive = 0;       // 不在临界区
+    static constexpr size_t   kReclaimBatch = 64;  // 每退役这么多个对象尝试推进纪元并回收一次
+
+    struct alignas(64) ThreadRecord
+    {
+        std::atomic<uint64_t> epoch{kInactive}; // 进入临界区时观察到的全局纪元
+        std::atomic<bool>     inUse{false};     // 记录是否已被某个线程占用
+        ThreadRecord*         next = nullptr;   // 链表中的下一条记录 发布后不再修改
+    };
+
+    struct Retired
+    {
+        void*    object;
+        void   (*deleter)(void*);
+        uint64_t epoch; // 退役时的全局纪元
+    };
+
+    // 线程持有的记录 线程退出时归还
+    struct LocalHandle
+    {
+        ThreadRecord* record = nullptr;
+        uint32_t      nesting = 0;
+
+        ~LocalHandle()
+        {
+            if (record)
+                record->inUse.store(false, std::memory_order_release);
+        }
+    };
+
+public:
+    static KEpochDomain& global()
+    {
+        static KEpochDomain domain;
+        return domain;
+    }
+
+    ~KEpochDomain()
+    {
+        // 进程退出时不再有读者
+        for (Retired& item : retired_)
+            item.deleter(item.object);
+        ThreadRecord* record = records_.load(std::memory_order_acquire);
+        while (record)
+        {
+            ThreadRecord* next = record->next;
+            delete record;
+            record = next;
+        }
+    }
+
+    // 进入读临界区 可以嵌套
+    void enter()
+    {
+        LocalHandle& handle = localHandle();
+        if (handle.nesting++ > 0)
+            return;
+        // 宣告必须先于之后对共享节点的读取对写者可见；宣告前纪元可能已经前进，
+        // 此时宣告的旧纪元不受保护，需要重新宣告直到与全局纪元一致
+        uint64_t epoch = globalEpoch_.load(std::memory_order_relaxed);
+        while (true)
+        {
+            handle.record->epoch.store(epoch, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            uint64_t current = globalEpoch_.load(std::memory_order_relaxed);
+            if (current == epoch)
+                break;
+            epoch = current;
+        }
+    }
+
+    void exit()
+    {
+        LocalHandle& handle = localHandle();
+        if (--handle.nesting > 0)
+            return;
+        handle.record->epoch.store(kInactive, std::memory_order_release);
+    }
+
+    // 退役一个已经对新读者不可见的对象 等到没有读者可能持有它时调用 deleter 释放
+    void retire(void* object, void (*deleter)(void*))
+    {
+        std::vector<Retired> freeable;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            retired_.push_back(Retired{object, deleter, globalEpoch_.load(std::memory_order_relaxed)});
+            ++totalRetired_;
+            if (++sinceReclaim_ < kReclaimBatch)
+                return;
+            sinceReclaim_ = 0;
+            tryAdvance();
+            collect(freeable);
+        }
+        // 在锁外调用 deleter 析构较大的值时不阻塞其他写者
+        for (Retired& item : freeable)
+            item.deleter(item.object);
+    }
+
+    template<typename T>
+    void retire(T* object)
+    {
+        retire(object, [](void* p) { delete static_cast<T*>(p); });
+    }
+
+    // 尽力回收：推进纪元并释放所有已经安全的对象 有读者停留在旧纪元时只能释放一部分
+    void reclaim()
+    {
+        std::vector<Retired> freeable;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            // 每次推进一个纪元 最多两次即可让退役时的纪元满足条件
+            tryAdvance();
+            tryAdvance();
+            collect(freeable);
+        }
+        for (Retired& item : freeable)
+            item.deleter(item.object);
+    }
+
+    KEpochStats stats()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        KEpochStats result;
+        result.retired = totalRetired_;
+        result.reclaimed = totalReclaimed_;
+        result.epoch = globalEpoch_.load(std::memory_order_relaxed);
+        return result;
+    }
+
+private:
+    KEpochDomain()
+        : records_(nullptr)
+        , globalEpoch_(1)
+        , sinceReclaim_(0)
+        , totalRetired_(0)
+        , totalReclaimed_(0)
+    {}
+
+    LocalHandle& localHandle()
+    {
+        thread_local LocalHandle handle;
+        if (!handle.record)
+            handle.record = acquireRecord();
+        return handle;
+    }
+
+    // 复用一条已归还的记录 没有空闲记录时新建一条插到链表头部 不会等待其他线程
+    ThreadRecord* acquireRecord()
+    {
+        for (ThreadRecord* record = records_.load(std::memory_order_acquire); record; record = record->next)
+        {
+            bool expected = false;
+            if (!record->inUse.load(std::memory_order_relaxed) &&
+                record->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                return record;
+        }
+        ThreadRecord* record = new ThreadRecord;
+        record->inUse.store(true, std::memory_order_relaxed);
+        ThreadRecord* head = records_.load(std::memory_order_relaxed);
+        do
+        {
+            record->next = head;
+        } while (!records_.compare_exchange_weak(head, record, std::memory_order_seq_cst, std::memory_order_relaxed));
+        return record;
+    }
+
+    // 所有活跃读者都已宣告当前纪元时 纪元前进一步 持有 mutex_
+    void tryAdvance()
+    {
+        uint64_t epoch = globalEpoch_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (ThreadRecord* record = records_.load(std::memory_order_acquire); record; record = record->next)
+        {
+            if (!record->inUse.load(std::memory_order_acquire))
+                continue;
+            uint64_t observed = record->epoch.load(std::memory_order_acquire);
+            if (observed != kInactive && observed != epoch)
+                return;
+        }
+        globalEpoch_.store(epoch + 1, std::memory_order_release);
+    }
+
+    // 取出可以释放的对象 持有 mutex_
+    void collect(std::vector<Retired>& freeable)
+    {
+        uint64_t epoch = globalEpoch_.load(std::memory_order_relaxed);
+        size_t kept = 0;
+        for (Retired& item : retired_)
+        {
+            if (item.epoch + 2 <= epoch)
+                freeable.push_back(item);
+            else
+                retired_[kept++] = item;
+        }
+        retired_.resize(kept);
+        totalReclaimed_ += freeable.size();
+    }
+
+private:
+    std::atomic<ThreadRecord*> records_;        // 纪元记录链表的头部 记录只在析构时释放
+    std::atomic<uint64_t>      globalEpoch_;
+    std::mutex                 mutex_;          // 保护退役列表与纪元推进
+    std::vector<Retired>       retired_;        // 等待释放的对象
+    size_t                     sinceReclaim_;   // 上次回收后新退役的对象数
+    uint64_t                   totalRetired_;
+    uint64_t                   totalReclaimed_;
+};
+
+/**
+ * @brief 读临界区的 RAII 守卫 存活期间读到的节点不会被释放
+ */
+class KEpochGuard
+{
+public:
+    explicit KEpochGuard(KEpochDomain& domain = KEpochDomain::global())
+        : domain_(domain)
+    {
+        domain_.enter();
+    }
+
+    ~KEpochGuard() { domain_.exit(); }
+
+    KEpochGuard(const KEpochGuard&) = delete;
+    KEpochGuard& operator=(const KEpochGuard&) = delete;
+
+private:
+    KEpochDomain& domain_;
+};
+
+} // namespace KamaCache
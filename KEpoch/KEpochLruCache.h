@@ -0,0 +1,307 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "../KHashIndex.h"
+#include "../KICachePolicy.h"
+#include "../KShardedCache.h"
+#include "KEpochDomain.h"
+
+namespace KamaCache
+{
+
+/**
+ * @brief 读操作无锁的近似 LRU 缓存
+ *
+ * 核心设计：
+ * 1. 索引是固定桶数的链式哈希表，桶头与链表后继都是原子指针。读者在 KEpochGuard 内沿链查找，
+ *    不加任何锁；写者(put / remove / 淘汰)之间由一把互斥锁串行化。
+ * 2. 节点发布后不再修改 key 与 value：覆盖写入会创建新节点替换旧节点，因此读者可以在锁外直接读取值，
+ *    find 甚至可以返回值的引用，不做任何拷贝。
+ * 3. 被摘除的节点(淘汰、覆盖、删除)交给 KEpochDomain 退役，所有可能持有它的读者离开后才释放。
+ * 4. 读者不能修改链表顺序，命中时只设置节点的访问位；淘汰时从最久写入端开始，
+ *    访问位为 1 的节点清零后移到最近端(二次机会)，近似 LRU 的效果。
+ */
+template<typename Key, typename Value>
+class KEpochLruCache : public KICachePolicy<Key, Value>
+{
+private:
+    struct Node
+    {
+        Node(const Key& k, const Value& v, size_t h)
+            : key(k)
+            , value(v)
+            , hash(h)
+        {}
+
+        const Key              key;
+        const Value            value;
+        const size_t           hash;
+        std::atomic<Node*>     chainNext{nullptr}; // 桶内链表 读者无锁遍历
+        std::atomic<bool>      referenced{false};  // 访问位 读者命中时设置
+        Node*                  prev = nullptr;     // 淘汰链表 只有写者访问
+        Node*                  next = nullptr;
+    };
+
+public:
+    explicit KEpochLruCache(int capacity)
+        : capacity_(capacity > 0 ? static_cast<size_t>(capacity) : 0)
+        , size_(0)
+        , head_(nullptr)
+        , tail_(nullptr)
+    {
+        size_t buckets = 8;
+        shift_ = 61;
+        while (buckets < capacity_)
+        {
+            buckets <<= 1;
+            --shift_;
+        }
+        buckets_.reset(new std::atomic<Node*>[buckets]);
+        for (size_t i = 0; i < buckets; ++i)
+            buckets_[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    // 析构时不能再有并发读者
+    ~KEpochLruCache() override
+    {
+        Node* node = head_;
+        while (node)
+        {
+            Node* next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+    void put(Key key, Value value) override
+    {
+        put(key, value, KHashOf(key));
+    }
+
+    // 使用调用方预先算好的哈希值 要求 hash == KHashOf(key)
+    void put(const Key& key, const Value& value, size_t hash)
+    {
+        // 在锁外构造新节点 值的拷贝不占用写锁
+        Node* node = new Node(key, value, hash);
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::atomic<Node*>* link = findLink(key, hash);
+        Node* old = link->load(std::memory_order_relaxed);
+        if (old)
+        {
+            // 覆盖写入：新节点接替旧节点在桶链与淘汰链表中的位置
+            node->chainNext.store(old->chainNext.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            node->referenced.store(true, std::memory_order_relaxed);
+            link->store(node, std::memory_order_release);
+            replaceInList(old, node);
+            KEpochDomain::global().retire(old);
+            return;
+        }
+
+        if (capacity_ == 0)
+        {
+            trimLocked(this->kTrimBatch);
+            delete node; // 从未发布给读者 可以直接释放
+            return;
+        }
+        trimLocked(this->kTrimBatch);
+        if (size_ >= capacity_)
+            evictOne();
+        std::atomic<Node*>& bucket = buckets_[bucketOf(hash)];
+        node->chainNext.store(bucket.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        bucket.store(node, std::memory_order_release);
+        pushBack(node);
+        ++size_;
+    }
+
+    bool get(Key key, Value& value) override
+    {
+        return get(key, value, KHashOf(key));
+    }
+
+    bool get(const Key& key, Value& value, size_t hash)
+    {
+        KEpochGuard guard;
+        const Node* node = lookup(key, hash);
+        if (!node)
+            return false;
+        value = node->value;
+        return true;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 只替换已存在的节点 新节点沿用旧节点的访问位 不算作一次访问
+    bool updateIfPresent(Key key, Value value) override
+    {
+        size_t hash = KHashOf(key);
+        Node* node = new Node(key, value, hash);
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::atomic<Node*>* link = findLink(key, hash);
+        Node* old = link->load(std::memory_order_relaxed);
+        if (!old)
+        {
+            delete node; // 从未发布给读者 可以直接释放
+            return false;
+        }
+        node->chainNext.store(old->chainNext.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        node->referenced.store(old->referenced.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        link->store(node, std::memory_order_release);
+        replaceInList(old, node);
+        KEpochDomain::global().retire(old);
+        return true;
+    }
+
+    /**
+     * @brief 零拷贝读取：返回缓存中值的地址 不存在时返回 nullptr
+     *
+     * 返回的指针在 guard 析构前一直有效，即使期间该 key 被覆盖、删除或淘汰。
+     */
+    const Value* find(const Key& key, const KEpochGuard& guard)
+    {
+        (void)guard;
+        const Node* node = lookup(key, KHashOf(key));
+        return node ? &node->value : nullptr;
+    }
+
+    void remove(Key key)
+    {
+        remove(key, KHashOf(key));
+    }
+
+    void remove(const Key& key, size_t hash)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::atomic<Node*>* link = findLink(key, hash);
+        Node* node = link->load(std::memory_order_relaxed);
+        if (!node)
+            return;
+        link->store(node->chainNext.load(std::memory_order_relaxed), std::memory_order_release);
+        unlinkFromList(node);
+        --size_;
+        KEpochDomain::global().retire(node);
+    }
+
+    // 桶数组对无锁读者可见 不随容量重建 扩容超过构造容量后桶链会相应变长
+    void setCapacity(size_t capacity) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capacity_ = capacity;
+    }
+
+    size_t trim(size_t maxEvictions) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return trimLocked(maxEvictions);
+    }
+
+private:
+    // 持有 mutex_
+    size_t trimLocked(size_t maxEvictions)
+    {
+        while (maxEvictions-- > 0 && size_ > capacity_)
+            evictOne();
+        return size_ > capacity_ ? size_ - capacity_ : 0;
+    }
+
+    size_t bucketOf(size_t hash) const
+    {
+        return static_cast<size_t>((static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull) >> shift_);
+    }
+
+    // 读者路径：在调用方的纪元临界区内沿链查找
+    const Node* lookup(const Key& key, size_t hash)
+    {
+        Node* node = buckets_[bucketOf(hash)].load(std::memory_order_acquire);
+        while (node)
+        {
+            if (node->hash == hash && node->key == key)
+            {
+                // 已经置位时不再写 避免热点节点的缓存行在读者之间来回失效
+                if (!node->referenced.load(std::memory_order_relaxed))
+                    node->referenced.store(true, std::memory_order_relaxed);
+                return node;
+            }
+            node = node->chainNext.load(std::memory_order_acquire);
+        }
+        return nullptr;
+    }
+
+    // 返回指向 key 所在节点的链接(桶头或前驱的 chainNext) 不存在时返回链尾的空链接 持有 mutex_
+    std::atomic<Node*>* findLink(const Key& key, size_t hash)
+    {
+        std::atomic<Node*>* link = &buckets_[bucketOf(hash)];
+        while (Node* node = link->load(std::memory_order_relaxed))
+        {
+            if (node->hash == hash && node->key == key)
+                return link;
+            link = &node->chainNext;
+        }
+        return link;
+    }
+
+    // 二次机会淘汰 持有 mutex_
+    void evictOne()
+    {
+        Node* victim = head_;
+        while (victim->referenced.load(std::memory_order_relaxed))
+        {
+            victim->referenced.store(false, std::memory_order_relaxed);
+            unlinkFromList(victim);
+            pushBack(victim);
+            victim = head_;
+        }
+        std::atomic<Node*>* link = findLink(victim->key, victim->hash);
+        link->store(victim->chainNext.load(std::memory_order_relaxed), std::memory_order_release);
+        unlinkFromList(victim);
+        --size_;
+        this->onEvict(victim->key, victim->value);
+        KEpochDomain::global().retire(victim);
+    }
+
+    void pushBack(Node* node)
+    {
+        node->prev = tail_;
+        node->next = nullptr;
+        if (tail_) tail_->next = node; else head_ = node;
+        tail_ = node;
+    }
+
+    void unlinkFromList(Node* node)
+    {
+        if (node->prev) node->prev->next = node->next; else head_ = node->next;
+        if (node->next) node->next->prev = node->prev; else tail_ = node->prev;
+        node->prev = node->next = nullptr;
+    }
+
+    void replaceInList(Node* old, Node* node)
+    {
+        node->prev = old->prev;
+        node->next = old->next;
+        if (old->prev) old->prev->next = node; else head_ = node;
+        if (old->next) old->next->prev = node; else tail_ = node;
+    }
+
+private:
+    size_t                                capacity_;
+    size_t                                size_;
+    int                                   shift_;   // 桶号取哈希乘积的高位
+    std::unique_ptr<std::atomic<Node*>[]> buckets_; // 链式哈希表 桶数为不小于容量的 2 的幂
+    Node*                                 head_;    // 淘汰链表 头为最久写入 尾为最近写入或获得二次机会
+    Node*                                 tail_;
+    std::mutex                            mutex_;   // 串行化写者
+};
+
+// 无锁读 LRU 的分片版本 写锁按分片拆分
+template<typename Key, typename Value>
+using KHashEpochLruCache = KShardedCache<Key, Value, KEpochLruCache<Key, Value>>;
+
+} // namespace KamaCache
@@ -0,0 +1,366 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+#include "KHashIndex.h"
+#include "KHugePage.h"
+#include "KICachePolicy.h"
+
+namespace KamaCache
+{
+
+/**
+ * @brief 判断 Key/Value 是否使用扁平存储的 LRU 实现
+ * 两者都是可平凡拷贝的小对象(不超过 16 字节)时启用；使用者可以特化该模板强制关闭。
+ */
+template<typename Key, typename Value>
+struct KFlatLruEnabled
+    : std::integral_constant<bool,
+          std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<Value>::value &&
+          sizeof(Key) <= 16 && sizeof(Value) <= 16>
+{};
+
+/**
+ * @brief 面向 POD 小对象的扁平 LRU 缓存
+ *
+ * 核心设计：
+ * 1. 所有条目存放在一块连续的槽位数组中，链表用 32 位下标代替指针，没有逐节点的堆分配。
+ * 2. 索引是开放寻址(线性探测)的哈希表，只存放 32 位槽位下标，删除时用后移法填补空洞，不需要墓碑。
+ * 3. 以 <uint64_t, uint64_t> 为例：槽位 24 字节 + 索引约 8 字节(负载因子 0.5)，
+ *    而通用实现是 shared_ptr 节点加 unordered_map 节点，每个条目约 100 字节。
+ * 4. 淘汰时只需沿下标访问连续内存，对 CPU 缓存友好。
+ *
+ * 通过 KLruCache 的偏特化自动选用，接口与通用 KLruCache 保持一致。
+ */
+template<typename Key, typename Value>
+class KFlatLruCache : public KICachePolicy<Key, Value>
+{
+private:
+    static constexpr uint32_t kNil = UINT32_MAX; // 空下标 相当于空指针
+
+    // 槽位：键值对与前后链接下标
+    struct Slot
+    {
+        Key      key;
+        Value    value;
+        uint32_t prev;
+        uint32_t next; // 空闲时复用为空闲链表的后继
+    };
+
+public:
+    explicit KFlatLruCache(int capacity)
+        : KFlatLruCache(capacity, KHugePageMode::Off)
+    {}
+
+    // hugePages 不为 Off 时 槽位数组与索引从大页内存池分配
+    KFlatLruCache(int capacity, KHugePageMode hugePages)
+        : arena_(hugePages != KHugePageMode::Off ? new KHugePageArena(hugePages) : nullptr)
+        , capacity_(capacity > 0 ? static_cast<uint32_t>(capacity) : 0)
+        , head_(kNil)
+        , tail_(kNil)
+        , freeHead_(kNil)
+        , size_(0)
+        , indexShift_(0)
+        , slots_(KArenaAllocator<Slot>(arena_.get()))
+        , index_(KArenaAllocator<uint32_t>(arena_.get()))
+    {
+        slots_.reserve(capacity_);
+        resizeIndex();
+    }
+
+    ~KFlatLruCache() override = default;
+
+    void put(Key key, Value value) override
+    {
+        put(key, value, KHashOf(key));
+    }
+
+    // 使用调用方预先算好的哈希值 要求 hash == KHashOf(key)
+    void put(const Key& key, const Value& value, size_t hash)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t pos = findPos(key, hash);
+        if (index_[pos] != kNil)
+        {
+            uint32_t slot = index_[pos];
+            slots_[slot].value = value;
+            moveToMostRecent(slot);
+            return;
+        }
+
+        if (capacity_ == 0)
+        {
+            trimLocked(this->kTrimBatch);
+            return;
+        }
+        uint32_t slot = acquireSlot(key, hash, pos);
+
+        slots_[slot].key = key;
+        slots_[slot].value = value;
+        linkAtTail(slot);
+        index_[pos] = slot;
+        ++size_;
+    }
+
+    // 冷端写入：新条目链接到链表头(最久未访问端) 已存在的条目只更新值
+    void putCold(Key key, Value value) override
+    {
+        size_t hash = KHashOf(key);
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t pos = findPos(key, hash);
+        if (index_[pos] != kNil)
+        {
+            slots_[index_[pos]].value = value;
+            return;
+        }
+
+        if (capacity_ == 0)
+        {
+            trimLocked(this->kTrimBatch);
+            return;
+        }
+        uint32_t slot = acquireSlot(key, hash, pos);
+
+        slots_[slot].key = key;
+        slots_[slot].value = value;
+        linkAtHead(slot);
+        index_[pos] = slot;
+        ++size_;
+    }
+
+    // 只更新已存在条目的值 不移动链表位置
+    bool updateIfPresent(Key key, Value value) override
+    {
+        size_t hash = KHashOf(key);
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint32_t slot = index_[findPos(key, hash)];
+        if (slot == kNil)
+            return false;
+        slots_[slot].value = std::move(value);
+        return true;
+    }
+
+    bool get(Key key, Value& value) override
+    {
+        return get(key, value, KHashOf(key));
+    }
+
+    bool get(const Key& key, Value& value, size_t hash)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint32_t slot = index_[findPos(key, hash)];
+        if (slot == kNil)
+            return false;
+        moveToMostRecent(slot);
+        value = slots_[slot].value;
+        return true;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 删除指定元素 槽位归还到空闲链表
+    void remove(Key key)
+    {
+        remove(key, KHashOf(key));
+    }
+
+    void remove(const Key& key, size_t hash)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint32_t slot = index_[findPos(key, hash)];
+        if (slot == kNil)
+            return;
+        unlink(slot);
+        eraseFromIndex(slot);
+        slots_[slot].next = freeHead_;
+        freeHead_ = slot;
+        --size_;
+    }
+
+    // 扩容超过索引的设计负载时重建索引(一次性 O(n)) 缩容只修改容量 槽位留在空闲链表中复用
+    void setCapacity(size_t capacity) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capacity_ = static_cast<uint32_t>(std::min<size_t>(capacity, kNil - 1));
+        if (2 * static_cast<size_t>(capacity_) > index_.size())
+            resizeIndex();
+    }
+
+    size_t trim(size_t maxEvictions) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return trimLocked(maxEvictions);
+    }
+
+    // 大页内存池的统计 未开启时全部为 0
+    KHugePageStats hugePageStats()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return arena_ ? arena_->stats() : KHugePageStats();
+    }
+
+private:
+    // Fibonacci 哈希 取乘积的高位作为桶号 避免 std::hash 对整数恒等映射造成的聚集
+    // 槽位不保存哈希：POD 小对象重新求哈希的代价低于每个槽位多占 8 字节
+    size_t bucketOf(size_t hash) const
+    {
+        return static_cast<size_t>((static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull) >> indexShift_);
+    }
+
+    // 返回 key 所在位置 不存在时返回应插入的空位
+    size_t findPos(const Key& key, size_t hash) const
+    {
+        size_t mask = index_.size() - 1;
+        size_t pos = bucketOf(hash);
+        while (index_[pos] != kNil && !(slots_[index_[pos]].key == key))
+            pos = (pos + 1) & mask;
+        return pos;
+    }
+
+    /**
+     * @brief 后移删除：删除后把探测链上可以前移的元素依次前移 保证查找不会提前遇到空位
+     */
+    void eraseFromIndex(uint32_t slot)
+    {
+        size_t mask = index_.size() - 1;
+        size_t hole = findPos(slots_[slot].key, KHashOf(slots_[slot].key));
+        size_t pos = hole;
+        while (true)
+        {
+            pos = (pos + 1) & mask;
+            if (index_[pos] == kNil)
+                break;
+            size_t home = bucketOf(KHashOf(slots_[index_[pos]].key));
+            // home 不在 (hole, pos] 的环形区间内时 该元素可以移到空洞处
+            bool between = hole <= pos ? (hole < home && home <= pos) : (hole < home || home <= pos);
+            if (!between)
+            {
+                index_[hole] = index_[pos];
+                hole = pos;
+            }
+        }
+        index_[hole] = kNil;
+    }
+
+    // 取得一个可写入的槽位 缓存已满时淘汰最久未访问的条目并直接复用其槽位
+    // 后移删除可能改变 key 的插入位置 因此同时更新 pos
+    uint32_t acquireSlot(const Key& key, size_t hash, size_t& pos)
+    {
+        // 缩容后超出容量的部分 每次写入最多多淘汰 kTrimBatch 个
+        if (size_ > capacity_)
+        {
+            trimLocked(this->kTrimBatch);
+            pos = findPos(key, hash);
+        }
+        if (size_ < capacity_)
+            return allocateSlot();
+        uint32_t slot = evictOldest();
+        pos = findPos(key, hash);
+        return slot;
+    }
+
+    // 淘汰最久未访问的条目 返回空出的槽位
+    uint32_t evictOldest()
+    {
+        uint32_t slot = head_;
+        unlink(slot);
+        eraseFromIndex(slot);
+        --size_;
+        this->onEvict(slots_[slot].key, slots_[slot].value);
+        return slot;
+    }
+
+    size_t trimLocked(size_t maxEvictions)
+    {
+        while (maxEvictions-- > 0 && size_ > capacity_)
+        {
+            uint32_t slot = evictOldest();
+            slots_[slot].next = freeHead_;
+            freeHead_ = slot;
+        }
+        return size_ > capacity_ ? size_ - capacity_ : 0;
+    }
+
+    // 索引大小取不小于 2 * capacity 的 2 的幂 保证负载因子不超过 0.5 已有条目按 key 重新放置
+    void resizeIndex()
+    {
+        size_t indexSize = 2;
+        while (indexSize < 2 * static_cast<size_t>(capacity_))
+            indexSize <<= 1;
+        index_.assign(indexSize, kNil);
+        indexShift_ = 64;
+        for (size_t n = indexSize; n > 1; n >>= 1)
+            --indexShift_;
+        for (uint32_t slot = head_; slot != kNil; slot = slots_[slot].next)
+            index_[findPos(slots_[slot].key, KHashOf(slots_[slot].key))] = slot;
+    }
+
+    uint32_t allocateSlot()
+    {
+        if (freeHead_ != kNil)
+        {
+            uint32_t slot = freeHead_;
+            freeHead_ = slots_[slot].next;
+            return slot;
+        }
+        slots_.push_back(Slot{});
+        return static_cast<uint32_t>(slots_.size() - 1);
+    }
+
+    // 链表头为最久未访问 链表尾为最近访问 与通用 KLruCache 一致
+    void unlink(uint32_t slot)
+    {
+        Slot& s = slots_[slot];
+        if (s.prev != kNil) slots_[s.prev].next = s.next; else head_ = s.next;
+        if (s.next != kNil) slots_[s.next].prev = s.prev; else tail_ = s.prev;
+    }
+
+    void linkAtTail(uint32_t slot)
+    {
+        slots_[slot].prev = tail_;
+        slots_[slot].next = kNil;
+        if (tail_ != kNil) slots_[tail_].next = slot; else head_ = slot;
+        tail_ = slot;
+    }
+
+    void linkAtHead(uint32_t slot)
+    {
+        slots_[slot].prev = kNil;
+        slots_[slot].next = head_;
+        if (head_ != kNil) slots_[head_].prev = slot; else tail_ = slot;
+        head_ = slot;
+    }
+
+    void moveToMostRecent(uint32_t slot)
+    {
+        if (slot == tail_)
+            return;
+        unlink(slot);
+        linkAtTail(slot);
+    }
+
+private:
+    std::unique_ptr<KHugePageArena> arena_; // 大页内存池 为空表示使用普通堆内存
+    uint32_t              capacity_;   // 缓存最大容量
+    uint32_t              head_;       // 最久未访问的槽位
+    uint32_t              tail_;       // 最近访问的槽位
+    uint32_t              freeHead_;   // 空闲槽位链表(remove 归还的槽位)
+    uint32_t              size_;       // 当前条目数
+    unsigned              indexShift_; // Fibonacci 哈希的右移位数 = 64 - log2(索引大小)
+    std::vector<Slot, KArenaAllocator<Slot>>         slots_; // 连续的槽位数组
+    std::vector<uint32_t, KArenaAllocator<uint32_t>> index_; // 开放寻址索引 存放槽位下标
+    std::mutex            mutex_;      // 互斥锁，保证线程安全
+};
+
+} // namespace KamaCache
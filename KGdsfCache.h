@@ -0,0 +1,250 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "KHashIndex.h"
+#include "KICachePolicy.h"
+#include "KIndexedHeap.h"
+
+namespace KamaCache
+{
+
+/**
+ * @brief GDSF 缓存节点 由索引持有 同时位于优先级堆中
+ */
+template<typename Key, typename Value>
+struct GdsfNode
+{
+    Key      key;
+    Value    value;
+    size_t   hash;
+    size_t   freq;      // 驻留期间的访问次数
+    double   cost;      // 未命中时重新获取的代价
+    size_t   size;      // 占用的容量
+    double   priority;  // 写入或最近一次访问时计算的优先级 = 通胀值 + 频次 * 代价 / 大小
+    uint64_t seq;       // 最近一次访问的序号 优先级相同时先淘汰更久未访问的
+    size_t   heapIndex; // 在堆中的下标
+
+    GdsfNode(const Key& k, const Value& v, size_t h)
+        : key(k), value(v), hash(h), freq(0), cost(1.0), size(1), priority(0), seq(0), heapIndex(0)
+    {}
+
+    const Key& getKey() const { return key; }
+    size_t getHash() const { return hash; }
+};
+
+/**
+ * @brief GreedyDual-Size-Frequency 代价感知淘汰策略
+ *
+ * 核心设计：
+ * 1. 每个条目写入时可以携带未命中代价 cost 与大小 size，优先级 H = L + freq * cost / size，
+ *    总是淘汰 H 最小的条目，因此代价高、体积小、访问频繁的条目更容易留下，目标是最小化总的未命中代价。
+ * 2. L 是全局通胀值，每次淘汰时提升为被淘汰条目的 H。新写入或被访问的条目按当前 L 计算 H，
+ *    长期不被访问的条目相对"贬值"，相当于老化，不需要遍历调整其他条目(惰性通胀)。
+ * 3. 条目放在可按节点更新的小顶堆中，访问时原地上浮下沉，更新与淘汰都是 O(log n)。
+ * 4. 容量按 size 之和计算；通过基类接口写入时 cost = 1、size = 1，此时退化为带老化的 LFU。
+ */
+template<typename Key, typename Value>
+class KGdsfCache : public KICachePolicy<Key, Value>
+{
+public:
+    using NodeType = GdsfNode<Key, Value>;
+    using NodePtr = std::shared_ptr<NodeType>;
+    using NodeMap = KHashIndex<Key, NodePtr>;
+
+    /**
+     * @brief 构造函数
+     *
+     * @param capacity 缓存容量 以条目 size 之和计
+     */
+    explicit KGdsfCache(size_t capacity)
+        : capacity_(capacity)
+        , used_(0)
+        , inflation_(0)
+        , clock_(0)
+    {}
+
+    ~KGdsfCache() override = default;
+
+    void put(Key key, Value value) override
+    {
+        put(key, value, 1.0, 1, KHashOf(key));
+    }
+
+    // 使用调用方预先算好的哈希值 要求 hash == KHashOf(key)
+    void put(const Key& key, const Value& value, size_t hash)
+    {
+        put(key, value, 1.0, 1, hash);
+    }
+
+    /**
+     * @brief 带代价与大小的写入
+     *
+     * @param cost 未命中时重新获取该条目的代价 单位由调用方决定(如微秒) 必须大于 0
+     * @param size 条目占用的容量 大于总容量的条目不会被缓存
+     */
+    void put(const Key& key, const Value& value, double cost, size_t size)
+    {
+        put(key, value, cost, size, KHashOf(key));
+    }
+
+    void put(const Key& key, const Value& value, double cost, size_t size, size_t hash)
+    {
+        if (size == 0)
+            size = 1;
+        std::lock_guard<std::mutex> lock(mutex_);
+        // 缩容后超出容量的部分分批回收 本次写入只保证不让已用容量继续超出
+        trimLocked(this->kTrimBatch);
+        size_t limit = std::max(capacity_, used_);
+        NodePtr* found = nodeMap_.find(key, hash);
+        if (found)
+        {
+            NodePtr node = *found;
+            used_ = used_ - node->size + size;
+            node->value = value;
+            node->cost = cost;
+            node->size = size;
+            touch(node);
+            heap_.update(node);
+            // 变大后可能超出容量 此时被淘汰的也可能是它自己
+            while (used_ > limit)
+                evict();
+            return;
+        }
+
+        if (size > capacity_)
+            return;
+        while (used_ + size > limit)
+            evict();
+
+        NodePtr node = std::make_shared<NodeType>(key, value, hash);
+        node->cost = cost;
+        node->size = size;
+        touch(node);
+        used_ += size;
+        heap_.push(node);
+        nodeMap_.insert(hash, node);
+    }
+
+    bool get(Key key, Value& value) override
+    {
+        return get(key, value, KHashOf(key));
+    }
+
+    bool get(const Key& key, Value& value, size_t hash)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        NodePtr* found = nodeMap_.find(key, hash);
+        if (!found)
+            return false;
+        NodePtr node = *found;
+        touch(node);
+        heap_.update(node);
+        value = node->value;
+        return true;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 只更新已存在条目的值 代价、大小与优先级都不变
+    bool updateIfPresent(Key key, Value value) override
+    {
+        size_t hash = KHashOf(key);
+        std::lock_guard<std::mutex> lock(mutex_);
+        NodePtr* found = nodeMap_.find(key, hash);
+        if (!found)
+            return false;
+        (*found)->value = std::move(value);
+        return true;
+    }
+
+    void remove(Key key)
+    {
+        remove(key, KHashOf(key));
+    }
+
+    void remove(const Key& key, size_t hash)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        NodePtr* found = nodeMap_.find(key, hash);
+        if (!found)
+            return;
+        NodePtr node = *found;
+        heap_.erase(node);
+        used_ -= node->size;
+        nodeMap_.erase(key, hash);
+    }
+
+    // 当前的通胀值 L 即最近一次被淘汰条目的优先级
+    double inflation() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return inflation_;
+    }
+
+    // 容量以 size 之和计
+    void setCapacity(size_t capacity) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capacity_ = capacity;
+    }
+
+    // 按淘汰的条目数计 返回之后仍超出的容量(以 size 计)
+    size_t trim(size_t maxEvictions) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return trimLocked(maxEvictions);
+    }
+
+private:
+    size_t trimLocked(size_t maxEvictions)
+    {
+        while (maxEvictions-- > 0 && used_ > capacity_)
+            evict();
+        return used_ > capacity_ ? used_ - capacity_ : 0;
+    }
+
+    // 记一次访问 按当前通胀值重新计算优先级
+    void touch(const NodePtr& node)
+    {
+        ++node->freq;
+        node->priority = inflation_ + node->freq * node->cost / node->size;
+        node->seq = ++clock_;
+    }
+
+    void evict()
+    {
+        NodePtr victim = heap_.pop();
+        if (victim->priority > inflation_)
+            inflation_ = victim->priority;
+        used_ -= victim->size;
+        nodeMap_.eraseNode(victim);
+        this->onEvict(victim->key, victim->value);
+    }
+
+private:
+    struct PriorityLess
+    {
+        bool operator()(const NodePtr& a, const NodePtr& b) const
+        {
+            return a->priority < b->priority || (a->priority == b->priority && a->seq < b->seq);
+        }
+    };
+
+    size_t                              capacity_;  // 缓存容量 以 size 之和计
+    size_t                              used_;      // 已使用的容量
+    double                              inflation_; // 通胀值 L
+    uint64_t                            clock_;     // 访问序号
+    KIndexedHeap<NodePtr, PriorityLess> heap_;      // 按优先级排列的小顶堆
+    NodeMap                             nodeMap_;   // key -> 节点 的索引
+    mutable std::mutex                  mutex_;     // 互斥锁，保证线程安全
+};
+
+} // namespace KamaCache
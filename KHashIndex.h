@@ -0,0 +1,220 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace KamaCache
+{
+
+/**
+ * @brief 计算 key 的完整哈希值
+ * 一次操作只计算一次，随后沿着 分片路由 -> 索引查找 -> 淘汰删除 -> 幽灵缓存插入 一路传递并保存在节点中。
+ * 所有带 hash 参数的接口都要求 hash == KHashOf(key)。
+ */
+template<typename Key>
+inline size_t KHashOf(const Key& key)
+{
+    return std::hash<Key>{}(key);
+}
+
+/**
+ * @brief 保存节点哈希值的开放寻址索引 (key -> 节点指针)
+ *
+ * 与 std::unordered_map 相比：
+ * 1. find / erase 可以直接使用调用方已经算好的哈希值，不会再次对 key 求哈希。
+ * 2. eraseNode 按节点指针删除：使用节点中保存的哈希定位，按指针比较，完全不需要比较或哈希 key。
+ * 3. 扩容与删除后移只使用槽位中保存的哈希值，同样不会重新计算哈希。
+ * 4. 桶号取哈希乘以黄金分割常数后的高位，与分片路由使用的 hash % sliceNum 互不相关，
+ *    因此同一分片内的 key 不会因为低位相同而聚集。
+ *
+ * 节点需要提供 getKey() 与 getHash() 两个访问器。
+ * Alloc 用于分配槽位数组，例如用 KArenaAllocator 把大型索引放到大页上。
+ */
+template<typename Key, typename NodePtr, typename Alloc = std::allocator<NodePtr>>
+class KHashIndex
+{
+private:
+    struct Entry
+    {
+        size_t  hash = 0;
+        NodePtr node{}; // 为空表示空槽
+    };
+
+    using EntryAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Entry>;
+    using EntryVector = std::vector<Entry, EntryAlloc>;
+
+public:
+    explicit KHashIndex(size_t initialCapacity = 8, const Alloc& alloc = Alloc())
+        : entries_(EntryAlloc(alloc))
+        , size_(0)
+        , shift_(0)
+    {
+        size_t capacity = 8;
+        while (capacity * 7 < initialCapacity * 10)
+            capacity <<= 1;
+        resetTable(capacity);
+    }
+
+    /**
+     * @brief 查找 key 对应的节点指针
+     *
+     * @return NodePtr* 不存在时返回 nullptr；返回的指针在下一次插入前有效
+     */
+    NodePtr* find(const Key& key, size_t hash)
+    {
+        size_t pos = findPos(key, hash);
+        return entries_[pos].node ? &entries_[pos].node : nullptr;
+    }
+
+    // 只读查找 多个读者可以在共享锁下并发调用
+    const NodePtr* find(const Key& key, size_t hash) const
+    {
+        size_t pos = findPos(key, hash);
+        return entries_[pos].node ? &entries_[pos].node : nullptr;
+    }
+
+    bool contains(const Key& key, size_t hash) const
+    {
+        return static_cast<bool>(entries_[findPos(key, hash)].node);
+    }
+
+    /**
+     * @brief 插入节点 已存在相同 key 时覆盖(与 unordered_map::operator[] 赋值语义一致)
+     */
+    void insert(size_t hash, NodePtr node)
+    {
+        if ((size_ + 1) * 10 > entries_.size() * 7) // 负载因子不超过 0.7
+            grow();
+        size_t pos = findPos(node->getKey(), hash);
+        if (!entries_[pos].node)
+            ++size_;
+        entries_[pos].hash = hash;
+        entries_[pos].node = std::move(node);
+    }
+
+    bool erase(const Key& key, size_t hash)
+    {
+        size_t pos = findPos(key, hash);
+        if (!entries_[pos].node)
+            return false;
+        eraseAt(pos);
+        return true;
+    }
+
+    /**
+     * @brief 按节点删除：用节点保存的哈希定位，按指针比较，不触碰 key
+     *
+     * @return false 索引中没有这个节点(可能已被同名的新节点覆盖)
+     */
+    bool eraseNode(const NodePtr& node)
+    {
+        size_t mask = entries_.size() - 1;
+        for (size_t pos = bucketOf(node->getHash()); entries_[pos].node; pos = (pos + 1) & mask)
+        {
+            if (entries_[pos].node == node)
+            {
+                eraseAt(pos);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 遍历所有节点 遍历过程中不能插入或删除
+    template<typename Func>
+    void forEach(Func&& func) const
+    {
+        for (const Entry& entry : entries_)
+        {
+            if (entry.node)
+                func(entry.node);
+        }
+    }
+
+    void clear()
+    {
+        resetTable(8);
+        size_ = 0;
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+private:
+    size_t bucketOf(size_t hash) const
+    {
+        return static_cast<size_t>((static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull) >> shift_);
+    }
+
+    // 返回 key 所在槽位 不存在时返回探测链末尾的空槽
+    size_t findPos(const Key& key, size_t hash) const
+    {
+        size_t mask = entries_.size() - 1;
+        size_t pos = bucketOf(hash);
+        while (entries_[pos].node && !(entries_[pos].hash == hash && entries_[pos].node->getKey() == key))
+            pos = (pos + 1) & mask;
+        return pos;
+    }
+
+    /**
+     * @brief 后移删除：把探测链上可以前移的元素依次前移 不需要墓碑标记
+     */
+    void eraseAt(size_t hole)
+    {
+        size_t mask = entries_.size() - 1;
+        size_t pos = hole;
+        while (true)
+        {
+            pos = (pos + 1) & mask;
+            if (!entries_[pos].node)
+                break;
+            size_t home = bucketOf(entries_[pos].hash);
+            // home 不在 (hole, pos] 的环形区间内时 该元素可以移到空洞处
+            bool between = hole <= pos ? (hole < home && home <= pos) : (hole < home || home <= pos);
+            if (!between)
+            {
+                entries_[hole] = std::move(entries_[pos]);
+                hole = pos;
+            }
+        }
+        entries_[hole] = Entry{};
+        --size_;
+    }
+
+    void resetTable(size_t capacity)
+    {
+        entries_.clear();
+        entries_.resize(capacity);
+        shift_ = 64;
+        for (size_t n = capacity; n > 1; n >>= 1)
+            --shift_;
+    }
+
+    // 容量翻倍 使用保存的哈希重新放置 不重新计算 key 的哈希
+    void grow()
+    {
+        EntryVector old = std::move(entries_);
+        resetTable(old.size() * 2);
+        size_t mask = entries_.size() - 1;
+        for (Entry& entry : old)
+        {
+            if (!entry.node)
+                continue;
+            size_t pos = bucketOf(entry.hash);
+            while (entries_[pos].node)
+                pos = (pos + 1) & mask;
+            entries_[pos] = std::move(entry);
+        }
+    }
+
+private:
+    EntryVector entries_; // 槽位数组 大小为 2 的幂
+    size_t      size_;    // 已使用的槽位数
+    unsigned    shift_;   // 取高位的右移位数 = 64 - log2(槽位数)
+};
+
+} // namespace KamaCache
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "KHashIndex.h"
+#include "KIndexedHeap.h"
+
+namespace KamaCache
+{
+
+// 一个热点 key 的统计结果
+template<typename Key>
+struct KHotKey
+{
+    Key      key{};
+    uint64_t count = 0; // 估计访问次数 不会低于真实值
+    uint64_t error = 0; // 最大高估量 真实访问次数在 [count - error, count] 之间
+    int      shard = 0; // 所在分片
+};
+
+/**
+ * @brief Space-Saving 热点统计
+ *
+ * 固定使用 m 个计数器：
+ * 1. 被跟踪的 key 再次出现时计数加一。
+ * 2. 未被跟踪的 key 出现时，若计数器已满则接管计数最小的计数器：
+ *    新计数 = 原最小计数 + 1，误差记为原最小计数。
+ * 任何真实访问次数超过 N / m 的 key(N 为总次数)一定在计数器中，每个计数的高估量不超过 N / m。
+ * 内存与访问流的 key 数量无关，每次记录为一次索引查找加一次 O(log m) 的堆调整。
+ *
+ * 本类不加锁，由调用方保证互斥。
+ */
+template<typename Key>
+class KSpaceSaving
+{
+private:
+    struct Counter
+    {
+        Key      key{};
+        size_t   hash = 0;
+        uint64_t count = 0;
+        uint64_t error = 0;
+        size_t   heapIndex = 0;
+
+        const Key& getKey() const { return key; }
+        size_t getHash() const { return hash; }
+    };
+
+    struct CountLess
+    {
+        bool operator()(const Counter* a, const Counter* b) const { return a->count < b->count; }
+    };
+
+public:
+    explicit KSpaceSaving(size_t counters)
+        : capacity_(counters > 0 ? counters : 1)
+        , counters_(new Counter[capacity_])
+        , used_(0)
+        , total_(0)
+        , index_(capacity_)
+    {}
+
+    // 记录一次访问 要求 hash == KHashOf(key)
+    void record(const Key& key, size_t hash, uint64_t weight = 1)
+    {
+        total_ += weight;
+        Counter** found = index_.find(key, hash);
+        if (found)
+        {
+            Counter* counter = *found;
+            counter->count += weight;
+            heap_.update(counter);
+            return;
+        }
+
+        if (used_ < capacity_)
+        {
+            Counter* counter = &counters_[used_++];
+            counter->key = key;
+            counter->hash = hash;
+            counter->count = weight;
+            counter->error = 0;
+            index_.insert(hash, counter);
+            heap_.push(counter);
+            return;
+        }
+
+        // 接管计数最小的计数器 它原来跟踪的 key 被替换
+        Counter* counter = heap_.top();
+        index_.eraseNode(counter);
+        counter->key = key;
+        counter->hash = hash;
+        counter->error = counter->count;
+        counter->count += weight;
+        index_.insert(hash, counter);
+        heap_.update(counter);
+    }
+
+    // 计数最大的 k 个 key 按计数从大到小排列
+    std::vector<KHotKey<Key>> top(size_t k) const
+    {
+        std::vector<KHotKey<Key>> result;
+        result.reserve(used_);
+        for (size_t i = 0; i < used_; ++i)
+        {
+            KHotKey<Key> hot;
+            hot.key = counters_[i].key;
+            hot.count = counters_[i].count;
+            hot.error = counters_[i].error;
+            result.push_back(hot);
+        }
+        sortByCount(result, k);
+        return result;
+    }
+
+    // 计数与误差减半 定期调用后统计结果反映近期的访问速率而不是历史累计
+    void decay()
+    {
+        total_ /= 2;
+        for (size_t i = 0; i < used_; ++i)
+        {
+            counters_[i].count /= 2;
+            counters_[i].error /= 2;
+        }
+        // 所有计数同比缩小 堆序不变
+    }
+
+    void clear()
+    {
+        index_.clear();
+        heap_.clear();
+        used_ = 0;
+        total_ = 0;
+    }
+
+    // 已记录的总次数
+    uint64_t total() const { return total_; }
+
+    // 单个计数的最大高估量
+    uint64_t maxError() const { return used_ < capacity_ ? 0 : heap_.top()->count; }
+
+    static void sortByCount(std::vector<KHotKey<Key>>& keys, size_t k)
+    {
+        auto byCount = [](const KHotKey<Key>& a, const KHotKey<Key>& b) { return a.count > b.count; };
+        if (k < keys.size())
+        {
+            std::partial_sort(keys.begin(), keys.begin() + k, keys.end(), byCount);
+            keys.resize(k);
+        }
+        else
+        {
+            std::sort(keys.begin(), keys.end(), byCount);
+        }
+    }
+
+private:
+    size_t                                  capacity_; // 计数器数量
+    std::unique_ptr<Counter[]>              counters_; // 计数器池 地址不变 索引与堆直接保存指针
+    size_t                                  used_;     // 已使用的计数器数
+    uint64_t                                total_;    // 已记录的总次数
+    KHashIndex<Key, Counter*>               index_;    // key -> 计数器
+    KIndexedHeap<Counter*, CountLess>       heap_;     // 按计数排序的小顶堆 堆顶为最小计数
+};
+
+/**
+ * @brief 按分片的热点 key 跟踪器 供分片缓存常驻开启
+ *
+ * 每个分片一个 KSpaceSaving 和一把独立的锁，与分片缓存自身的锁互不影响：
+ * 1. 采样：每个分片每 sampleEvery 次访问记录一次，计数在查询时乘回采样倍数。
+ * 2. 记录时只 try_lock，分片的统计正在被其他线程更新时直接放弃这次采样，访问路径上从不阻塞。
+ * 由于同一个 key 只会落在一个分片，合并各分片结果时只需要按计数取前 k 个，误差界不变。
+ */
+template<typename Key>
+class KHotKeyTracker
+{
+private:
+    struct Shard
+    {
+        explicit Shard(size_t counters)
+            : sketch(counters)
+        {}
+
+        KSpaceSaving<Key>     sketch;
+        std::mutex            mutex;
+        std::atomic<uint32_t> ticks{0}; // 访问计数 决定哪些访问被采样
+    };
+
+public:
+    /**
+     * @brief 构造函数
+     *
+     * @param shards 分片数 与分片缓存一致
+     * @param counters 每个分片的计数器数量 取关注的 k 的数倍可以降低误差
+     * @param sampleEvery 采样间隔 1 表示记录每一次访问
+     */
+    KHotKeyTracker(int shards, size_t counters, uint32_t sampleEvery = 16)
+        : sampleEvery_(sampleEvery > 0 ? sampleEvery : 1)
+    {
+        for (int i = 0; i < (shards > 0 ? shards : 1); ++i)
+            shards_.emplace_back(new Shard(counters));
+    }
+
+    // 记录分片 shard 上的一次访问 大部分调用只做一次原子计数
+    void record(int shard, const Key& key, size_t hash)
+    {
+        Shard& s = *shards_[shard];
+        if ((s.ticks.fetch_add(1, std::memory_order_relaxed) + 1) % sampleEvery_ != 0)
+            return;
+        std::unique_lock<std::mutex> lock(s.mutex, std::try_to_lock);
+        if (lock.owns_lock())
+            s.sketch.record(key, hash);
+    }
+
+    // 所有分片中估计访问次数最多的 k 个 key
+    std::vector<KHotKey<Key>> top(size_t k)
+    {
+        std::vector<KHotKey<Key>> result;
+        for (size_t i = 0; i < shards_.size(); ++i)
+        {
+            std::vector<KHotKey<Key>> keys;
+            {
+                std::lock_guard<std::mutex> lock(shards_[i]->mutex);
+                keys = shards_[i]->sketch.top(k);
+            }
+            for (KHotKey<Key>& hot : keys)
+            {
+                hot.count *= sampleEvery_;
+                hot.error *= sampleEvery_;
+                hot.shard = static_cast<int>(i);
+                result.push_back(hot);
+            }
+        }
+        KSpaceSaving<Key>::sortByCount(result, k);
+        return result;
+    }
+
+    // 每个分片记录到的估计访问次数 用于找出过载的分片
+    std::vector<uint64_t> shardLoads()
+    {
+        std::vector<uint64_t> loads;
+        for (auto& shard : shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            loads.push_back(shard->sketch.total() * sampleEvery_);
+        }
+        return loads;
+    }
+
+    void decay()
+    {
+        for (auto& shard : shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->sketch.decay();
+        }
+    }
+
+private:
+    uint32_t                            sampleEvery_; // 采样间隔
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+} // namespace KamaCache
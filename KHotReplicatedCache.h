@@ -0,0 +1,300 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "KShardedCache.h"
+
+namespace KamaCache
+{
+
+// 热点复制的参数
+struct KHotReplicaOptions
+{
+    int      replicas = 8;          // 热点层的副本数 读线程按线程号选择副本
+    size_t   maxHotKeys = 8;        // 同时复制的热点 key 上限
+    double   hotShare = 0.01;       // 访问占比达到该比例的 key 视为热点
+    uint32_t refreshEvery = 65536;  // 每个副本通道每隔多少次访问尝试刷新一次热点集合
+    std::chrono::milliseconds refreshInterval = std::chrono::milliseconds(100); // 两次刷新的最小间隔
+};
+
+/**
+ * @brief 热点 key 复制的分片缓存
+ *
+ * 普通分片缓存中一个爆款 key 只会路由到一个分片，无论分片多少，所有线程都在争抢这一个分片的锁。
+ * 本类在 KShardedCache 之外增加一个热点层：
+ * 1. 用分片热点跟踪器(KHotKeyTracker)找出访问占比超过 hotShare 的 key，周期性刷新热点集合。
+ * 2. 热点 key 的值复制到 replicas 个副本中，每个副本独占一条缓存行和一把锁，
+ *    读线程按线程号固定访问其中一个副本，不同线程的读不再竞争同一把锁。
+ * 3. 一个 1024 位的原子位图记录热点 key 的哈希，非热点 key 只多一次 relaxed 读。
+ * 4. 写入先写分片，再检查位图：key 是热点时锁住全部副本，从分片重新读取最新值覆盖所有副本，
+ *    并发写入的先后顺序以分片为准，副本不会停留在较旧的值上。
+ *
+ * SliceCache 的要求与 KShardedCache 相同。
+ */
+template<typename Key, typename Value, typename SliceCache>
+class KHotReplicatedCache : public KShardedCache<Key, Value, SliceCache>
+{
+private:
+    using Base = KShardedCache<Key, Value, SliceCache>;
+
+    static constexpr size_t kBitmapWords = 16; // 1024 位
+
+    struct HotEntry
+    {
+        Key    key;
+        size_t hash;
+        Value  value;
+    };
+
+    // 一个副本 独占缓存行 避免不同副本的锁互相伪共享
+    struct alignas(64) Replica
+    {
+        std::mutex            mutex;
+        std::vector<HotEntry> entries; // 热点数量很少 线性查找
+        std::atomic<uint32_t> ticks{0}; // 选择该副本的线程的访问计数 决定何时尝试刷新
+
+        HotEntry* find(const Key& key, size_t hash)
+        {
+            for (HotEntry& entry : entries)
+            {
+                if (entry.hash == hash && entry.key == key)
+                    return &entry;
+            }
+            return nullptr;
+        }
+    };
+
+public:
+    template<typename... SliceArgs>
+    KHotReplicatedCache(size_t capacity, int sliceNum, const KHotReplicaOptions& options, SliceArgs&&... sliceArgs)
+        : Base(capacity, sliceNum, std::forward<SliceArgs>(sliceArgs)...)
+        , options_(options)
+        , replicaNum_(options.replicas > 0 ? options.replicas : 1)
+        , replicas_(new Replica[replicaNum_])
+        , lastRefresh_(std::chrono::steady_clock::now())
+    {
+        for (auto& word : hotBits_)
+            word.store(0, std::memory_order_relaxed);
+        this->enableHotKeyTracking(options_.maxHotKeys * 8);
+    }
+
+    void put(Key key, Value value)
+    {
+        size_t hash = KHashOf(key);
+        this->hotKeys_->record(this->hotKeyLane(hash), key, hash);
+        this->putHashed(key, std::move(value), hash);
+        // 与 refreshLocked 中 "置位后读取分片" 配对：要么刷新读到这次写入，要么这里看到置位
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (maybeHot(hash))
+            syncReplicas(key, hash);
+        maybeRefresh();
+    }
+
+    bool get(Key key, Value& value)
+    {
+        size_t hash = KHashOf(key);
+        this->hotKeys_->record(this->hotKeyLane(hash), key, hash);
+        maybeRefresh();
+        if (maybeHot(hash))
+        {
+            Replica& replica = replicas_[laneOfThread()];
+            std::lock_guard<std::mutex> lock(replica.mutex);
+            if (HotEntry* entry = replica.find(key, hash))
+            {
+                value = entry->value;
+                return true;
+            }
+        }
+        return this->getHashed(key, value, hash);
+    }
+
+    Value get(Key key)
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    /**
+     * @brief 按热点统计重新选出热点集合 新热点复制到所有副本 不再热的 key 移出热点层
+     *
+     * 通常由访问线程周期性自动调用，也可以由后台线程显式调用。
+     */
+    void refreshHotKeys()
+    {
+        std::lock_guard<std::mutex> refreshLock(refreshMutex_);
+        refreshLocked();
+    }
+
+    // 当前被复制的热点 key
+    std::vector<Key> replicatedKeys()
+    {
+        std::lock_guard<std::mutex> lock(replicas_[0].mutex);
+        std::vector<Key> keys;
+        for (const HotEntry& entry : replicas_[0].entries)
+            keys.push_back(entry.key);
+        return keys;
+    }
+
+private:
+    static size_t bitOf(size_t hash)
+    {
+        // 位图使用哈希的高位 与分片路由(低位取模)无关
+        return (static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull) >> 54;
+    }
+
+    bool maybeHot(size_t hash) const
+    {
+        size_t bit = bitOf(hash);
+        return hotBits_[bit / 64].load(std::memory_order_relaxed) & (1ull << (bit % 64));
+    }
+
+    size_t laneOfThread() const
+    {
+        thread_local size_t lane = std::hash<std::thread::id>{}(std::this_thread::get_id());
+        return lane % replicaNum_;
+    }
+
+    void lockAll()
+    {
+        for (int i = 0; i < replicaNum_; ++i)
+            replicas_[i].mutex.lock();
+    }
+
+    void unlockAll()
+    {
+        for (int i = replicaNum_ - 1; i >= 0; --i)
+            replicas_[i].mutex.unlock();
+    }
+
+    // 热点 key 被写入后 从分片读取最新值覆盖所有副本
+    void syncReplicas(const Key& key, size_t hash)
+    {
+        lockAll();
+        if (replicas_[0].find(key, hash))
+        {
+            Value latest;
+            bool present = this->getHashed(key, latest, hash);
+            for (int i = 0; i < replicaNum_; ++i)
+            {
+                std::vector<HotEntry>& entries = replicas_[i].entries;
+                for (size_t j = 0; j < entries.size(); ++j)
+                {
+                    if (entries[j].hash != hash || !(entries[j].key == key))
+                        continue;
+                    if (present)
+                    {
+                        entries[j].value = latest;
+                    }
+                    else
+                    {
+                        // 分片已淘汰该 key 副本一并移除 下次读取回到分片
+                        entries[j] = std::move(entries.back());
+                        entries.pop_back();
+                    }
+                    break;
+                }
+            }
+        }
+        unlockAll();
+    }
+
+    void maybeRefresh()
+    {
+        // 计数放在本线程的副本上 各线程的计数通常互不共享缓存行
+        std::atomic<uint32_t>& ticks = replicas_[laneOfThread()].ticks;
+        if ((ticks.fetch_add(1, std::memory_order_relaxed) + 1) % std::max<uint32_t>(options_.refreshEvery, 1) != 0)
+            return;
+        std::unique_lock<std::mutex> refreshLock(refreshMutex_, std::try_to_lock);
+        if (!refreshLock.owns_lock())
+            return;
+        if (std::chrono::steady_clock::now() - lastRefresh_ < options_.refreshInterval)
+            return;
+        refreshLocked();
+    }
+
+    // 持有 refreshMutex_
+    void refreshLocked()
+    {
+        lastRefresh_ = std::chrono::steady_clock::now();
+        KHotKeyTracker<Key>& tracker = *this->hotKeys_;
+        uint64_t total = 0;
+        for (uint64_t load : tracker.shardLoads())
+            total += load;
+        std::vector<KHotKey<Key>> candidates = tracker.top(options_.maxHotKeys);
+        // 统计减半 下一轮的排名反映近期访问速率
+        tracker.decay();
+
+        std::vector<std::pair<Key, size_t>> hot;
+        for (const KHotKey<Key>& candidate : candidates)
+        {
+            // 使用计数下界判断 误差较大的 key 不会被误认为热点
+            if (total > 0 && candidate.count - candidate.error >= options_.hotShare * total)
+                hot.emplace_back(candidate.key, KHashOf(candidate.key));
+        }
+
+        lockAll();
+        // 移除不再热的 key
+        for (int i = 0; i < replicaNum_; ++i)
+        {
+            std::vector<HotEntry>& entries = replicas_[i].entries;
+            for (size_t j = 0; j < entries.size();)
+            {
+                bool keep = false;
+                for (const auto& h : hot)
+                    keep = keep || (h.second == entries[j].hash && h.first == entries[j].key);
+                if (keep)
+                {
+                    ++j;
+                }
+                else
+                {
+                    entries[j] = std::move(entries.back());
+                    entries.pop_back();
+                }
+            }
+        }
+        // 按新的热点集合重建位图：仍然热的 key 的位在新旧位图中都存在 整字写入时不会出现短暂清零，
+        // 否则这期间的写入会跳过同步，副本停留在旧值上
+        uint64_t bits[kBitmapWords] = {};
+        for (const auto& h : hot)
+        {
+            size_t bit = bitOf(h.second);
+            bits[bit / 64] |= 1ull << (bit % 64);
+        }
+        for (size_t w = 0; w < kBitmapWords; ++w)
+            hotBits_[w].store(bits[w], std::memory_order_seq_cst);
+        // 新热点：位图已置位 再从分片读取值 之后的写入一定会看到置位并同步副本
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (const auto& h : hot)
+        {
+            if (replicas_[0].find(h.first, h.second))
+                continue;
+            Value value;
+            if (!this->getHashed(h.first, value, h.second))
+                continue;
+            for (int i = 0; i < replicaNum_; ++i)
+                replicas_[i].entries.push_back(HotEntry{h.first, h.second, value});
+        }
+        unlockAll();
+    }
+
+private:
+    KHotReplicaOptions                    options_;
+    int                                   replicaNum_;            // 副本数
+    std::unique_ptr<Replica[]>            replicas_;              // 热点层副本
+    std::atomic<uint64_t>                 hotBits_[kBitmapWords]; // 热点 key 哈希位图
+    std::mutex                            refreshMutex_;          // 同一时间只有一个线程刷新热点集合
+    std::chrono::steady_clock::time_point lastRefresh_;           // 上次刷新时间 受 refreshMutex_ 保护
+};
+
+} // namespace KamaCache
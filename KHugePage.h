@@ -0,0 +1,340 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace KamaCache
+{
+
+// 大页使用方式
+enum class KHugePageMode
+{
+    Off,         // 普通内存
+    Transparent, // 2MB 对齐后 madvise(MADV_HUGEPAGE) 交给透明大页
+    Explicit     // MAP_HUGETLB 使用预留的大页 预留不足时退回 Transparent
+};
+
+constexpr size_t kHugePageSize = 2 << 20;
+
+// 一段映射的内存
+struct KHugePageRegion
+{
+    void*         data = nullptr;
+    size_t        bytes = 0;
+    KHugePageMode mode = KHugePageMode::Off; // 实际得到的方式
+};
+
+/**
+ * @brief 申请一段按大页对齐的内存 bytes 向上取整到 2MB
+ *
+ * Explicit 失败(没有预留大页)时退回 Transparent，madvise 失败(内核关闭了透明大页)时退回普通页，
+ * 非 Linux 平台直接使用普通内存。返回的 mode 是实际得到的方式。
+ */
+inline KHugePageRegion KHugePageMap(size_t bytes, KHugePageMode mode)
+{
+    KHugePageRegion region;
+    region.bytes = (std::max<size_t>(bytes, 1) + kHugePageSize - 1) & ~(kHugePageSize - 1);
+#ifdef __linux__
+#ifdef MAP_HUGETLB
+    if (mode == KHugePageMode::Explicit)
+    {
+        void* data = mmap(nullptr, region.bytes, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (data != MAP_FAILED)
+        {
+            region.data = data;
+            region.mode = KHugePageMode::Explicit;
+            return region;
+        }
+    }
+#endif
+    // 多映射 2MB 再裁掉首尾 得到按大页对齐的区域
+    size_t mapped = region.bytes + kHugePageSize;
+    void* raw = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+        throw std::bad_alloc();
+    uintptr_t begin = reinterpret_cast<uintptr_t>(raw);
+    uintptr_t aligned = (begin + kHugePageSize - 1) & ~(static_cast<uintptr_t>(kHugePageSize) - 1);
+    if (aligned > begin)
+        munmap(raw, aligned - begin);
+    size_t tail = begin + mapped - (aligned + region.bytes);
+    if (tail > 0)
+        munmap(reinterpret_cast<void*>(aligned + region.bytes), tail);
+    region.data = reinterpret_cast<void*>(aligned);
+    region.mode = KHugePageMode::Off;
+#ifdef MADV_HUGEPAGE
+    if (mode != KHugePageMode::Off && madvise(region.data, region.bytes, MADV_HUGEPAGE) == 0)
+        region.mode = KHugePageMode::Transparent;
+#endif
+#else
+    (void)mode;
+    region.data = ::operator new(region.bytes, std::align_val_t(kHugePageSize));
+#endif
+    return region;
+}
+
+inline void KHugePageUnmap(const KHugePageRegion& region)
+{
+    if (!region.data)
+        return;
+#ifdef __linux__
+    munmap(region.data, region.bytes);
+#else
+    ::operator delete(region.data, std::align_val_t(kHugePageSize));
+#endif
+}
+
+// 大页内存统计 以字节计
+struct KHugePageStats
+{
+    size_t mappedBytes = 0;      // 已映射的内存
+    size_t transparentBytes = 0; // 其中 madvise 成功的部分
+    size_t explicitBytes = 0;    // 其中来自预留大页的部分
+    size_t releasedBytes = 0;    // 其中空闲块已 madvise 归还系统、不再占用物理内存的部分
+
+    KHugePageStats& operator+=(const KHugePageStats& other)
+    {
+        mappedBytes += other.mappedBytes;
+        transparentBytes += other.transparentBytes;
+        explicitBytes += other.explicitBytes;
+        releasedBytes += other.releasedBytes;
+        return *this;
+    }
+};
+
+/**
+ * @brief 从大页区域分配节点与索引的内存池
+ *
+ * 大容量缓存的查找要依次访问索引槽位、节点、值，这些对象分散在普通 4KB 页上时几乎每次查找都会 dTLB 未命中。
+ * 内存池向系统申请 2MB 对齐的大块区域(首块 2MB，之后翻倍，最大 256MB)，对象在区域内顺序切分，
+ * 一个 2MB 大页的 TLB 项就能覆盖 512 个普通页的对象。
+ * - 不超过 2MB 的请求按尺寸分级：1KB 以内按 16 字节取整，以上按 2 的幂取整，释放后进入该级空闲链表复用；
+ *   64KB 及以上的块(如 slab 页)释放时还会对块内除首页外的整页 madvise(MADV_DONTNEED)，物理内存立即归还系统，
+ *   复用时由内核重新填零页。透明大页会因此被拆分；预留大页只能整页归还，小于 2MB 的块仍占用内存；
+ * - 超过 2MB 的请求(如大型索引的槽位数组)单独映射一段区域，释放时立即归还系统。
+ * 区域在内存池析构时才归还，因此内存池必须比从它分配的所有对象活得更久。
+ * 所有操作由一把互斥锁保护，通常每个缓存分片持有一个内存池，锁与分片锁一样没有竞争。
+ */
+class KHugePageArena
+{
+private:
+    static constexpr size_t kMaxRegionSize = 256 << 20;
+    static constexpr size_t kSmallLimit = 1024;
+    static constexpr size_t kSmallClasses = kSmallLimit / 16;
+    static constexpr size_t kClassCount = kSmallClasses + 11; // 2KB .. 2MB
+    static constexpr size_t kReleaseLimit = 64 << 10;         // 释放时归还物理内存的最小块
+
+    // 空闲块的首部 released 只在不小于 kReleaseLimit 的块中有效
+    struct FreeBlock
+    {
+        FreeBlock* next;
+        size_t     released; // 已 madvise 归还的字节
+    };
+
+public:
+    explicit KHugePageArena(KHugePageMode mode = KHugePageMode::Transparent)
+        : mode_(mode)
+        , cursor_(nullptr)
+        , end_(nullptr)
+        , nextRegionSize_(kHugePageSize)
+    {
+        std::fill(freeLists_, freeLists_ + kClassCount, nullptr);
+    }
+
+    ~KHugePageArena()
+    {
+        for (const KHugePageRegion& region : regions_)
+            KHugePageUnmap(region);
+        for (const auto& large : large_)
+            KHugePageUnmap(large.second);
+    }
+
+    KHugePageArena(const KHugePageArena&) = delete;
+    KHugePageArena& operator=(const KHugePageArena&) = delete;
+
+    // 对齐要求不超过 16 字节
+    void* allocate(size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (bytes > kHugePageSize)
+        {
+            KHugePageRegion region = KHugePageMap(bytes, mode_);
+            account(region);
+            large_.emplace(region.data, region);
+            return region.data;
+        }
+        size_t index = classOf(bytes);
+        if (FreeBlock* block = freeLists_[index])
+        {
+            freeLists_[index] = block->next;
+            if (classSize(index) >= kReleaseLimit)
+                stats_.releasedBytes -= block->released;
+            return block;
+        }
+        size_t size = classSize(index);
+        if (static_cast<size_t>(end_ - cursor_) < size)
+            addRegion(size);
+        void* result = cursor_;
+        cursor_ += size;
+        return result;
+    }
+
+    void deallocate(void* ptr, size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (bytes > kHugePageSize)
+        {
+            auto it = large_.find(ptr);
+            stats_.mappedBytes -= it->second.bytes;
+            if (it->second.mode == KHugePageMode::Transparent)
+                stats_.transparentBytes -= it->second.bytes;
+            else if (it->second.mode == KHugePageMode::Explicit)
+                stats_.explicitBytes -= it->second.bytes;
+            KHugePageUnmap(it->second);
+            large_.erase(it);
+            return;
+        }
+        size_t index = classOf(bytes);
+        FreeBlock* block = static_cast<FreeBlock*>(ptr);
+        block->next = freeLists_[index];
+        freeLists_[index] = block;
+        if (classSize(index) >= kReleaseLimit)
+        {
+            block->released = release(block, classSize(index));
+            stats_.releasedBytes += block->released;
+        }
+    }
+
+    KHugePageMode mode() const { return mode_; }
+
+    KHugePageStats stats()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+private:
+    static size_t classOf(size_t bytes)
+    {
+        if (bytes <= kSmallLimit)
+            return bytes == 0 ? 0 : (bytes - 1) / 16;
+        size_t index = kSmallClasses;
+        for (size_t size = 2 * kSmallLimit; size < bytes; size <<= 1)
+            ++index;
+        return index;
+    }
+
+    static size_t classSize(size_t index)
+    {
+        return index < kSmallClasses ? (index + 1) * 16 : (2 * kSmallLimit) << (index - kSmallClasses);
+    }
+
+    // 归还空闲块中首页之后的整页 首页保留空闲链表指针 返回实际归还的字节
+    static size_t release(void* ptr, size_t size)
+    {
+#if defined(__linux__) && defined(MADV_DONTNEED)
+        static const uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+        uintptr_t begin = reinterpret_cast<uintptr_t>(ptr) + sizeof(FreeBlock);
+        begin = (begin + pageSize - 1) & ~(pageSize - 1);
+        uintptr_t end = (reinterpret_cast<uintptr_t>(ptr) + size) & ~(pageSize - 1);
+        if (end > begin && madvise(reinterpret_cast<void*>(begin), end - begin, MADV_DONTNEED) == 0)
+            return end - begin;
+#else
+        (void)ptr;
+        (void)size;
+#endif
+        return 0;
+    }
+
+    // 当前区域放不下时映射新区域 旧区域剩余的尾部不再使用
+    void addRegion(size_t atLeast)
+    {
+        KHugePageRegion region = KHugePageMap(std::max(nextRegionSize_, atLeast), mode_);
+        account(region);
+        regions_.push_back(region);
+        cursor_ = static_cast<char*>(region.data);
+        end_ = cursor_ + region.bytes;
+        nextRegionSize_ = std::min(nextRegionSize_ * 2, kMaxRegionSize);
+    }
+
+    void account(const KHugePageRegion& region)
+    {
+        stats_.mappedBytes += region.bytes;
+        if (region.mode == KHugePageMode::Transparent)
+            stats_.transparentBytes += region.bytes;
+        else if (region.mode == KHugePageMode::Explicit)
+            stats_.explicitBytes += region.bytes;
+    }
+
+private:
+    KHugePageMode                              mode_;
+    std::mutex                                 mutex_;
+    char*                                      cursor_;         // 当前区域中下一个可用地址
+    char*                                      end_;
+    size_t                                     nextRegionSize_;
+    FreeBlock*                                 freeLists_[kClassCount];
+    std::vector<KHugePageRegion>               regions_;        // 切分小对象的区域
+    std::unordered_map<void*, KHugePageRegion> large_;          // 单独映射的大对象
+    KHugePageStats                             stats_;
+};
+
+/**
+ * @brief 从 KHugePageArena 分配的 STL 分配器 内存池为空时使用普通的 operator new
+ *
+ * 用于 allocate_shared 创建的节点与索引的槽位数组。
+ */
+template<typename T>
+class KArenaAllocator
+{
+public:
+    using value_type = T;
+
+    static_assert(alignof(T) <= 16, "内存池只保证 16 字节对齐");
+
+    explicit KArenaAllocator(KHugePageArena* arena = nullptr) noexcept
+        : arena_(arena)
+    {}
+
+    template<typename U>
+    KArenaAllocator(const KArenaAllocator<U>& other) noexcept
+        : arena_(other.arena())
+    {}
+
+    T* allocate(size_t n)
+    {
+        if (!arena_)
+            return std::allocator<T>().allocate(n);
+        return static_cast<T*>(arena_->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n)
+    {
+        if (!arena_)
+            std::allocator<T>().deallocate(ptr, n);
+        else
+            arena_->deallocate(ptr, n * sizeof(T));
+    }
+
+    KHugePageArena* arena() const noexcept { return arena_; }
+
+    template<typename U>
+    bool operator==(const KArenaAllocator<U>& other) const noexcept { return arena_ == other.arena(); }
+    template<typename U>
+    bool operator!=(const KArenaAllocator<U>& other) const noexcept { return arena_ != other.arena(); }
+
+private:
+    KHugePageArena* arena_;
+};
+
+} // namespace KamaCache
@@ -1,5 +1,8 @@
 #pragma once // 防止头文件被重复包含
 
+#include <cstddef>
+#include <functional>
+
 // =========================================================================
 // 泛型接口设计 (Templated Interface)
 // 
@@ -44,6 +47,71 @@ public:
     // =====================================================================
     virtual Value get(Key key) = 0;
 
+    // =====================================================================
+    // 冷端写入 (Cold Insert)
+    //
+    // 把数据作为"下一个被淘汰"的条目写入，用于扫描、回填等只访问一次的数据：
+    // 被再次访问前它会最先被淘汰，不会挤掉工作集。已存在的 key 只更新值，不改变位置。
+    // 默认实现等同于 put；能区分冷热端的策略(如 LRU / SLRU)会覆写它。
+    // =====================================================================
+    virtual void putCold(Key key, Value value) { put(key, value); }
+
+    // =====================================================================
+    // 只更新已有条目 (Update If Present)
+    //
+    // key 已在缓存中时替换它的值并返回 true，否则什么都不做并返回 false。
+    // 与 get + put 不同，它不改变访问顺序、访问频率等淘汰状态，也不写入新 key，
+    // 供准入层(KDoorkeeperCache / KScanResistantCache)在拒绝写入时刷新已缓存的旧值。
+    // 默认实现退化为 get + put，会像一次访问那样影响淘汰状态；本库的策略都覆写了它。
+    // =====================================================================
+    virtual bool updateIfPresent(Key key, Value value)
+    {
+        Value old;
+        if (!get(key, old))
+            return false;
+        put(key, value);
+        return true;
+    }
+
+    // =====================================================================
+    // 运行期调整容量 (Runtime Resize)
+    //
+    // 扩容立即生效。缩容只修改容量，超出部分不在调用时一次淘汰，避免长时间持锁造成延迟尖刺：
+    // 之后的每次写入除了为自己腾出位置，最多再多淘汰 kTrimBatch 个条目；
+    // 也可以由维护线程(KMaintenanceThread)反复调用 trim 分批回收。
+    // =====================================================================
+    virtual void setCapacity(size_t capacity) = 0;
+
+    // 最多淘汰 maxEvictions 个超出容量的条目 返回之后仍超出容量的条目数 trim(0) 只查询不淘汰
+    virtual size_t trim(size_t maxEvictions) = 0;
+
+    // =====================================================================
+    // 淘汰回调 (Eviction Callback)
+    //
+    // 被淘汰的数据默认直接丢弃；注册回调后，子类在淘汰节点时会把 key/value
+    // 交给回调，例如写入二级缓存 (KTieredCache)。
+    // 回调在子类持有自身互斥锁时执行，因此回调内部不能再访问当前缓存，否则会死锁。
+    // =====================================================================
+    using EvictCallback = std::function<void(const Key&, const Value&)>;
+
+    void setEvictCallback(EvictCallback callback) { evictCallback_ = std::move(callback); }
+
+protected:
+    // 缩容后每次写入额外淘汰的条目数上限
+    static constexpr size_t kTrimBatch = 8;
+
+    // 供子类在淘汰节点时调用
+    void onEvict(const Key& key, const Value& value)
+    {
+        if (evictCallback_)
+            evictCallback_(key, value);
+    }
+
+    // 构造被淘汰的 value 有额外开销的子类可以先检查是否注册了回调
+    bool hasEvictCallback() const { return static_cast<bool>(evictCallback_); }
+
+private:
+    EvictCallback evictCallback_; // 淘汰回调 为空时不做任何事
 };
 
 } // namespace KamaCache
\ No newline at end of file
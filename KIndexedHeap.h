@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace KamaCache
+{
+
+/**
+ * @brief 可按节点更新与删除的二叉小顶堆
+ *
+ * 节点在堆中的下标保存在节点的 heapIndex 成员中，因此修改某个节点的优先级后
+ * 可以直接从它的位置上浮或下沉，update / erase 都是 O(log n)，不需要先查找。
+ * Less(a, b) 为 true 表示 a 应当先于 b 出堆(即 a 先被淘汰)。
+ *
+ * NodePtr 可以是原始指针或智能指针，节点需要有可写的 size_t heapIndex 成员。
+ */
+template<typename NodePtr, typename Less>
+class KIndexedHeap
+{
+public:
+    explicit KIndexedHeap(Less less = Less())
+        : less_(std::move(less))
+    {}
+
+    void push(NodePtr node)
+    {
+        node->heapIndex = heap_.size();
+        heap_.push_back(std::move(node));
+        siftUp(heap_.size() - 1);
+    }
+
+    const NodePtr& top() const { return heap_.front(); }
+
+    NodePtr pop()
+    {
+        NodePtr node = std::move(heap_.front());
+        removeAt(0);
+        return node;
+    }
+
+    // 节点优先级改变后调用 恢复堆序
+    void update(const NodePtr& node)
+    {
+        size_t pos = node->heapIndex;
+        if (pos > 0 && less_(heap_[pos], heap_[(pos - 1) / 2]))
+            siftUp(pos);
+        else
+            siftDown(pos);
+    }
+
+    void erase(const NodePtr& node)
+    {
+        removeAt(node->heapIndex);
+    }
+
+    void clear() { heap_.clear(); }
+    size_t size() const { return heap_.size(); }
+    bool empty() const { return heap_.empty(); }
+
+private:
+    // 删除 pos 处的元素：用最后一个元素填补 再上浮或下沉
+    void removeAt(size_t pos)
+    {
+        size_t last = heap_.size() - 1;
+        if (pos != last)
+        {
+            heap_[pos] = std::move(heap_[last]);
+            heap_[pos]->heapIndex = pos;
+            heap_.pop_back();
+            update(heap_[pos]);
+        }
+        else
+        {
+            heap_.pop_back();
+        }
+    }
+
+    void siftUp(size_t pos)
+    {
+        NodePtr node = std::move(heap_[pos]);
+        while (pos > 0)
+        {
+            size_t parent = (pos - 1) / 2;
+            if (!less_(node, heap_[parent]))
+                break;
+            place(pos, std::move(heap_[parent]));
+            pos = parent;
+        }
+        place(pos, std::move(node));
+    }
+
+    void siftDown(size_t pos)
+    {
+        size_t n = heap_.size();
+        NodePtr node = std::move(heap_[pos]);
+        while (true)
+        {
+            size_t child = 2 * pos + 1;
+            if (child >= n)
+                break;
+            if (child + 1 < n && less_(heap_[child + 1], heap_[child]))
+                ++child;
+            if (!less_(heap_[child], node))
+                break;
+            place(pos, std::move(heap_[child]));
+            pos = child;
+        }
+        place(pos, std::move(node));
+    }
+
+    void place(size_t pos, NodePtr node)
+    {
+        node->heapIndex = pos;
+        heap_[pos] = std::move(node);
+    }
+
+private:
+    std::vector<NodePtr> heap_;
+    Less                 less_;
+};
+
+} // namespace KamaCache
@@ -9,6 +9,8 @@
 #include <climits>
 #include <algorithm>
 
+#include "KHashIndex.h"
+#include "KShardedCache.h"
 #include "KICachePolicy.h"
 
 namespace KamaCache
@@ -29,13 +31,18 @@ private:
         int freq; // 访问频次
         Key key;
         Value value;
+        size_t hash; // key 的哈希值 插入时计算一次 淘汰时直接用它删除索引
         std::weak_ptr<Node> pre; // 上一结点改为weak_ptr打破循环引用
         std::shared_ptr<Node> next;
 
         Node() 
-        : freq(1), next(nullptr) {}
-        Node(Key key, Value value) 
-        : freq(1), key(key), value(value), next(nullptr) {}
+        : freq(1), hash(0), next(nullptr) {}
+        Node(Key key, Value value, size_t hash) 
+        : freq(1), key(key), value(std::move(value)), hash(hash), next(nullptr) {}
+
+        // 供 KHashIndex 使用的访问器
+        const Key& getKey() const { return key; }
+        size_t getHash() const { return hash; }
     };
 
     using NodePtr = std::shared_ptr<Node>;
@@ -104,10 +111,10 @@ public:
     // 如果不加typename，编译器会将Node解释为一个静态成员或其他非类型实体，导致编译错误
     using Node = typename FreqList<Key, Value>::Node;
     using NodePtr = std::shared_ptr<Node>;
-    using NodeMap = std::unordered_map<Key, NodePtr>;
+    using NodeMap = KHashIndex<Key, NodePtr>;
     // 构造函数 定义缓存容量，最大访问频次，初始化最小访问频次、平均访问频次与当前访问所有缓存次数总和
     KLfuCache(int capacity, int maxAverageNum = 1000000)
-    : capacity_(capacity), minFreq_(INT8_MAX), maxAverageNum_(maxAverageNum),
+    : capacity_(capacity), minFreq_(INT_MAX), maxAverageNum_(maxAverageNum),
       curAverageNum_(0), curTotalNum_(0) 
     {}
     // 虚函数默认析构 从下至上
@@ -115,35 +122,50 @@ public:
     // 插入并更新
     void put(Key key, Value value) override
     {
-        // 缓存容量维护
-        if (capacity_ == 0)
-            return;
+        size_t hash = KHashOf(key);
+        put(key, std::move(value), hash);
+    }
+
+    // 使用调用方预先算好的哈希值(如分片缓存路由时已计算) 避免重复哈希
+    void put(const Key& key, Value value, size_t hash)
+    {
         // Map锁
         std::lock_guard<std::mutex> lock(mutex_);
         // 直接通过 key -> Node 的映射表完成O(1)查找
-        auto it = nodeMap_.find(key);
-        if (it != nodeMap_.end())
+        NodePtr* node = nodeMap_.find(key, hash);
+        if (node)
         {
             // 重置其value值
-            // 这句话的翻译是：it找到的是unordered_map<Key, NodePtr>
-            // 因此需要找到Node指针，即it -> second，最后更改指针中结构体包含的value变量
-            it->second->value = value;
-            // 找到了直接调整就好了，不用再去get中再找一遍，但其实影响不大
-            getInternal(it->second, value); // 这里查找一次 其实就是复用了其中的增加频次的晋升功能
+            // 这句话的翻译是：node找到的是索引中保存的Node指针
+            // 因此需要解引用得到Node指针，最后更改指针中结构体包含的value变量
+            (*node)->value = std::move(value);
+            // 找到了直接调整就好了，不用再去get中再找一遍 只做频次晋升 不再把值拷贝出来
+            touch(*node);
+            return;
+        }
+        // 缓存容量维护 容量可能被 setCapacity 改为 0 已有的 key 已在上面更新 新 key 不再写入 只回收超出的条目
+        if (capacity_ <= 0)
+        {
+            trimLocked(this->kTrimBatch);
             return;
         }
         // 否则触发放入函数
-        putInternal(key, value);
+        putInternal(key, std::move(value), hash);
     }
 
     // value值为传出参数
     bool get(Key key, Value& value) override
+    {
+      return get(key, value, KHashOf(key));
+    }
+
+    bool get(const Key& key, Value& value, size_t hash)
     {
       std::lock_guard<std::mutex> lock(mutex_);
-      auto it = nodeMap_.find(key);
-      if (it != nodeMap_.end())
+      NodePtr* node = nodeMap_.find(key, hash);
+      if (node)
       {
-          getInternal(it->second, value);
+          getInternal(*node, value);
           return true;
       }
 
@@ -157,6 +179,37 @@ public:
       return value;
     }
 
+    // 只更新已存在结点的值 不增加访问频次
+    bool updateIfPresent(Key key, Value value) override
+    {
+      size_t hash = KHashOf(key);
+      std::lock_guard<std::mutex> lock(mutex_);
+      NodePtr* node = nodeMap_.find(key, hash);
+      if (!node)
+          return false;
+      (*node)->value = std::move(value);
+      return true;
+    }
+
+    // 删除 key 不通知淘汰回调
+    void remove(Key key)
+    {
+      remove(key, KHashOf(key));
+    }
+
+    void remove(const Key& key, size_t hash)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      NodePtr* node = nodeMap_.find(key, hash);
+      if (!node)
+          return;
+      NodePtr target = *node;
+      // 最小频次链表可能因此变空 kickOut 会重新定位最小频次
+      removeFromFreqList(target);
+      nodeMap_.eraseNode(target);
+      decreaseFreqNum(target->freq);
+    }
+
     // 清空缓存,回收资源
     void purge()
     {
@@ -164,11 +217,25 @@ public:
       freqToFreqList_.clear();
     }
 
+    void setCapacity(size_t capacity) override
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      capacity_ = static_cast<int>(capacity);
+    }
+
+    size_t trim(size_t maxEvictions) override
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return trimLocked(maxEvictions);
+    }
+
 private:
-    void putInternal(Key key, Value value); // 添加缓存
+    void putInternal(Key key, Value value, size_t hash); // 添加缓存
     void getInternal(NodePtr node, Value& value); // 获取缓存
+    void touch(NodePtr node); // 一次访问：频次晋升
 
     void kickOut(); // 移除缓存中的过期数据
+    size_t trimLocked(size_t maxEvictions); // 分批淘汰超出容量的结点
 
     void removeFromFreqList(NodePtr node); // 从频率列表中移除节点
     void addToFreqList(NodePtr node); // 添加到频率列表
@@ -192,9 +259,15 @@ private:
 template<typename Key, typename Value>
 void KLfuCache<Key, Value>::getInternal(NodePtr node, Value& value)
 {
-    // 找到之后需要将其从低访问频次的链表中删除，并且添加到+1的访问频次链表中，
     // 获得目标数值
     value = node->value;
+    touch(node);
+}
+
+template<typename Key, typename Value>
+void KLfuCache<Key, Value>::touch(NodePtr node)
+{
+    // 将节点从低访问频次的链表中删除，并且添加到+1的访问频次链表中
     // 从原有访问频次的链表中删除节点
     removeFromFreqList(node); 
     // 提升其频次
@@ -211,18 +284,20 @@ void KLfuCache<Key, Value>::getInternal(NodePtr node, Value& value)
 }
 
 template<typename Key, typename Value>
-void KLfuCache<Key, Value>::putInternal(Key key, Value value)
+void KLfuCache<Key, Value>::putInternal(Key key, Value value, size_t hash)
 {   
+    // 缩容后超出容量的部分 每次写入最多多淘汰 kTrimBatch 个
+    trimLocked(this->kTrimBatch);
     // 如果不在缓存中，则需要判断缓存是否已满
-    if (nodeMap_.size() == capacity_)
+    if (nodeMap_.size() >= static_cast<size_t>(capacity_))
     {
         // 缓存已满，删除最少最不常访问的结点，更新当前平均访问频次和总访问频次
         kickOut();
     }
     
     // 创建新结点，将新结点添加进入，更新最小访问频次
-    NodePtr node = std::make_shared<Node>(key, value); // 初始化一个新的节点 其节点的频次为1
-    nodeMap_[key] = node;
+    NodePtr node = std::make_shared<Node>(key, std::move(value), hash); // 初始化一个新的节点 其节点的频次为1
+    nodeMap_.insert(hash, node);
     addToFreqList(node); // 添加到频次链表
     addFreqNum();        // 增加访问频次
     minFreq_ = std::min(minFreq_, 1); // 由于是加入新节点 因此一定是仅有1次访问，因此更新最小访问频次
@@ -231,11 +306,25 @@ void KLfuCache<Key, Value>::putInternal(Key key, Value value)
 template<typename Key, typename Value>
 void KLfuCache<Key, Value>::kickOut()
 {
+    // 连续淘汰(缩容回收)会清空最小频次链表 此时重新定位最小频次
+    auto it = freqToFreqList_.find(minFreq_);
+    if (it == freqToFreqList_.end() || it->second->isEmpty())
+        updateMinFreq();
     // 由于一直维护最小访问频次 因此可以O(1)的直接找到节点 直接删除头结点：即最小访问频次下的最久未访问节点
     NodePtr node = freqToFreqList_[minFreq_]->getFirstNode();
     removeFromFreqList(node);
-    nodeMap_.erase(node->key);
+    nodeMap_.eraseNode(node); // 按节点保存的哈希删除 不再对 key 重新求哈希
     decreaseFreqNum(node->freq);
+    this->onEvict(node->key, node->value); // 通知淘汰回调(如二级缓存)
+}
+
+template<typename Key, typename Value>
+size_t KLfuCache<Key, Value>::trimLocked(size_t maxEvictions)
+{
+    size_t capacity = capacity_ > 0 ? static_cast<size_t>(capacity_) : 0;
+    while (maxEvictions-- > 0 && nodeMap_.size() > capacity)
+        kickOut();
+    return nodeMap_.size() > capacity ? nodeMap_.size() - capacity : 0;
 }
 
 template<typename Key, typename Value>
@@ -303,14 +392,8 @@ void KLfuCache<Key, Value>::handleOverMaxAverageNum()
         return;
 
     // 当前平均访问频次已经超过了最大平均访问频次，所有结点的访问频次- (maxAverageNum_ / 2)
-    for (auto it = nodeMap_.begin(); it != nodeMap_.end(); ++it) // 对访问哈希表的所有节点进行频率衰减 即全员降级
+    nodeMap_.forEach([this](const NodePtr& node) // 对访问哈希表的所有节点进行频率衰减 即全员降级
     {
-        // 检查结点是否为空
-        if (!it->second)
-            continue;
-
-        NodePtr node = it->second;
-
         // 先从当前频率列表中移除
         removeFromFreqList(node);
 
@@ -320,7 +403,7 @@ void KLfuCache<Key, Value>::handleOverMaxAverageNum()
 
         // 添加到新的频率列表
         addToFreqList(node);
-    }
+    });
 
     // 更新最小频率
     updateMinFreq();
@@ -333,8 +416,8 @@ template<typename Key, typename Value>
  */
 void KLfuCache<Key, Value>::updateMinFreq() 
 {
-    // 初始化为一个不可能达到的大数
-    minFreq_ = INT8_MAX;
+    // 初始化为一个不可能达到的大数 频次是 int 不能用 INT8_MAX：频次都超过 127 时它会被当成最小频次
+    minFreq_ = INT_MAX;
     for (const auto& pair : freqToFreqList_) 
     {
         if (pair.second && !pair.second->isEmpty()) 
@@ -344,13 +427,14 @@ void KLfuCache<Key, Value>::updateMinFreq()
     }
     // 仅在for()逻辑一次也未执行时达到，即缓存为空
     // 在这种情况下，将其重置为 1 是最安全的选择。因为下一个插入的新节点频率必然是 1。这样可以保证系统状态的连贯性。
-    if (minFreq_ == INT8_MAX) 
+    if (minFreq_ == INT_MAX) 
         minFreq_ = 1;
 }
 
 // 并没有牺牲空间换时间，他是把原有缓存大小进行了分片。
+// 分片逻辑(容量均分、哈希路由、哈希值下传)由 KShardedCache 统一实现
 template<typename Key, typename Value>
-class KHashLfuCache
+class KHashLfuCache : public KShardedCache<Key, Value, KLfuCache<Key, Value>>
 {
 public:
     /**
@@ -361,62 +445,14 @@ public:
      * @param maxAverageNum 每个分片的最大平均访问频次 用于全员降级与上限保护
      */
     KHashLfuCache(size_t capacity, int sliceNum, int maxAverageNum = 10)
-        : sliceNum_(sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency())
-        , capacity_(capacity)
-    {
-        // 计算每个lfu分片的容量 向上取整
-        size_t sliceSize = std::ceil(capacity_ / static_cast<double>(sliceNum_));
-        // 初始化分片内容 并加入数组
-        for (int i = 0; i < sliceNum_; ++i)
-        {
-            lfuSliceCaches_.emplace_back(new KLfuCache<Key, Value>(sliceSize, maxAverageNum));
-        }
-    }
-    // 定义为KHashLfuCache的接口，而不是继承，在调用的同时再触发对应分片的put函数，让该分片自动管理内存。
-    // 调用对应分片的put函数
-    void put(Key key, Value value)
-    {
-        // 根据key找出对应的lfu分片
-        size_t sliceIndex = Hash(key) % sliceNum_;
-        lfuSliceCaches_[sliceIndex]->put(key, value);
-    }
-    // 调用对应分片的get函数
-    bool get(Key key, Value& value)
-    {
-        // 根据key找出对应的lfu分片
-        size_t sliceIndex = Hash(key) % sliceNum_;
-        return lfuSliceCaches_[sliceIndex]->get(key, value);
-    }
-
-    Value get(Key key)
-    {
-        Value value;
-        get(key, value);
-        return value;
-    }
+        : KShardedCache<Key, Value, KLfuCache<Key, Value>>(capacity, sliceNum, maxAverageNum)
+    {}
 
     // 清除缓存
     void purge()
     {
-        for (auto& lfuSliceCache : lfuSliceCaches_)
-        {
-            lfuSliceCache->purge();
-        }
-    }
-
-private:
-    // 将key计算成对应哈希值
-    size_t Hash(Key key)
-    {
-        std::hash<Key> hashFunc;
-        return hashFunc(key);
+        this->forEachSlice([](KLfuCache<Key, Value>& lfuSliceCache) { lfuSliceCache.purge(); });
     }
-
-private:
-    size_t capacity_; // 缓存总容量
-    int sliceNum_; // 缓存分片数量
-    std::vector<std::unique_ptr<KLfuCache<Key, Value>>> lfuSliceCaches_; // 缓存lfu分片容器
 };
 
-} // namespace KamaCache
-
+} // namespace KamaCache
\ No newline at end of file
@@ -0,0 +1,403 @@
+#pragma once
+
+#include <algorithm>
+#include <list>
+#include <memory>
+#include <mutex>
+
+#include "KHashIndex.h"
+#include "KICachePolicy.h"
+#include "KShardedCache.h"
+
+namespace KamaCache
+{
+
+template<typename Key, typename Value> class KLirsCache;
+
+/**
+ * @brief LIRS 缓存节点
+ * 同一个节点可能同时位于栈 S 与队列 Q 中，非驻留节点还位于非驻留队列中，各自保存迭代器以便 O(1) 摘除。
+ */
+template<typename Key, typename Value>
+class LirsNode
+{
+private:
+    enum class State { Lir, HirResident, HirNonResident };
+    using ListIter = typename std::list<std::shared_ptr<LirsNode>>::iterator;
+
+    Key      key_;
+    Value    value_;
+    size_t   hash_;       // key 的哈希值 淘汰与剪枝时用于删除索引
+    State    state_;
+    bool     inStack_;    // 是否在栈 S 中
+    bool     inQueue_;    // 是否在驻留 HIR 队列 Q 中
+    ListIter stackPos_;
+    ListIter queuePos_;
+    ListIter ghostPos_;   // 在非驻留队列中的位置 仅非驻留节点有效
+
+public:
+    LirsNode(Key key, Value value, size_t hash)
+        : key_(key)
+        , value_(value)
+        , hash_(hash)
+        , state_(State::HirResident)
+        , inStack_(false)
+        , inQueue_(false)
+    {}
+
+    const Key& getKey() const { return key_; }
+    size_t getHash() const { return hash_; }
+    Value getValue() const { return value_; }
+    void setValue(const Value& value) { value_ = value; }
+
+    friend class KLirsCache<Key, Value>;
+};
+
+/**
+ * @brief LIRS (Low Inter-reference Recency Set) 淘汰策略
+ *
+ * 核心设计：
+ * 1. 用"两次访问之间访问过的不同 key 数"(IRR) 衡量热度，而不是最近一次访问时间。
+ *    IRR 小的 key 为 LIR，占据绝大部分容量且不会被淘汰；其余驻留的 key 为 HIR，只占约 1% 的容量。
+ * 2. 栈 S 按最近访问排序，保存 LIR、驻留 HIR 以及非驻留 HIR(只有元数据)；栈底总是 LIR(剪枝保证)。
+ *    队列 Q 保存驻留 HIR，淘汰总是发生在 Q 的头部。
+ * 3. HIR 在栈 S 中再次被访问，说明其 IRR 小于栈底 LIR 的最近访问距离，于是晋升为 LIR，栈底 LIR 降级为 HIR。
+ * 4. 循环与扫描访问中的 key 只会作为 HIR 在 Q 中短暂停留，不会冲刷 LIR 集合。
+ * 5. 非驻留 HIR 的数量受 ghostRatio * capacity 限制，超出时按变为非驻留的先后顺序丢弃，内存有界。
+ * 6. 每个节点最多被剪枝出栈一次，剪枝的均摊代价为 O(1)。
+ */
+template<typename Key, typename Value>
+class KLirsCache : public KICachePolicy<Key, Value>
+{
+public:
+    using NodeType = LirsNode<Key, Value>;
+    using NodePtr = std::shared_ptr<NodeType>;
+    using NodeList = std::list<NodePtr>;
+    using NodeMap = KHashIndex<Key, NodePtr>;
+    using State = typename NodeType::State;
+
+    /**
+     * @brief 构造函数
+     *
+     * @param capacity 缓存容量(驻留条目数)
+     * @param hirRatio 驻留 HIR 占容量的比例
+     * @param ghostRatio 非驻留 HIR 元数据的上限 相对于容量的比例
+     */
+    explicit KLirsCache(int capacity, double hirRatio = 0.01, double ghostRatio = 1.0)
+        : capacity_(capacity > 0 ? static_cast<size_t>(capacity) : 0)
+        , hirRatio_(hirRatio)
+        , ghostRatio_(ghostRatio)
+        , lirCount_(0)
+        , residentCount_(0)
+    {
+        updateCapacities();
+    }
+
+    ~KLirsCache() override = default;
+
+    void put(Key key, Value value) override
+    {
+        put(key, value, KHashOf(key));
+    }
+
+    // 使用调用方预先算好的哈希值 要求 hash == KHashOf(key)
+    void put(const Key& key, const Value& value, size_t hash)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        NodePtr* found = nodeMap_.find(key, hash);
+        if (found && (*found)->state_ != State::HirNonResident)
+        {
+            // 访问过程中的剪枝会修改索引 先复制节点指针
+            NodePtr node = *found;
+            node->setValue(value);
+            access(node);
+            return;
+        }
+
+        if (capacity_ == 0)
+        {
+            trimLocked(this->kTrimBatch);
+            return;
+        }
+        // 淘汰会修改索引 先取出非驻留节点
+        NodePtr ghost = found ? *found : nullptr;
+        trimLocked(this->kTrimBatch);
+        if (residentCount_ >= capacity_)
+            evict();
+
+        if (ghost && ghost->inStack_)
+        {
+            // 非驻留 HIR 仍在栈中：本次访问距上次的 IRR 小于栈底 LIR 的最近访问距离 晋升为 LIR
+            ghosts_.erase(ghost->ghostPos_);
+            ghost->setValue(value);
+            ++residentCount_;
+            moveToStackTop(ghost);
+            makeLir(ghost);
+            limitGhosts();
+            return;
+        }
+
+        NodePtr node = std::make_shared<NodeType>(key, value, hash);
+        nodeMap_.insert(hash, node);
+        ++residentCount_;
+        pushStackTop(node);
+        if (lirCount_ < lirCapacity_)
+        {
+            // 预热阶段 LIR 集合未满 新 key 直接成为 LIR
+            node->state_ = State::Lir;
+            ++lirCount_;
+        }
+        else
+        {
+            node->state_ = State::HirResident;
+            pushQueueBack(node);
+        }
+        limitGhosts();
+    }
+
+    bool get(Key key, Value& value) override
+    {
+        return get(key, value, KHashOf(key));
+    }
+
+    bool get(const Key& key, Value& value, size_t hash)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        NodePtr* found = nodeMap_.find(key, hash);
+        if (!found || (*found)->state_ == State::HirNonResident)
+            return false;
+        NodePtr node = *found;
+        access(node);
+        value = node->getValue();
+        return true;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 只更新驻留节点的值 不算作一次访问 栈与队列都不变
+    bool updateIfPresent(Key key, Value value) override
+    {
+        size_t hash = KHashOf(key);
+        std::lock_guard<std::mutex> lock(mutex_);
+        NodePtr* found = nodeMap_.find(key, hash);
+        if (!found || (*found)->state_ == State::HirNonResident)
+            return false;
+        (*found)->setValue(value);
+        return true;
+    }
+
+    // LIR 与非驻留 HIR 的上限按构造时的比例重新计算 缩容后多出的 LIR 同样分批降级
+    void setCapacity(size_t capacity) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capacity_ = capacity;
+        updateCapacities();
+    }
+
+    size_t trim(size_t maxEvictions) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return trimLocked(maxEvictions);
+    }
+
+private:
+    void updateCapacities()
+    {
+        lirCapacity_ = capacity_ > 1 ? capacity_ - std::max<size_t>(1, static_cast<size_t>(capacity_ * hirRatio_)) : capacity_;
+        if (lirCapacity_ == 0)
+            lirCapacity_ = 1;
+        ghostCapacity_ = static_cast<size_t>(capacity_ * ghostRatio_);
+    }
+
+    // 先把多出的 LIR 降级为驻留 HIR 再淘汰驻留条目 返回值包含尚未降级的 LIR
+    size_t trimLocked(size_t maxEvictions)
+    {
+        while (maxEvictions > 0 && lirCount_ > lirCapacity_)
+        {
+            demoteBottom();
+            --maxEvictions;
+        }
+        while (maxEvictions > 0 && residentCount_ > capacity_)
+        {
+            evict();
+            --maxEvictions;
+        }
+        size_t excess = residentCount_ > capacity_ ? residentCount_ - capacity_ : 0;
+        return excess + (lirCount_ > lirCapacity_ ? lirCount_ - lirCapacity_ : 0);
+    }
+
+    // 驻留节点被访问
+    void access(const NodePtr& node)
+    {
+        if (node->state_ == State::Lir)
+        {
+            bool wasBottom = node->stackPos_ == std::prev(stack_.end());
+            moveToStackTop(node);
+            if (wasBottom)
+                pruneStack();
+        }
+        else if (node->inStack_)
+        {
+            // 驻留 HIR 在栈中被访问 晋升为 LIR
+            removeFromQueue(node);
+            moveToStackTop(node);
+            makeLir(node);
+        }
+        else
+        {
+            // 驻留 HIR 不在栈中 IRR 仍然较大 保持 HIR 只刷新位置
+            pushStackTop(node);
+            removeFromQueue(node);
+            pushQueueBack(node);
+        }
+    }
+
+    // 节点已位于栈顶 设为 LIR 超出 LIR 容量时把栈底 LIR 降级为驻留 HIR
+    void makeLir(const NodePtr& node)
+    {
+        node->state_ = State::Lir;
+        ++lirCount_;
+        // 缩容后多出的 LIR 由 trimLocked 分批降级 这里只抵消本次新增的一个
+        if (lirCount_ > lirCapacity_)
+            demoteBottom();
+    }
+
+    // 栈底 LIR 降级为驻留 HIR
+    void demoteBottom()
+    {
+        NodePtr bottom = stack_.back();
+        popStackBottom();
+        bottom->state_ = State::HirResident;
+        --lirCount_;
+        pushQueueBack(bottom);
+        pruneStack();
+    }
+
+    // 淘汰一个驻留条目：优先淘汰 Q 头部的 HIR
+    void evict()
+    {
+        if (queue_.empty())
+        {
+            // 只有容量极小时 Q 才可能为空 此时淘汰栈底的 LIR
+            NodePtr bottom = stack_.back();
+            popStackBottom();
+            --lirCount_;
+            --residentCount_;
+            nodeMap_.eraseNode(bottom);
+            this->onEvict(bottom->getKey(), bottom->getValue());
+            pruneStack();
+            return;
+        }
+
+        NodePtr victim = queue_.front();
+        removeFromQueue(victim);
+        --residentCount_;
+        this->onEvict(victim->getKey(), victim->getValue());
+        if (victim->inStack_)
+        {
+            // 仍在栈中 保留元数据作为非驻留 HIR 释放数据
+            victim->state_ = State::HirNonResident;
+            victim->setValue(Value{});
+            victim->ghostPos_ = ghosts_.insert(ghosts_.end(), victim);
+        }
+        else
+        {
+            nodeMap_.eraseNode(victim);
+        }
+    }
+
+    // 剪枝：弹出栈底所有 HIR 使栈底重新成为 LIR
+    void pruneStack()
+    {
+        while (!stack_.empty() && stack_.back()->state_ != State::Lir)
+        {
+            NodePtr bottom = stack_.back();
+            popStackBottom();
+            if (bottom->state_ == State::HirNonResident)
+            {
+                ghosts_.erase(bottom->ghostPos_);
+                nodeMap_.eraseNode(bottom);
+            }
+        }
+    }
+
+    // 非驻留 HIR 超出上限时 丢弃最早变为非驻留的元数据 缩容后每次最多丢弃 kTrimBatch + 1 个
+    void limitGhosts()
+    {
+        for (size_t n = 0; n <= this->kTrimBatch && ghosts_.size() > ghostCapacity_; ++n)
+        {
+            NodePtr ghost = ghosts_.front();
+            ghosts_.pop_front();
+            if (ghost->inStack_)
+            {
+                stack_.erase(ghost->stackPos_);
+                ghost->inStack_ = false;
+            }
+            nodeMap_.eraseNode(ghost);
+        }
+        // 丢弃的节点可能恰好位于栈底
+        pruneStack();
+    }
+
+    // 栈 S：链表头为栈顶(最近访问) 链表尾为栈底
+    void pushStackTop(const NodePtr& node)
+    {
+        node->stackPos_ = stack_.insert(stack_.begin(), node);
+        node->inStack_ = true;
+    }
+
+    void moveToStackTop(const NodePtr& node)
+    {
+        if (node->inStack_)
+            stack_.splice(stack_.begin(), stack_, node->stackPos_);
+        else
+            pushStackTop(node);
+    }
+
+    void popStackBottom()
+    {
+        stack_.back()->inStack_ = false;
+        stack_.pop_back();
+    }
+
+    // 队列 Q：链表头最先被淘汰
+    void pushQueueBack(const NodePtr& node)
+    {
+        node->queuePos_ = queue_.insert(queue_.end(), node);
+        node->inQueue_ = true;
+    }
+
+    void removeFromQueue(const NodePtr& node)
+    {
+        if (node->inQueue_)
+        {
+            queue_.erase(node->queuePos_);
+            node->inQueue_ = false;
+        }
+    }
+
+private:
+    size_t     capacity_;      // 驻留条目的最大数量
+    double     hirRatio_;      // 驻留 HIR 占容量的比例
+    double     ghostRatio_;    // 非驻留 HIR 上限相对于容量的比例
+    size_t     lirCapacity_;   // LIR 集合的容量
+    size_t     ghostCapacity_; // 非驻留 HIR 的最大数量
+    size_t     lirCount_;      // 当前 LIR 数量
+    size_t     residentCount_; // 当前驻留条目数量
+    NodeList   stack_;         // 栈 S
+    NodeList   queue_;         // 驻留 HIR 队列 Q
+    NodeList   ghosts_;        // 非驻留 HIR 按变为非驻留的先后排列
+    NodeMap    nodeMap_;       // key -> 节点 的索引 包含非驻留节点
+    std::mutex mutex_;         // 互斥锁，保证线程安全
+};
+
+// LIRS 的分片版本
+template<typename Key, typename Value>
+using KHashLirsCache = KShardedCache<Key, Value, KLirsCache<Key, Value>>;
+
+} // namespace KamaCache
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace KamaCache
+{
+
+/**
+ * @brief 支持删除的布谷鸟过滤器 (cuckoo filter)
+ *
+ * 核心设计：
+ * 1. 每个桶 4 个槽位，每个槽位只保存 16 位指纹，负载率 95% 时每个元素约 2.1 字节。
+ *    一次查询比较两个桶共 8 个指纹，误判率上限约 8 / 2^16 ≈ 0.012%。
+ * 2. 元素可以放在两个候选桶之一：i2 = i1 ^ hash(指纹)，只凭指纹和当前桶就能算出另一个桶，
+ *    因此冲突时可以把已有指纹踢到它的另一个桶，不需要原始 key。
+ * 3. 与布隆过滤器不同，可以按指纹删除元素，用于 key 被重新创建后立即撤销"不存在"的记录。
+ *    删除只可能误删另一个指纹相同的 key 的记录，代价是它多一次回源，不会返回错误结果。
+ */
+class KCuckooFilter
+{
+private:
+    static constexpr size_t kSlots = 4;     // 每个桶的槽位数
+    static constexpr int    kMaxKicks = 500; // 插入时最多踢出的次数
+
+public:
+    explicit KCuckooFilter(size_t capacity)
+        : size_(0)
+        , victimIndex_(0)
+        , victimFp_(0)
+        , rng_(0x2545F4914F6CDD1Dull)
+    {
+        size_t buckets = 1;
+        // 目标负载率不超过 0.9
+        while (buckets * kSlots * 9 < (capacity > 0 ? capacity : 1) * 10)
+            buckets <<= 1;
+        buckets_.assign(buckets * kSlots, 0);
+        mask_ = buckets - 1;
+    }
+
+    /**
+     * @brief 插入 hash 对应的指纹
+     *
+     * @return false 过滤器已满(踢出次数用尽) 此时最后一个被踢出的指纹暂存在备用位中，
+     *         调用方应当清空或轮换过滤器
+     */
+    bool insert(uint64_t hash)
+    {
+        if (victimFp_ != 0)
+            return false;
+        uint16_t fp = fingerprint(hash);
+        size_t i1 = indexOf(hash);
+        size_t i2 = altIndex(i1, fp);
+        if (insertInto(i1, fp) || insertInto(i2, fp))
+        {
+            ++size_;
+            return true;
+        }
+
+        // 两个桶都满了 随机踢出一个指纹到它的另一个桶
+        size_t index = (nextRandom() & 1) ? i1 : i2;
+        for (int kick = 0; kick < kMaxKicks; ++kick)
+        {
+            size_t slot = nextRandom() % kSlots;
+            uint16_t& entry = buckets_[index * kSlots + slot];
+            uint16_t kicked = entry;
+            entry = fp;
+            fp = kicked;
+            index = altIndex(index, fp);
+            if (insertInto(index, fp))
+            {
+                ++size_;
+                return true;
+            }
+        }
+        victimIndex_ = index;
+        victimFp_ = fp;
+        ++size_;
+        return false;
+    }
+
+    bool contains(uint64_t hash) const
+    {
+        uint16_t fp = fingerprint(hash);
+        size_t i1 = indexOf(hash);
+        size_t i2 = altIndex(i1, fp);
+        if (victimFp_ == fp && (victimIndex_ == i1 || victimIndex_ == i2))
+            return true;
+        return bucketHas(i1, fp) || bucketHas(i2, fp);
+    }
+
+    bool erase(uint64_t hash)
+    {
+        uint16_t fp = fingerprint(hash);
+        size_t i1 = indexOf(hash);
+        size_t i2 = altIndex(i1, fp);
+        if (eraseFrom(i1, fp) || eraseFrom(i2, fp))
+        {
+            --size_;
+            // 腾出了位置 尝试放回备用位中的指纹
+            if (victimFp_ != 0)
+            {
+                uint16_t victim = victimFp_;
+                victimFp_ = 0;
+                if (!insertInto(victimIndex_, victim) && !insertInto(altIndex(victimIndex_, victim), victim))
+                    victimFp_ = victim;
+            }
+            return true;
+        }
+        if (victimFp_ == fp && (victimIndex_ == i1 || victimIndex_ == i2))
+        {
+            victimFp_ = 0;
+            --size_;
+            return true;
+        }
+        return false;
+    }
+
+    void clear()
+    {
+        std::fill(buckets_.begin(), buckets_.end(), 0);
+        size_ = 0;
+        victimFp_ = 0;
+    }
+
+    size_t size() const { return size_; }
+    size_t bytes() const { return buckets_.size() * sizeof(uint16_t); }
+
+private:
+    static uint64_t mix(uint64_t h)
+    {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    // 指纹取打散后哈希的高 16 位 0 表示空槽 所以映射为 1
+    static uint16_t fingerprint(uint64_t hash)
+    {
+        uint16_t fp = static_cast<uint16_t>(mix(hash) >> 48);
+        return fp != 0 ? fp : 1;
+    }
+
+    size_t indexOf(uint64_t hash) const
+    {
+        return static_cast<size_t>(mix(hash)) & mask_;
+    }
+
+    size_t altIndex(size_t index, uint16_t fp) const
+    {
+        return (index ^ static_cast<size_t>(fp * 0x5bd1e995u)) & mask_;
+    }
+
+    bool insertInto(size_t index, uint16_t fp)
+    {
+        for (size_t slot = 0; slot < kSlots; ++slot)
+        {
+            uint16_t& entry = buckets_[index * kSlots + slot];
+            if (entry == 0)
+            {
+                entry = fp;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool bucketHas(size_t index, uint16_t fp) const
+    {
+        const uint16_t* bucket = &buckets_[index * kSlots];
+        return bucket[0] == fp || bucket[1] == fp || bucket[2] == fp || bucket[3] == fp;
+    }
+
+    bool eraseFrom(size_t index, uint16_t fp)
+    {
+        for (size_t slot = 0; slot < kSlots; ++slot)
+        {
+            uint16_t& entry = buckets_[index * kSlots + slot];
+            if (entry == fp)
+            {
+                entry = 0;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint64_t nextRandom()
+    {
+        // xorshift 只用于选择踢出位置
+        rng_ ^= rng_ << 13;
+        rng_ ^= rng_ >> 7;
+        rng_ ^= rng_ << 17;
+        return rng_;
+    }
+
+private:
+    std::vector<uint16_t> buckets_;     // 桶数组 每个桶 kSlots 个指纹
+    size_t                mask_;        // 桶数 - 1 桶数为 2 的幂
+    size_t                size_;        // 已插入的指纹数
+    size_t                victimIndex_; // 插入失败时暂存的指纹所在桶
+    uint16_t              victimFp_;    // 插入失败时暂存的指纹 0 表示没有
+    uint64_t              rng_;
+};
+
+} // namespace KamaCache
@@ -0,0 +1,240 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "../KHashIndex.h"
+#include "KCuckooFilter.h"
+
+namespace KamaCache
+{
+
+// 负缓存(不存在的 key)配置
+struct KNegativeCacheOptions
+{
+    size_t                    capacity = 100000;                  // 记录不存在的 key 的总数上限 0 表示关闭负缓存
+    int                       shards = 8;                         // 过滤器分片数 每个分片一把锁
+    std::chrono::milliseconds ttl = std::chrono::milliseconds(30000); // "不存在"记录的最长有效期
+};
+
+// 加载缓存的统计
+struct KLoadingStats
+{
+    uint64_t hits = 0;         // 正缓存命中
+    uint64_t negativeHits = 0; // 负缓存命中 直接返回不存在 没有回源
+    uint64_t loads = 0;        // 回源次数
+    uint64_t absentLoads = 0;  // 回源后确认不存在的次数
+};
+
+/**
+ * @brief 带回源加载与负缓存的缓存
+ *
+ * get 的流程：正缓存命中 -> 负缓存命中(已确认不存在，直接返回 false) -> 调用 loader 回源。
+ * 回源找到数据则写入正缓存；确认不存在则只在负缓存中记录 key 的 16 位指纹，每个 key 约几个字节，
+ * 不需要为"不存在"分配节点和 Value。
+ *
+ * 负缓存按 key 的哈希分成若干分片，每个分片由两代布谷鸟过滤器组成：
+ * 新记录写入当前代，查询同时检查两代；当前代存在超过 ttl / 2 或写满时轮换，旧一代整体丢弃，
+ * 因此一条"不存在"记录最多存活 ttl。put / invalidate 会立即从过滤器中删除对应指纹，
+ * 并递增分片的代号；回源前读取代号，回源确认不存在后只有代号未变才记录，
+ * 回源期间被 put / invalidate 的 key 不会在之后被补记为不存在，key 被创建后不会继续被当成不存在。
+ * 指纹过滤器存在误判：每代查询比较 8 个 16 位指纹，两代合计误判率约 2 * 8 / 2^16 ≈ 0.024%，
+ * 误判会让一个存在的 key 在记录过期前被当成不存在，不能容忍时关闭负缓存(capacity = 0)。
+ *
+ * Cache 可以是任意提供 put(key, value) / get(key, value) 的缓存，包括各个策略与分片缓存。
+ */
+template<typename Key, typename Value, typename Cache>
+class KLoadingCache
+{
+public:
+    // 回源函数：找到时写入 value 并返回 true；后端不存在该 key 时返回 false
+    using Loader = std::function<bool(const Key&, Value&)>;
+    using Clock = std::chrono::steady_clock;
+
+private:
+    struct NegativeShard
+    {
+        NegativeShard(size_t capacity)
+            : current(capacity)
+            , previous(capacity)
+            , rotatedAt(Clock::now())
+        {}
+
+        KCuckooFilter     current;   // 当前代
+        KCuckooFilter     previous;  // 上一代
+        Clock::time_point rotatedAt; // 当前代开始的时间
+        uint64_t          generation = 0; // forgetAbsent 每次递增 回源期间变化则不记录"不存在"
+        std::mutex        mutex;
+    };
+
+public:
+    KLoadingCache(std::unique_ptr<Cache> cache, Loader loader,
+                  const KNegativeCacheOptions& options = KNegativeCacheOptions())
+        : cache_(std::move(cache))
+        , loader_(std::move(loader))
+        , options_(options)
+        , hits_(0)
+        , negativeHits_(0)
+        , loads_(0)
+        , absentLoads_(0)
+    {
+        if (options_.capacity > 0)
+        {
+            int shards = options_.shards > 0 ? options_.shards : 1;
+            // 每个分片两代 每一代容纳分片配额的全部记录
+            size_t perShard = (options_.capacity + shards - 1) / shards;
+            for (int i = 0; i < shards; ++i)
+                negative_.emplace_back(new NegativeShard(perShard));
+        }
+    }
+
+    /**
+     * @brief 读取 必要时回源
+     *
+     * @return false 后端不存在该 key(可能来自负缓存)
+     */
+    bool get(const Key& key, Value& value)
+    {
+        if (cache_->get(key, value))
+        {
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        size_t hash = KHashOf(key);
+        uint64_t generation = 0;
+        if (knownAbsent(hash, generation))
+        {
+            negativeHits_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        loads_.fetch_add(1, std::memory_order_relaxed);
+        if (loader_(key, value))
+        {
+            cache_->put(key, value);
+            return true;
+        }
+        absentLoads_.fetch_add(1, std::memory_order_relaxed);
+        rememberAbsent(hash, generation);
+        return false;
+    }
+
+    // 写入(例如 key 在后端被创建) 同时撤销它的"不存在"记录
+    void put(const Key& key, const Value& value)
+    {
+        forgetAbsent(KHashOf(key));
+        cache_->put(key, value);
+    }
+
+    // 后端创建了 key 但暂不写入缓存时调用 只撤销"不存在"记录
+    void invalidate(const Key& key)
+    {
+        forgetAbsent(KHashOf(key));
+    }
+
+    KLoadingStats stats() const
+    {
+        KLoadingStats result;
+        result.hits = hits_.load(std::memory_order_relaxed);
+        result.negativeHits = negativeHits_.load(std::memory_order_relaxed);
+        result.loads = loads_.load(std::memory_order_relaxed);
+        result.absentLoads = absentLoads_.load(std::memory_order_relaxed);
+        return result;
+    }
+
+    // 负缓存占用的内存
+    size_t negativeBytes() const
+    {
+        size_t bytes = 0;
+        for (const auto& shard : negative_)
+            bytes += shard->current.bytes() + shard->previous.bytes();
+        return bytes;
+    }
+
+    Cache& cache() { return *cache_; }
+
+private:
+    // 与正缓存的分片路由(hash % sliceNum)使用不同的哈希位
+    NegativeShard& shardOf(size_t hash)
+    {
+        return *negative_[(static_cast<uint64_t>(hash) >> 32 ^ hash) % negative_.size()];
+    }
+
+    // 当前代存在超过 ttl / 2 时轮换 记录的存活时间在 [ttl / 2, ttl] 之间 持有分片锁
+    void maybeRotate(NegativeShard& shard, Clock::time_point now)
+    {
+        if (now - shard.rotatedAt >= options_.ttl / 2)
+            rotate(shard, now);
+    }
+
+    void rotate(NegativeShard& shard, Clock::time_point now)
+    {
+        std::swap(shard.current, shard.previous);
+        shard.current.clear();
+        shard.rotatedAt = now;
+    }
+
+    // 同时取出分片的代号 供回源后的 rememberAbsent 判断期间是否有 put / invalidate
+    bool knownAbsent(size_t hash, uint64_t& generation)
+    {
+        if (negative_.empty())
+            return false;
+        NegativeShard& shard = shardOf(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        generation = shard.generation;
+        maybeRotate(shard, Clock::now());
+        return shard.current.contains(hash) || shard.previous.contains(hash);
+    }
+
+    void rememberAbsent(size_t hash, uint64_t generation)
+    {
+        if (negative_.empty())
+            return;
+        NegativeShard& shard = shardOf(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        // 回源期间有过 put / invalidate(可能就是这个 key 被创建) 回源结果已经过时
+        if (shard.generation != generation)
+            return;
+        Clock::time_point now = Clock::now();
+        maybeRotate(shard, now);
+        // 并发回源可能同时确认同一个 key 不存在 不重复记录
+        if (shard.current.contains(hash))
+            return;
+        if (!shard.current.insert(hash))
+        {
+            // 当前代写满 提前轮换后重新写入
+            rotate(shard, now);
+            shard.current.insert(hash);
+        }
+    }
+
+    void forgetAbsent(size_t hash)
+    {
+        if (negative_.empty())
+            return;
+        NegativeShard& shard = shardOf(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        ++shard.generation;
+        // 两代中各自可能留有一份记录 全部删除
+        while (shard.current.erase(hash)) {}
+        while (shard.previous.erase(hash)) {}
+    }
+
+private:
+    std::unique_ptr<Cache>                      cache_;        // 正缓存
+    Loader                                      loader_;       // 回源函数
+    KNegativeCacheOptions                       options_;
+    std::vector<std::unique_ptr<NegativeShard>> negative_;     // 负缓存分片 为空表示关闭
+    std::atomic<uint64_t>                       hits_;
+    std::atomic<uint64_t>                       negativeHits_;
+    std::atomic<uint64_t>                       loads_;
+    std::atomic<uint64_t>                       absentLoads_;
+};
+
+} // namespace KamaCache
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "KHashIndex.h"
+#include "KICachePolicy.h"
+#include "KIndexedHeap.h"
+#include "KShardedCache.h"
+
+namespace KamaCache
+{
+
+/**
+ * @brief LRFU 缓存节点 由索引持有 同时位于优先级堆中
+ */
+template<typename Key, typename Value>
+struct LrfuNode
+{
+    Key      key;
+    Value    value;
+    size_t   hash;
+    double   crf;       // 最近一次访问时刻的综合得分
+    uint64_t last;      // 最近一次访问的逻辑时间
+    double   priority;  // 堆中比较用的键 = log2(crf) + lambda * last
+    size_t   heapIndex; // 在堆中的下标
+
+    LrfuNode(const Key& k, const Value& v, size_t h)
+        : key(k), value(v), hash(h), crf(0), last(0), priority(0), heapIndex(0)
+    {}
+
+    const Key& getKey() const { return key; }
+    size_t getHash() const { return hash; }
+};
+
+/**
+ * @brief LRFU (Least Recently/Frequently Used) 指数衰减淘汰策略
+ *
+ * 核心设计：
+ * 1. 每次访问贡献 F(x) = 2^(-lambda * x) 的得分，x 为距今经过的逻辑时间(访问次数)，
+ *    条目的得分 CRF 是所有历史访问贡献之和，旧的热度按指数衰减，新热点可以很快超过旧热点。
+ * 2. 得分惰性计算：只保存最近一次访问时的 CRF 与时间戳，再次访问时 CRF = 1 + CRF * 2^(-lambda * Δt)，
+ *    两次访问之间不需要更新任何条目。
+ * 3. 所有条目的得分以相同的比例随时间衰减，因此比较 CRF(now) 等价于比较 log2(CRF) + lambda * last，
+ *    这个键只在访问时改变，可以放进可按节点更新的小顶堆，淘汰堆顶即得分最低的条目。
+ * 4. lambda 在 [0, 1] 之间调节：lambda = 0 时 CRF 即访问次数(LFU)，
+ *    lambda = 1 时最近一次访问的贡献超过所有更早访问之和(LRU)，中间值兼顾两者。
+ */
+template<typename Key, typename Value>
+class KLrfuCache : public KICachePolicy<Key, Value>
+{
+public:
+    using NodeType = LrfuNode<Key, Value>;
+    using NodePtr = std::shared_ptr<NodeType>;
+    using NodeMap = KHashIndex<Key, NodePtr>;
+
+    /**
+     * @brief 构造函数
+     *
+     * @param capacity 缓存容量
+     * @param lambda 衰减参数 取值 [0, 1] 越大越接近 LRU 越小越接近 LFU
+     */
+    explicit KLrfuCache(int capacity, double lambda = 0.01)
+        : capacity_(capacity > 0 ? static_cast<size_t>(capacity) : 0)
+        , lambda_(lambda < 0 ? 0 : (lambda > 1 ? 1 : lambda))
+        , now_(0)
+    {}
+
+    ~KLrfuCache() override = default;
+
+    void put(Key key, Value value) override
+    {
+        put(key, value, KHashOf(key));
+    }
+
+    // 使用调用方预先算好的哈希值 要求 hash == KHashOf(key)
+    void put(const Key& key, const Value& value, size_t hash)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        NodePtr* found = nodeMap_.find(key, hash);
+        if (found)
+        {
+            NodePtr node = *found;
+            node->value = value;
+            reference(node);
+            heap_.update(node);
+            return;
+        }
+
+        if (capacity_ == 0)
+        {
+            trimLocked(this->kTrimBatch);
+            return;
+        }
+        trimLocked(this->kTrimBatch);
+        if (nodeMap_.size() >= capacity_)
+            evict();
+
+        NodePtr node = std::make_shared<NodeType>(key, value, hash);
+        reference(node);
+        heap_.push(node);
+        nodeMap_.insert(hash, node);
+    }
+
+    bool get(Key key, Value& value) override
+    {
+        return get(key, value, KHashOf(key));
+    }
+
+    bool get(const Key& key, Value& value, size_t hash)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        NodePtr* found = nodeMap_.find(key, hash);
+        if (!found)
+            return false;
+        NodePtr node = *found;
+        reference(node);
+        heap_.update(node);
+        value = node->value;
+        return true;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 只更新已存在节点的值 CRF 与堆中位置不变
+    bool updateIfPresent(Key key, Value value) override
+    {
+        size_t hash = KHashOf(key);
+        std::lock_guard<std::mutex> lock(mutex_);
+        NodePtr* found = nodeMap_.find(key, hash);
+        if (!found)
+            return false;
+        (*found)->value = std::move(value);
+        return true;
+    }
+
+    void remove(Key key)
+    {
+        remove(key, KHashOf(key));
+    }
+
+    void remove(const Key& key, size_t hash)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        NodePtr* found = nodeMap_.find(key, hash);
+        if (!found)
+            return;
+        heap_.erase(*found);
+        nodeMap_.erase(key, hash);
+    }
+
+    double lambda() const { return lambda_; }
+
+    void setCapacity(size_t capacity) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capacity_ = capacity;
+    }
+
+    size_t trim(size_t maxEvictions) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return trimLocked(maxEvictions);
+    }
+
+private:
+    size_t trimLocked(size_t maxEvictions)
+    {
+        while (maxEvictions-- > 0 && nodeMap_.size() > capacity_)
+            evict();
+        return nodeMap_.size() > capacity_ ? nodeMap_.size() - capacity_ : 0;
+    }
+
+    // 记一次访问：先把旧得分衰减到当前时刻 再加上本次访问的贡献
+    void reference(const NodePtr& node)
+    {
+        ++now_;
+        double decay = node->crf > 0 ? std::exp2(-lambda_ * static_cast<double>(now_ - node->last)) : 0;
+        node->crf = 1.0 + node->crf * decay;
+        node->last = now_;
+        node->priority = std::log2(node->crf) + lambda_ * static_cast<double>(now_);
+    }
+
+    void evict()
+    {
+        NodePtr victim = heap_.pop();
+        nodeMap_.eraseNode(victim);
+        this->onEvict(victim->key, victim->value);
+    }
+
+private:
+    struct PriorityLess
+    {
+        bool operator()(const NodePtr& a, const NodePtr& b) const
+        {
+            // 键相同时先淘汰更久未访问的
+            return a->priority < b->priority || (a->priority == b->priority && a->last < b->last);
+        }
+    };
+
+    size_t                              capacity_; // 缓存容量
+    double                              lambda_;   // 衰减参数
+    uint64_t                            now_;      // 逻辑时间 每次访问加一
+    KIndexedHeap<NodePtr, PriorityLess> heap_;     // 按得分排列的小顶堆
+    NodeMap                             nodeMap_;  // key -> 节点 的索引
+    std::mutex                          mutex_;    // 互斥锁，保证线程安全
+};
+
+// LRFU 的分片版本 构造参数为 (总容量, 分片数, lambda)
+template<typename Key, typename Value>
+using KHashLrfuCache = KShardedCache<Key, Value, KLrfuCache<Key, Value>>;
+
+} // namespace KamaCache
@@ -1,18 +1,26 @@
 #pragma once 
 
+#include <cmath>
 #include <cstring>
 #include <list>
 #include <memory>
 #include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "KICachePolicy.h"
+#include "KFlatLruCache.h"
+#include "KHashIndex.h"
+#include "KHugePage.h"
+#include "KShardedCache.h"
 
 namespace KamaCache
 {
 
 // 前向声明 由于KLruCache在LruNode后才定义，而LruNode中需要使用KLruCache作为友元类，因此前向定义
-template<typename Key, typename Value> class KLruCache;
+// 第三个模板参数仅用于选择偏特化(见文件后部的扁平存储版本)，使用时不需要填写
+template<typename Key, typename Value, typename Enable = void> class KLruCache;
 
 /**
  * @brief LRU 缓存的双向链表节点类
@@ -27,6 +35,7 @@ class LruNode
 private:
     Key key_;             // 存储键，用于反向在 Hash 表中查找并删除
     Value value_;         // 存储实际数据
+    size_t hash_;         // key 的哈希值 插入时计算一次 淘汰时直接用它删除索引
     size_t accessCount_;  // 访问次数
     /**
      * @brief 前向指针 (Previous Pointer)
@@ -43,36 +52,45 @@ private:
 
 public:
     /// 构造函数：初始化键值对，默认引用计数为 1
-    LruNode(Key key, Value value)
+    LruNode(Key key, Value value, size_t hash = 0)
         : key_(key)
-        , value_(value)
+        , value_(std::move(value))
+        , hash_(hash)
         , accessCount_(1) 
     {}
 
     // 提供必要的访问器
     // 在访问器的设计，外层加 const，保证不修改成员变量
-    Key getKey() const { return key_; }
+    const Key& getKey() const { return key_; }
+    size_t getHash() const { return hash_; }
     Value getValue() const { return value_; }
     // Set 方法用于更新缓存值
-    void setValue(const Value& value) { value_ = value; }
+    void setValue(Value value) { value_ = std::move(value); }
     size_t getAccessCount() const { return accessCount_; }
     void incrementAccessCount() { ++accessCount_; }
     // 友元声明，允许 KLruCache 访问私有成员
-    friend class KLruCache<Key, Value>;
+    template<typename K, typename V, typename E> friend class KLruCache;
 };
 
 
-template<typename Key, typename Value>
+template<typename Key, typename Value, typename Enable>
 class KLruCache : public KICachePolicy<Key, Value>
 {
 public:
     using LruNodeType = LruNode<Key, Value>;
     using NodePtr = std::shared_ptr<LruNodeType>;
-    using NodeMap = std::unordered_map<Key, NodePtr>;
+    using NodeMap = KHashIndex<Key, NodePtr, KArenaAllocator<NodePtr>>;
 
     // 初始化构造函数 输入缓存容量 定义首尾哨兵节点
     KLruCache(int capacity)
-        : capacity_(capacity)
+        : KLruCache(capacity, KHugePageMode::Off)
+    {}
+
+    // hugePages 不为 Off 时 节点与索引槽位从本缓存独占的大页内存池分配 减少大容量缓存查找时的 dTLB 未命中
+    KLruCache(int capacity, KHugePageMode hugePages)
+        : arena_(hugePages != KHugePageMode::Off ? new KHugePageArena(hugePages) : nullptr)
+        , capacity_(capacity)
+        , nodeMap_(8, KArenaAllocator<NodePtr>(arena_.get()))
     {
         initializeList();
     }
@@ -84,31 +102,82 @@ public:
     // 写入操作
     void put(Key key, Value value) override
     {
-        // 检查容量是否有效
-        if (capacity_ <= 0)
-            return;
+        size_t hash = KHashOf(key);
+        put(key, std::move(value), hash);
+    }
+
+    // 使用调用方预先算好的哈希值(如分片缓存路由时已计算) 避免重复哈希
+    // value 按值传入后一路移动到节点中 调用方传右值时整个写入不拷贝 Value
+    void put(const Key& key, Value value, size_t hash)
+    {
         // KRU缓存互斥锁
         std::lock_guard<std::mutex> lock(mutex_);
-        auto it = nodeMap_.find(key);
+        NodePtr* node = nodeMap_.find(key, hash);
         // 两种更新方式：更新已有节点，添加新节点
-        if (it != nodeMap_.end())
+        if (node)
         {
             // 如果在当前容器中,则更新value,并调用get方法，代表该数据刚被访问
-            updateExistingNode(it->second, value);
+            updateExistingNode(*node, std::move(value));
             return ;
         }
+        // 检查容量是否有效 容量可能被 setCapacity 改为 0 已有的 key 已在上面更新 新 key 不再写入 只回收超出的条目
+        if (capacity_ <= 0)
+        {
+            trimLocked(this->kTrimBatch);
+            return;
+        }
         // 如果不存在map(缓存)中，则添加新节点
-        addNewNode(key, value);
+        addNewNode(key, std::move(value), hash);
     }
+
+    // 冷端写入：新节点插入链表头部(最久未访问端) 已存在的节点只更新值
+    void putCold(Key key, Value value) override
+    {
+        size_t hash = KHashOf(key);
+        std::lock_guard<std::mutex> lock(mutex_);
+        NodePtr* node = nodeMap_.find(key, hash);
+        if (node)
+        {
+            (*node)->setValue(value);
+            return;
+        }
+        if (capacity_ <= 0)
+        {
+            trimLocked(this->kTrimBatch);
+            return;
+        }
+        makeRoom();
+        NodePtr newNode = makeNode(key, value, hash);
+        insertNodeAtHead(newNode);
+        nodeMap_.insert(hash, newNode);
+    }
+
+    // 只更新已存在节点的值 不移动节点
+    bool updateIfPresent(Key key, Value value) override
+    {
+        size_t hash = KHashOf(key);
+        std::lock_guard<std::mutex> lock(mutex_);
+        NodePtr* node = nodeMap_.find(key, hash);
+        if (!node)
+            return false;
+        (*node)->setValue(std::move(value));
+        return true;
+    }
+
     // 读取操作，value为传出参数 返回bool表示是否找到
     bool get(Key key, Value& value) override
+    {
+        return get(key, value, KHashOf(key));
+    }
+
+    bool get(const Key& key, Value& value, size_t hash)
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        auto it = nodeMap_.find(key);
-        if (it != nodeMap_.end())
+        NodePtr* node = nodeMap_.find(key, hash);
+        if (node)
         {
-            moveToMostRecent(it->second);
-            value = it->second->getValue();
+            moveToMostRecent(*node);
+            value = (*node)->getValue();
             return true;
         }
         return false;
@@ -127,20 +196,44 @@ public:
     // 删除指定元素
     void remove(Key key) 
     {   
+        remove(key, KHashOf(key));
+    }
+
+    void remove(const Key& key, size_t hash)
+    {
         std::lock_guard<std::mutex> lock(mutex_);
         // 如果找到该key，则移除对应节点
-        auto it = nodeMap_.find(key);
-        if (it != nodeMap_.end())
+        NodePtr* node = nodeMap_.find(key, hash);
+        if (node)
         {
             // 从链表中移除节点
             // 因为removeNode在moveToMostRecent中也复用
             // 因此将哈希表中的删除和链表节点的删除分开
             // 仅在完全删除节点时调用
-            removeNode(it->second);
-            nodeMap_.erase(it);
+            removeNode(*node);
+            nodeMap_.erase(key, hash);
         }
     }
 
+    // 大页内存池的统计 未开启时全部为 0
+    KHugePageStats hugePageStats()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return arena_ ? arena_->stats() : KHugePageStats();
+    }
+
+    void setCapacity(size_t capacity) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capacity_ = static_cast<int>(capacity);
+    }
+
+    size_t trim(size_t maxEvictions) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return trimLocked(maxEvictions);
+    }
+
 // 私有成员函数是将外部接口细化为更小的功能块，所有的复杂逻辑到最后就是私有函数内的增删改查
 private:
     void initializeList()
@@ -152,27 +245,32 @@ private:
         dummyTail_->prev_ = dummyHead_;
     }
 
+    // 节点与 shared_ptr 控制块在同一次分配中 开启大页时来自内存池
+    NodePtr makeNode(const Key& key, Value value, size_t hash)
+    {
+        if (arena_)
+            return std::allocate_shared<LruNodeType>(KArenaAllocator<LruNodeType>(arena_.get()), key, std::move(value), hash);
+        return std::make_shared<LruNodeType>(key, std::move(value), hash);
+    }
+
     // 当实行写入操作时，如果该key已存在，则更新其value值
     // 同时将其移动到链表尾部，表示最近访问过
     // 这说明了写入操作也会影响缓存的访问顺序
-    void updateExistingNode(NodePtr node, const Value& value) 
+    void updateExistingNode(NodePtr node, Value value) 
     {
-        node->setValue(value);
+        node->setValue(std::move(value));
         moveToMostRecent(node); // 更新访问顺序
     }
 
     // 添加新节点到缓存
     // 执行顺序：节点容量检查 -> 驱逐最少使用节点（如有必要） -> 创建新节点 -> 插入节点 -> 更新哈希表
-    void addNewNode(const Key& key, const Value& value) 
+    void addNewNode(const Key& key, Value value, size_t hash) 
     {
-       if (nodeMap_.size() >= capacity_) 
-       {
-           evictLeastRecent();
-       }
+       makeRoom();
 
-       NodePtr newNode = std::make_shared<LruNodeType>(key, value);
+       NodePtr newNode = makeNode(key, std::move(value), hash);
        insertNode(newNode);
-       nodeMap_[key] = newNode;
+       nodeMap_.insert(hash, newNode);
     }
 
     // 将该节点移动到最新的位置，当该节点被访问时且存在在缓存中，调用
@@ -214,6 +312,32 @@ private:
         dummyTail_->prev_ = node;
     }
 
+    // 从头部插入结点 即作为最久未访问的节点 下一次淘汰时最先被删除
+    void insertNodeAtHead(NodePtr node)
+    {
+        node->prev_ = dummyHead_;
+        node->next_ = dummyHead_->next_;
+        dummyHead_->next_->prev_ = node;
+        dummyHead_->next_ = node;
+    }
+
+    // 为新节点腾出一个位置 缩容后超出容量的部分每次最多多淘汰 kTrimBatch 个 持有锁
+    void makeRoom()
+    {
+        trimLocked(this->kTrimBatch);
+        if (nodeMap_.size() >= static_cast<size_t>(capacity_))
+            evictLeastRecent();
+    }
+
+    // 淘汰至多 maxEvictions 个超出容量的节点 返回仍超出的数量 持有锁
+    size_t trimLocked(size_t maxEvictions)
+    {
+        size_t capacity = capacity_ > 0 ? static_cast<size_t>(capacity_) : 0;
+        while (maxEvictions-- > 0 && nodeMap_.size() > capacity)
+            evictLeastRecent();
+        return nodeMap_.size() > capacity ? nodeMap_.size() - capacity : 0;
+    }
+
     // 驱逐最近最少访问
     // 删除链表头部的第一个真实节点，即最近最少访问的节点
     // 从哈希表中删除该节点的映射关系，让该数值不存在于缓存中
@@ -221,10 +345,12 @@ private:
     {
         NodePtr leastRecent = dummyHead_->next_;
         removeNode(leastRecent);
-        nodeMap_.erase(leastRecent->getKey());
+        nodeMap_.eraseNode(leastRecent); // 按节点保存的哈希删除 不再对 key 重新求哈希
+        this->onEvict(leastRecent->getKey(), leastRecent->getValue()); // 通知淘汰回调(如二级缓存)
     }
 
 private:
+    std::unique_ptr<KHugePageArena> arena_; // 大页内存池 最先构造、最后析构 为空表示使用普通堆内存
     int           capacity_;  // 缓存最大容量
     NodeMap       nodeMap_;   // 哈希表。存储 Key -> Node指针 的映射。用于快速定位节点。
     std::mutex    mutex_;     // 互斥锁，保证线程安全
@@ -232,6 +358,16 @@ private:
     NodePtr       dummyTail_; // 虚拟尾结点
 };
 
+// LRU优化：Key 与 Value 都是可平凡拷贝的小对象时(如 KLruCache<uint64_t, uint64_t>)，
+// 编译期自动选用扁平存储实现：槽位数组 + 32 位下标链表 + 开放寻址索引，不再为每个条目分配节点
+template<typename Key, typename Value>
+class KLruCache<Key, Value, std::enable_if_t<KFlatLruEnabled<Key, Value>::value>>
+    : public KFlatLruCache<Key, Value>
+{
+public:
+    using KFlatLruCache<Key, Value>::KFlatLruCache;
+};
+
 // LRU优化：Lru-k版本。 通过继承的方式进行再优化
 template<typename Key, typename Value>
 class KLruKCache : public KLruCache<Key, Value>
@@ -330,58 +466,29 @@ private:
 };
 
 // lru优化：对lru进行分片，提高高并发使用的性能
+// 分片逻辑(容量均分、哈希路由、哈希值下传)由 KShardedCache 统一实现
 template<typename Key, typename Value>
-class KHashLruCaches
+class KHashLruCaches : public KShardedCache<Key, Value, KLruCache<Key, Value>>
 {
 public:
     // Hash分片LRU缓存构造函数
-    // 外部输入总容量与分片数量
+    // 外部输入总容量与分片数量 如果sliceNum小于等于0，则使用可用 CPU 数作为分片数量
     KHashLruCaches(size_t capacity, int sliceNum)
-        : capacity_(capacity)
-        , sliceNum_(sliceNum > 0 ? sliceNum : std::thread::hardware_concurrency()) // 如果sliceNum小于等于0，则使用硬件并发线程数作为分片数量
-    {
-        size_t sliceSize = std::ceil(capacity / static_cast<double>(sliceNum_)); // 获取每个分片的大小
-        for (int i = 0; i < sliceNum_; ++i)
-        {
-            lruSliceCaches_.emplace_back(new KLruCache<Key, Value>(sliceSize)); // 将每个分片的LRU缓存加入到切片缓存数组中
-        }
-    }
-    // 由于没有继承，因此是KHashLruCaches类的操作函数: put get
-    void put(Key key, Value value)
-    {
-        // 利用key的hash值进行分片
-        // 获取key的hash值，并计算出对应的分片索引
-        size_t sliceIndex = Hash(key) % sliceNum_;
-        lruSliceCaches_[sliceIndex]->put(key, value);
-    }
-
-    bool get(Key key, Value& value)
-    {
-        // 获取key的hash值，并计算出对应的分片索引
-        size_t sliceIndex = Hash(key) % sliceNum_;
-        return lruSliceCaches_[sliceIndex]->get(key, value);
-    }
+        : KShardedCache<Key, Value, KLruCache<Key, Value>>(capacity, sliceNum)
+    {}
 
-    Value get(Key key)
-    {
-        Value value;
-        // memset(&value, 0, sizeof(value)); // 由于是模板类，对于复杂类型（如 string）使用 memset 可能会破坏对象的内部结构
-        get(key, value);
-        return value;
-    }
+    // 每个分片使用自己的大页内存池 适合几十 GB 级别的大容量实例
+    KHashLruCaches(size_t capacity, int sliceNum, KHugePageMode hugePages)
+        : KShardedCache<Key, Value, KLruCache<Key, Value>>(capacity, sliceNum, hugePages)
+    {}
 
-private:
-    // 将key转换为对应hash值
-    size_t Hash(Key key)
+    // 所有分片大页内存池的统计之和
+    KHugePageStats hugePageStats()
     {
-        std::hash<Key> hashFunc;
-        return hashFunc(key);
+        KHugePageStats total;
+        this->forEachSlice([&total](KLruCache<Key, Value>& slice) { total += slice.hugePageStats(); });
+        return total;
     }
-
-private:
-    size_t                                              capacity_;  // 总容量
-    int                                                 sliceNum_;  // 切片数量
-    std::vector<std::unique_ptr<KLruCache<Key, Value>>> lruSliceCaches_; // 切片LRU缓存
 };
 
 } // namespace KamaCache
\ No newline at end of file
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace KamaCache
+{
+
+/**
+ * @brief 后台维护线程：反复调用缓存的 trim 分批回收缩容后超出容量的条目
+ *
+ * setCapacity 缩容时不在调用线程上一次淘汰，写入路径每次也只多淘汰 kTrimBatch 个，写入很少时回收会很慢。
+ * 维护线程每轮调用 trim(batch)，每轮只持有一次缓存锁(分片缓存为每个分片一次)，读写线程最多被阻塞一个批次：
+ * - trim 返回仍有剩余时让出 CPU 后立即进入下一轮；
+ * - 已经回收完时等待 interval 或 wake() 唤醒。
+ * 析构时停止并等待线程退出，因此必须先于缓存析构。
+ *
+ * 例：KHashLruCaches<int, std::string> cache(...);
+ *     KMaintenanceThread maintenance([&cache](size_t n) { return cache.trim(n); });
+ *     cache.setCapacity(smaller);
+ *     maintenance.wake();
+ */
+class KMaintenanceThread
+{
+public:
+    using TrimFunction = std::function<size_t(size_t)>;
+
+    /**
+     * @brief 构造后立即启动线程
+     *
+     * @param trim 回收函数 参数为本轮最多淘汰的条目数 返回之后仍超出容量的条目数
+     * @param batch 每轮最多淘汰的条目数
+     * @param interval 没有待回收条目时的检查间隔
+     */
+    explicit KMaintenanceThread(TrimFunction trim, size_t batch = 64,
+                                std::chrono::milliseconds interval = std::chrono::milliseconds(10))
+        : trim_(std::move(trim))
+        , batch_(batch > 0 ? batch : 1)
+        , interval_(interval)
+        , stop_(false)
+        , wakeRequested_(false)
+        , rounds_(0)
+        , thread_([this] { run(); })
+    {}
+
+    ~KMaintenanceThread()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_one();
+        thread_.join();
+    }
+
+    KMaintenanceThread(const KMaintenanceThread&) = delete;
+    KMaintenanceThread& operator=(const KMaintenanceThread&) = delete;
+
+    // 调用 setCapacity 缩容后唤醒线程 不必等到下一个检查间隔
+    void wake()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            wakeRequested_ = true;
+        }
+        cv_.notify_one();
+    }
+
+    // 已经调用 trim 的轮数
+    uint64_t rounds() const { return rounds_.load(std::memory_order_relaxed); }
+
+private:
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_)
+        {
+            lock.unlock();
+            size_t remaining = trim_(batch_);
+            rounds_.fetch_add(1, std::memory_order_relaxed);
+            if (remaining > 0)
+            {
+                // 两轮之间让出 CPU 等待锁的读写线程可以先执行
+                std::this_thread::yield();
+                lock.lock();
+                continue;
+            }
+            lock.lock();
+            cv_.wait_for(lock, interval_, [this] { return stop_ || wakeRequested_; });
+            wakeRequested_ = false;
+        }
+    }
+
+private:
+    TrimFunction              trim_;
+    size_t                    batch_;
+    std::chrono::milliseconds interval_;
+    std::mutex                mutex_;
+    std::condition_variable   cv_;
+    bool                      stop_;          // 由 mutex_ 保护
+    bool                      wakeRequested_; // 由 mutex_ 保护
+    std::atomic<uint64_t>     rounds_;
+    std::thread               thread_;        // 最后初始化 线程启动时其他成员都已构造
+};
+
+} // namespace KamaCache
@@ -0,0 +1,269 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "KHashIndex.h"
+
+namespace KamaCache
+{
+
+/**
+ * @brief 线程局部的近端缓存(L1)，放在任意分片缓存(L2)前面
+ *
+ * 即使没有竞争，分片缓存的每次 get 也要加解锁一次，并且锁和节点所在的缓存行需要在核间传递。
+ * 近端缓存为每个线程维护一张很小的两路组相联表，同一线程重复读取同一个 key 时不触碰任何共享数据，
+ * 只读取一个版本号：
+ * 1. key 按哈希映射到 versionStripes 个版本号之一，写入或失效时在写完 L2 之后把版本号加一。
+ * 2. 读取 L2 之前先读版本号，与读到的值一起存入 L1；L1 命中时用一次 relaxed 读取比较版本号，
+ *    不一致说明之后有过写入，丢弃该项回到 L2。
+ * 3. 写入不会填充 L1：多个线程并发写同一个 key 时无法判断哪个值最终留在 L2。
+ * L1 中的值可能已被 L2 淘汰，但只要版本号未变就仍然是最新的值。
+ *
+ * 只有通过本类写入或调用 invalidate 的修改能被感知，绕过本类直接写 L2 会让 L1 读到旧值。
+ */
+template<typename Key, typename Value, typename Cache>
+class KNearCache
+{
+private:
+    // 独占一条缓存行的版本号 避免相邻条带的写入互相使对方失效
+    struct alignas(64) Version
+    {
+        std::atomic<uint64_t> value{0};
+    };
+
+    struct Entry
+    {
+        Key      key{};
+        Value    value{};
+        size_t   hash = 0;
+        uint64_t version = 0;
+        bool     valid = false;
+    };
+
+    // 一个线程在一个实例上的 L1 两路组相联
+    struct Table
+    {
+        explicit Table(size_t sets)
+            : entries(sets * 2)
+            , recent(sets, 0)
+            , mask(sets - 1)
+        {}
+
+        std::vector<Entry>   entries; // 第 s 组占 [2s, 2s + 1]
+        std::vector<uint8_t> recent;  // 每组最近使用的路
+        size_t               mask;
+        uint64_t             hits = 0;
+        uint64_t             misses = 0;
+    };
+
+    // 一个实例的全部 L1 实例析构时一并释放 与线程局部的槽位共享 以便线程退出时找回自己的 L1
+    struct Registry
+    {
+        std::mutex                          mutex;
+        std::vector<std::unique_ptr<Table>> tables;
+    };
+
+    // 一个线程为一个实例编号保存的 L1 编号被新实例复用后按代号区分
+    struct LocalSlot
+    {
+        LocalSlot(uint64_t gen, std::shared_ptr<Registry> reg, size_t sets)
+            : generation(gen)
+            , table(new Table(sets))
+            , registry(std::move(reg))
+        {
+            std::lock_guard<std::mutex> lock(registry->mutex);
+            registry->tables.emplace_back(table);
+        }
+
+        // 线程退出或编号被复用时调用 实例已经析构时它的 L1 已被释放 这里找不到
+        ~LocalSlot()
+        {
+            std::lock_guard<std::mutex> lock(registry->mutex);
+            std::vector<std::unique_ptr<Table>>& tables = registry->tables;
+            for (size_t i = 0; i < tables.size(); ++i)
+            {
+                if (tables[i].get() == table)
+                {
+                    tables[i] = std::move(tables.back());
+                    tables.pop_back();
+                    break;
+                }
+            }
+        }
+
+        LocalSlot(const LocalSlot&) = delete;
+        LocalSlot& operator=(const LocalSlot&) = delete;
+
+        uint64_t                  generation;
+        Table*                    table;    // 由 registry 持有
+        std::shared_ptr<Registry> registry;
+    };
+
+    // 实例编号在实例析构后复用 线程局部的槽位数不超过同时存在的实例数
+    struct SlotAllocator
+    {
+        std::mutex          mutex;
+        std::vector<size_t> freeSlots;
+        size_t              nextSlot = 0;
+        uint64_t            nextGeneration = 1;
+    };
+
+public:
+    /**
+     * @brief 构造函数
+     *
+     * @param cache 被加速的共享缓存
+     * @param entries 每个线程 L1 的条目数 向上取整为 2 的幂
+     * @param versionStripes 版本号条带数 越多则一次写入误伤的 L1 条目越少
+     */
+    KNearCache(std::unique_ptr<Cache> cache, size_t entries = 256, size_t versionStripes = 1024)
+        : cache_(std::move(cache))
+        , sets_(roundUpPow2(entries < 2 ? 1 : entries / 2))
+        , stripeMask_(roundUpPow2(versionStripes) - 1)
+        , versions_(new Version[stripeMask_ + 1])
+        , registry_(std::make_shared<Registry>())
+    {
+        SlotAllocator& allocator = slotAllocator();
+        std::lock_guard<std::mutex> lock(allocator.mutex);
+        if (allocator.freeSlots.empty())
+        {
+            slot_ = allocator.nextSlot++;
+        }
+        else
+        {
+            slot_ = allocator.freeSlots.back();
+            allocator.freeSlots.pop_back();
+        }
+        generation_ = allocator.nextGeneration++;
+    }
+
+    // 释放所有线程在本实例上的 L1 其他线程中残留的槽位在编号复用或线程退出时清理
+    ~KNearCache()
+    {
+        {
+            std::lock_guard<std::mutex> lock(registry_->mutex);
+            registry_->tables.clear();
+        }
+        SlotAllocator& allocator = slotAllocator();
+        std::lock_guard<std::mutex> lock(allocator.mutex);
+        allocator.freeSlots.push_back(slot_);
+    }
+
+    KNearCache(const KNearCache&) = delete;
+    KNearCache& operator=(const KNearCache&) = delete;
+
+    bool get(const Key& key, Value& value)
+    {
+        size_t hash = KHashOf(key);
+        Table& table = localTable();
+        std::atomic<uint64_t>& version = versionOf(hash);
+        size_t set = (static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull >> 32) & table.mask;
+        Entry* ways = &table.entries[set * 2];
+        for (int way = 0; way < 2; ++way)
+        {
+            Entry& entry = ways[way];
+            if (entry.valid && entry.hash == hash && entry.key == key)
+            {
+                if (entry.version == version.load(std::memory_order_relaxed))
+                {
+                    table.recent[set] = static_cast<uint8_t>(way);
+                    ++table.hits;
+                    value = entry.value;
+                    return true;
+                }
+                entry.valid = false;
+                break;
+            }
+        }
+
+        ++table.misses;
+        // 先读版本号再读 L2：期间发生的写入一定会让这里记录的版本号过期
+        uint64_t seen = version.load(std::memory_order_acquire);
+        if (!cache_->get(key, value))
+            return false;
+
+        int victim = !ways[0].valid ? 0 : !ways[1].valid ? 1 : 1 - table.recent[set];
+        Entry& entry = ways[victim];
+        entry.key = key;
+        entry.value = value;
+        entry.hash = hash;
+        entry.version = seen;
+        entry.valid = true;
+        table.recent[set] = static_cast<uint8_t>(victim);
+        return true;
+    }
+
+    Value get(const Key& key)
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 写入 L2 后递增版本号 所有线程中该条带上的 L1 条目随之失效
+    void put(const Key& key, const Value& value)
+    {
+        size_t hash = KHashOf(key);
+        cache_->put(key, value);
+        versionOf(hash).fetch_add(1, std::memory_order_release);
+    }
+
+    // L2 中的 key 被其他途径修改后调用
+    void invalidate(const Key& key)
+    {
+        versionOf(KHashOf(key)).fetch_add(1, std::memory_order_release);
+    }
+
+    // 调用线程在本实例上的 L1 命中与未命中次数
+    uint64_t localHits() { return localTable().hits; }
+    uint64_t localMisses() { return localTable().misses; }
+
+    Cache& cache() { return *cache_; }
+
+private:
+    static size_t roundUpPow2(size_t n)
+    {
+        size_t result = 1;
+        while (result < n)
+            result <<= 1;
+        return result;
+    }
+
+    static SlotAllocator& slotAllocator()
+    {
+        static SlotAllocator allocator;
+        return allocator;
+    }
+
+    std::atomic<uint64_t>& versionOf(size_t hash)
+    {
+        return versions_[hash & stripeMask_].value;
+    }
+
+    // 每个线程按实例编号保存各实例的 L1 线程退出或实例析构时释放
+    Table& localTable()
+    {
+        thread_local std::vector<std::unique_ptr<LocalSlot>> slots;
+        if (slot_ >= slots.size())
+            slots.resize(slot_ + 1);
+        std::unique_ptr<LocalSlot>& local = slots[slot_];
+        if (!local || local->generation != generation_)
+            local.reset(new LocalSlot(generation_, registry_, sets_));
+        return *local->table;
+    }
+
+private:
+    std::unique_ptr<Cache>     cache_;      // 共享的 L2
+    size_t                     sets_;       // 每个线程 L1 的组数
+    size_t                     stripeMask_; // 版本号条带数 - 1
+    std::unique_ptr<Version[]> versions_;   // 版本号条带
+    std::shared_ptr<Registry>  registry_;   // 各线程在本实例上的 L1
+    size_t                     slot_;       // 实例编号 用于定位线程局部的 L1 实例析构后复用
+    uint64_t                   generation_; // 实例代号 区分复用同一编号的先后实例
+};
+
+} // namespace KamaCache
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace KamaCache
+{
+
+/**
+ * @brief S3-FIFO 的幽灵队列：只记录被淘汰 key 的 32 位指纹，不保存 key 与 value
+ * 环形数组按 FIFO 顺序保存指纹，计数表记录每个指纹在环中出现的次数，
+ * 队列满时覆盖最旧的指纹并减少其计数。指纹冲突只会让个别新 key 直接进入 main 队列，不影响正确性。
+ */
+class KGhostFifo
+{
+public:
+    explicit KGhostFifo(size_t capacity)
+        : ring_(capacity > 0 ? capacity : 1)
+        , next_(0)
+        , size_(0)
+    {}
+
+    void insert(size_t hash)
+    {
+        uint32_t fp = fingerprint(hash);
+        if (size_ == ring_.size())
+        {
+            // 队列已满 next_ 指向的就是最旧的指纹
+            auto it = counts_.find(ring_[next_]);
+            if (it != counts_.end() && --it->second == 0)
+                counts_.erase(it);
+        }
+        else
+        {
+            ++size_;
+        }
+        ring_[next_] = fp;
+        ++counts_[fp];
+        next_ = (next_ + 1) % ring_.size();
+    }
+
+    bool contains(size_t hash) const
+    {
+        return counts_.find(fingerprint(hash)) != counts_.end();
+    }
+
+    size_t size() const { return size_; }
+
+    // 调整容量 保留最新的指纹
+    void resize(size_t capacity)
+    {
+        capacity = capacity > 0 ? capacity : 1;
+        if (capacity == ring_.size())
+            return;
+        // 队列未满时最旧的指纹在下标 0 已满时在 next_
+        size_t oldest = size_ == ring_.size() ? next_ : 0;
+        std::vector<uint32_t> ordered;
+        ordered.reserve(size_);
+        for (size_t i = 0; i < size_; ++i)
+            ordered.push_back(ring_[(oldest + i) % ring_.size()]);
+        size_t drop = ordered.size() > capacity ? ordered.size() - capacity : 0;
+        for (size_t i = 0; i < drop; ++i)
+        {
+            auto it = counts_.find(ordered[i]);
+            if (it != counts_.end() && --it->second == 0)
+                counts_.erase(it);
+        }
+        ring_.assign(capacity, 0);
+        std::copy(ordered.begin() + drop, ordered.end(), ring_.begin());
+        size_ = ordered.size() - drop;
+        next_ = size_ % capacity;
+    }
+
+private:
+    static uint32_t fingerprint(size_t hash)
+    {
+        uint64_t h = static_cast<uint64_t>(hash);
+        return static_cast<uint32_t>(h ^ (h >> 32));
+    }
+
+private:
+    std::vector<uint32_t>                  ring_;   // 指纹环形队列
+    size_t                                 next_;   // 下一个写入位置 队列满时即最旧的位置
+    size_t                                 size_;   // 环中的指纹数
+    std::unordered_map<uint32_t, uint32_t> counts_; // 指纹 -> 出现次数
+};
+
+} // namespace KamaCache
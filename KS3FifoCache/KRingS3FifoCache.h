@@ -0,0 +1,388 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+#include "../KHashIndex.h"
+#include "../KICachePolicy.h"
+#include "../KShardedCache.h"
+#include "KGhostFifo.h"
+
+namespace KamaCache
+{
+
+/**
+ * @brief 槽位下标环形队列 队首为最旧 队尾为最新 缓冲区只在 reserve 时扩大
+ */
+class KIndexRing
+{
+public:
+    explicit KIndexRing(size_t capacity)
+        : buf_(capacity > 0 ? capacity : 1)
+        , head_(0)
+        , size_(0)
+    {}
+
+    void pushBack(uint32_t slot)
+    {
+        buf_[(head_ + size_) % buf_.size()] = slot;
+        ++size_;
+    }
+
+    uint32_t popFront()
+    {
+        uint32_t slot = buf_[head_];
+        head_ = (head_ + 1) % buf_.size();
+        --size_;
+        return slot;
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    // 扩大缓冲区 队列中的下标按原顺序保留
+    void reserve(size_t capacity)
+    {
+        if (capacity <= buf_.size())
+            return;
+        std::vector<uint32_t> buf(capacity);
+        for (size_t i = 0; i < size_; ++i)
+            buf[i] = buf_[(head_ + i) % buf_.size()];
+        buf_.swap(buf);
+        head_ = 0;
+    }
+
+private:
+    std::vector<uint32_t> buf_;
+    size_t                head_;
+    size_t                size_;
+};
+
+/**
+ * @brief 基于环形队列的 S3-FIFO 实现
+ *
+ * 与 KS3FifoCache 的淘汰规则相同，区别在于数据布局与加锁方式：
+ * 1. 所有条目预先分配在一块槽位数组中(只在扩容时重新分配)，small / main 队列是存放槽位下标的环形数组，
+ *    入队出队没有堆分配，也没有链表指针。
+ * 2. 频次是原子变量，命中只需要共享锁：查找索引、饱和递增频次、拷贝数据，多个读者可以并发命中。
+ *    只有未命中后的插入、更新与淘汰需要独占锁。
+ * 3. 环形队列不支持从中间删除，remove 只把槽位标记为已删除并从索引中摘除，
+ *    槽位在轮到它出队时才被回收，因此不会破坏队列顺序。
+ */
+template<typename Key, typename Value>
+class KRingS3FifoCache : public KICachePolicy<Key, Value>
+{
+private:
+    enum class SlotState : uint8_t { Free, Small, Main, Removed };
+
+    struct Slot
+    {
+        Key                  key{};
+        Value                value{};
+        size_t               hash = 0;
+        std::atomic<uint8_t> freq{0}; // 2 位饱和计数器 命中时在共享锁下递增
+        SlotState            state = SlotState::Free;
+
+        const Key& getKey() const { return key; }
+        size_t getHash() const { return hash; }
+    };
+
+    using NodeMap = KHashIndex<Key, Slot*>;
+
+public:
+    /**
+     * @brief 构造函数
+     *
+     * @param capacity 缓存总容量 槽位数组一次性按容量分配 setCapacity 扩容超过它时重新分配
+     * @param smallRatio small 队列占总容量的比例
+     */
+    explicit KRingS3FifoCache(int capacity, double smallRatio = 0.1)
+        : capacity_(capacity > 0 ? static_cast<size_t>(capacity) : 0)
+        , slotCount_(capacity_)
+        , smallRatio_(smallRatio)
+        , smallCapacity_(std::max<size_t>(1, static_cast<size_t>(capacity_ * smallRatio)))
+        , mainCapacity_(capacity_ > smallCapacity_ ? capacity_ - smallCapacity_ : 1)
+        , slots_(new Slot[capacity_ > 0 ? capacity_ : 1])
+        , smallRing_(capacity_)
+        , mainRing_(capacity_)
+        , ghost_(mainCapacity_)
+        , nodeMap_(capacity_)
+    {
+        freeSlots_.reserve(capacity_);
+        for (size_t i = capacity_; i > 0; --i)
+            freeSlots_.push_back(static_cast<uint32_t>(i - 1));
+    }
+
+    ~KRingS3FifoCache() override = default;
+
+    void put(Key key, Value value) override
+    {
+        put(key, value, KHashOf(key));
+    }
+
+    // 使用调用方预先算好的哈希值 要求 hash == KHashOf(key)
+    void put(const Key& key, const Value& value, size_t hash)
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        Slot** found = nodeMap_.find(key, hash);
+        if (found)
+        {
+            (*found)->value = value;
+            touch(**found);
+            return;
+        }
+
+        if (capacity_ == 0)
+        {
+            trimLocked(this->kTrimBatch);
+            return;
+        }
+        // 已删除的槽位出队时只回收不计为淘汰 所以除了条目数还要保证有空闲槽位
+        trimLocked(this->kTrimBatch);
+        size_t before = nodeMap_.size();
+        while (freeSlots_.empty() || (before >= capacity_ && nodeMap_.size() == before))
+            evict();
+
+        uint32_t index = freeSlots_.back();
+        freeSlots_.pop_back();
+        Slot& slot = slots_[index];
+        slot.key = key;
+        slot.value = value;
+        slot.hash = hash;
+        slot.freq.store(0, std::memory_order_relaxed);
+        if (ghost_.contains(hash))
+        {
+            slot.state = SlotState::Main;
+            mainRing_.pushBack(index);
+        }
+        else
+        {
+            slot.state = SlotState::Small;
+            smallRing_.pushBack(index);
+        }
+        nodeMap_.insert(hash, &slot);
+    }
+
+    bool get(Key key, Value& value) override
+    {
+        return get(key, value, KHashOf(key));
+    }
+
+    // 命中只需共享锁 频次通过原子操作饱和递增
+    bool get(const Key& key, Value& value, size_t hash)
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        const NodeMap& index = nodeMap_;
+        Slot* const* found = index.find(key, hash);
+        if (!found)
+            return false;
+        touch(**found);
+        value = (*found)->value;
+        return true;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 只更新已存在槽位的值 不增加频次
+    bool updateIfPresent(Key key, Value value) override
+    {
+        size_t hash = KHashOf(key);
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        Slot** found = nodeMap_.find(key, hash);
+        if (!found)
+            return false;
+        (*found)->value = std::move(value);
+        return true;
+    }
+
+    void remove(Key key)
+    {
+        remove(key, KHashOf(key));
+    }
+
+    void remove(const Key& key, size_t hash)
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        Slot** found = nodeMap_.find(key, hash);
+        if (!found)
+            return;
+        Slot* slot = *found;
+        nodeMap_.eraseNode(slot);
+        slot->state = SlotState::Removed; // 槽位仍在队列中 出队时回收
+    }
+
+    // 扩容超过槽位数组大小时重新分配槽位数组并重建索引 耗时与条目数成正比；缩容不释放槽位
+    void setCapacity(size_t capacity) override
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        if (capacity > slotCount_)
+            growSlots(capacity);
+        capacity_ = capacity;
+        smallCapacity_ = std::max<size_t>(1, static_cast<size_t>(capacity_ * smallRatio_));
+        mainCapacity_ = capacity_ > smallCapacity_ ? capacity_ - smallCapacity_ : 1;
+        ghost_.resize(mainCapacity_);
+    }
+
+    size_t trim(size_t maxEvictions) override
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        return trimLocked(maxEvictions);
+    }
+
+private:
+    // 换用更大的槽位数组 队列保存的是下标不受影响 只需重建保存槽位指针的索引 持有独占锁
+    void growSlots(size_t count)
+    {
+        std::unique_ptr<Slot[]> slots(new Slot[count]);
+        for (size_t i = 0; i < slotCount_; ++i)
+        {
+            Slot& from = slots_[i];
+            Slot& to = slots[i];
+            to.key = std::move(from.key);
+            to.value = std::move(from.value);
+            to.hash = from.hash;
+            to.freq.store(from.freq.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            to.state = from.state;
+        }
+        for (size_t i = count; i > slotCount_; --i)
+            freeSlots_.push_back(static_cast<uint32_t>(i - 1));
+        slots_ = std::move(slots);
+        // 每个槽位最多在一个队列中出现一次 队列容量与槽位数相同即可
+        smallRing_.reserve(count);
+        mainRing_.reserve(count);
+        nodeMap_.clear();
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (slots_[i].state == SlotState::Small || slots_[i].state == SlotState::Main)
+                nodeMap_.insert(slots_[i].hash, &slots_[i]);
+        }
+        slotCount_ = count;
+    }
+
+    // 每次 evict 释放一个槽位 回收的可能是已删除的槽位 所以按调用次数而不是淘汰数计
+    size_t trimLocked(size_t maxEvictions)
+    {
+        while (maxEvictions-- > 0 && nodeMap_.size() > capacity_)
+            evict();
+        return nodeMap_.size() > capacity_ ? nodeMap_.size() - capacity_ : 0;
+    }
+
+    static void touch(Slot& slot)
+    {
+        uint8_t freq = slot.freq.load(std::memory_order_relaxed);
+        // 已饱和时不写 避免多个读者反复写同一缓存行
+        while (freq < 3 && !slot.freq.compare_exchange_weak(freq, freq + 1, std::memory_order_relaxed))
+        {}
+    }
+
+    // 每次调用恰好释放一个槽位
+    void evict()
+    {
+        if (smallRing_.size() >= smallCapacity_ || mainRing_.empty())
+            evictSmall();
+        else
+            evictMain();
+    }
+
+    void evictSmall()
+    {
+        while (!smallRing_.empty())
+        {
+            uint32_t index = smallRing_.popFront();
+            Slot& slot = slots_[index];
+            if (slot.state == SlotState::Removed)
+            {
+                release(index);
+                return;
+            }
+            if (slot.freq.load(std::memory_order_relaxed) > 0)
+            {
+                // 在 small 中被再次访问 晋升到 main 频次清零重新计数
+                slot.freq.store(0, std::memory_order_relaxed);
+                slot.state = SlotState::Main;
+                mainRing_.pushBack(index);
+                if (mainRing_.size() > mainCapacity_)
+                {
+                    evictMain();
+                    return;
+                }
+            }
+            else
+            {
+                ghost_.insert(slot.hash);
+                evictSlot(index);
+                return;
+            }
+        }
+        evictMain();
+    }
+
+    void evictMain()
+    {
+        while (!mainRing_.empty())
+        {
+            uint32_t index = mainRing_.popFront();
+            Slot& slot = slots_[index];
+            if (slot.state == SlotState::Removed)
+            {
+                release(index);
+                return;
+            }
+            uint8_t freq = slot.freq.load(std::memory_order_relaxed);
+            if (freq > 0)
+            {
+                slot.freq.store(freq - 1, std::memory_order_relaxed);
+                mainRing_.pushBack(index);
+            }
+            else
+            {
+                evictSlot(index);
+                return;
+            }
+        }
+    }
+
+    void evictSlot(uint32_t index)
+    {
+        Slot& slot = slots_[index];
+        nodeMap_.eraseNode(&slot);
+        this->onEvict(slot.key, slot.value);
+        release(index);
+    }
+
+    void release(uint32_t index)
+    {
+        slots_[index].state = SlotState::Free;
+        freeSlots_.push_back(index);
+    }
+
+private:
+    size_t                  capacity_;      // 缓存总容量
+    size_t                  slotCount_;     // 槽位数组的大小 不小于容量
+    double                  smallRatio_;    // small 队列占总容量的比例
+    size_t                  smallCapacity_; // small 队列容量
+    size_t                  mainCapacity_;  // main 队列容量
+    std::unique_ptr<Slot[]> slots_;         // 槽位数组 只在扩容时重新分配 索引直接保存槽位指针
+    std::vector<uint32_t>   freeSlots_;     // 空闲槽位下标
+    KIndexRing              smallRing_;     // small 队列
+    KIndexRing              mainRing_;      // main 队列
+    KGhostFifo              ghost_;         // 从 small 淘汰的 key 的指纹
+    NodeMap                 nodeMap_;       // key -> 槽位 的索引
+    std::shared_mutex       mutex_;         // 读写锁 命中走共享锁 修改结构走独占锁
+};
+
+// 环形 S3-FIFO 的分片版本：命中只需分片内的共享锁
+template<typename Key, typename Value>
+using KHashRingS3FifoCache = KShardedCache<Key, Value, KRingS3FifoCache<Key, Value>>;
+
+} // namespace KamaCache
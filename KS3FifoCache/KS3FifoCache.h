@@ -0,0 +1,297 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+
+#include "../KHashIndex.h"
+#include "../KICachePolicy.h"
+#include "../KShardedCache.h"
+#include "KGhostFifo.h"
+
+namespace KamaCache
+{
+
+template<typename Key, typename Value> class KS3FifoCache;
+
+/**
+ * @brief S3-FIFO 缓存节点
+ * freq_ 是 2 位饱和计数器(0~3)，命中时加一，不移动节点。
+ */
+template<typename Key, typename Value>
+class S3FifoNode
+{
+private:
+    using ListIter = typename std::list<std::shared_ptr<S3FifoNode>>::iterator;
+
+    Key      key_;
+    Value    value_;
+    size_t   hash_;   // key 的哈希值 淘汰时用于删除索引和写入幽灵队列
+    uint8_t  freq_;   // 访问频次 最大为 3
+    bool     inMain_; // 位于 main 队列还是 small 队列
+    ListIter pos_;    // 在所属队列中的位置 remove 时 O(1) 摘除
+
+public:
+    S3FifoNode(Key key, Value value, size_t hash)
+        : key_(key)
+        , value_(value)
+        , hash_(hash)
+        , freq_(0)
+        , inMain_(false)
+    {}
+
+    const Key& getKey() const { return key_; }
+    size_t getHash() const { return hash_; }
+    Value getValue() const { return value_; }
+    void setValue(const Value& value) { value_ = value; }
+
+    friend class KS3FifoCache<Key, Value>;
+};
+
+/**
+ * @brief S3-FIFO 淘汰策略
+ *
+ * 核心设计：
+ * 1. 三个 FIFO 队列：small(约 10% 容量) 接纳新数据，main(其余容量) 保存经过筛选的数据，
+ *    ghost 只记录从 small 淘汰的 key 的指纹，长度与 main 相同。
+ * 2. 新 key 进入 small；若其指纹在 ghost 中(不久前刚被淘汰过)，则直接进入 main。
+ * 3. small 淘汰时：队首节点在 small 期间被访问过则晋升到 main，否则淘汰并记入 ghost。
+ *    大量只访问一次的数据因此只在 small 中短暂停留，不会冲刷 main。
+ * 4. main 淘汰时：队首节点频次大于 0 则频次减一后重新插回队尾，否则淘汰。
+ * 5. 命中只修改频次，不做链表移动。
+ */
+template<typename Key, typename Value>
+class KS3FifoCache : public KICachePolicy<Key, Value>
+{
+public:
+    using NodeType = S3FifoNode<Key, Value>;
+    using NodePtr = std::shared_ptr<NodeType>;
+    using NodeList = std::list<NodePtr>;
+    using NodeMap = KHashIndex<Key, NodePtr>;
+
+    /**
+     * @brief 构造函数
+     *
+     * @param capacity 缓存总容量
+     * @param smallRatio small 队列占总容量的比例
+     */
+    explicit KS3FifoCache(int capacity, double smallRatio = 0.1)
+        : capacity_(capacity > 0 ? static_cast<size_t>(capacity) : 0)
+        , smallRatio_(smallRatio)
+        , smallCapacity_(std::max<size_t>(1, static_cast<size_t>(capacity_ * smallRatio)))
+        , mainCapacity_(capacity_ > smallCapacity_ ? capacity_ - smallCapacity_ : 1)
+        , ghost_(mainCapacity_)
+    {}
+
+    ~KS3FifoCache() override = default;
+
+    void put(Key key, Value value) override
+    {
+        put(key, value, KHashOf(key));
+    }
+
+    // 使用调用方预先算好的哈希值 要求 hash == KHashOf(key)
+    void put(const Key& key, const Value& value, size_t hash)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        NodePtr* node = nodeMap_.find(key, hash);
+        if (node)
+        {
+            (*node)->setValue(value);
+            touch(*node);
+            return;
+        }
+
+        if (capacity_ == 0)
+        {
+            trimLocked(this->kTrimBatch);
+            return;
+        }
+        // 缩容后超出容量的部分 每次写入最多多淘汰 kTrimBatch 个
+        trimLocked(this->kTrimBatch);
+        if (nodeMap_.size() >= capacity_)
+            evict();
+
+        NodePtr newNode = std::make_shared<NodeType>(key, value, hash);
+        if (ghost_.contains(hash))
+            pushMain(newNode); // 近期被淘汰过 说明不是一次性访问 直接进入 main
+        else
+            pushSmall(newNode);
+        nodeMap_.insert(hash, newNode);
+    }
+
+    bool get(Key key, Value& value) override
+    {
+        return get(key, value, KHashOf(key));
+    }
+
+    bool get(const Key& key, Value& value, size_t hash)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        NodePtr* node = nodeMap_.find(key, hash);
+        if (!node)
+            return false;
+        touch(*node);
+        value = (*node)->getValue();
+        return true;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 只更新已存在节点的值 不增加频次
+    bool updateIfPresent(Key key, Value value) override
+    {
+        size_t hash = KHashOf(key);
+        std::lock_guard<std::mutex> lock(mutex_);
+        NodePtr* node = nodeMap_.find(key, hash);
+        if (!node)
+            return false;
+        (*node)->setValue(value);
+        return true;
+    }
+
+    void remove(Key key)
+    {
+        remove(key, KHashOf(key));
+    }
+
+    void remove(const Key& key, size_t hash)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        NodePtr* node = nodeMap_.find(key, hash);
+        if (!node)
+            return;
+        NodePtr target = *node;
+        (target->inMain_ ? mainQueue_ : smallQueue_).erase(target->pos_);
+        nodeMap_.eraseNode(target);
+    }
+
+    // small / main / ghost 按构造时的比例重新划分
+    void setCapacity(size_t capacity) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capacity_ = capacity;
+        smallCapacity_ = std::max<size_t>(1, static_cast<size_t>(capacity_ * smallRatio_));
+        mainCapacity_ = capacity_ > smallCapacity_ ? capacity_ - smallCapacity_ : 1;
+        ghost_.resize(mainCapacity_);
+    }
+
+    size_t trim(size_t maxEvictions) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return trimLocked(maxEvictions);
+    }
+
+private:
+    size_t trimLocked(size_t maxEvictions)
+    {
+        while (maxEvictions-- > 0 && nodeMap_.size() > capacity_)
+            evict();
+        return nodeMap_.size() > capacity_ ? nodeMap_.size() - capacity_ : 0;
+    }
+
+    static void touch(const NodePtr& node)
+    {
+        if (node->freq_ < 3)
+            ++node->freq_;
+    }
+
+    // 队列头为最旧 队列尾为最新
+    void pushSmall(const NodePtr& node)
+    {
+        node->inMain_ = false;
+        node->pos_ = smallQueue_.insert(smallQueue_.end(), node);
+    }
+
+    void pushMain(const NodePtr& node)
+    {
+        node->inMain_ = true;
+        node->pos_ = mainQueue_.insert(mainQueue_.end(), node);
+    }
+
+    // 每次调用恰好淘汰一个节点
+    void evict()
+    {
+        if (smallQueue_.size() >= smallCapacity_ || mainQueue_.empty())
+            evictSmall();
+        else
+            evictMain();
+    }
+
+    void evictSmall()
+    {
+        while (!smallQueue_.empty())
+        {
+            NodePtr node = smallQueue_.front();
+            smallQueue_.pop_front();
+            if (node->freq_ > 0)
+            {
+                // 在 small 中被再次访问 晋升到 main 频次清零重新计数
+                node->freq_ = 0;
+                pushMain(node);
+                if (mainQueue_.size() > mainCapacity_)
+                {
+                    evictMain();
+                    return;
+                }
+            }
+            else
+            {
+                ghost_.insert(node->getHash());
+                removeEvicted(node);
+                return;
+            }
+        }
+        // small 中的节点全部晋升 由 main 完成本次淘汰
+        evictMain();
+    }
+
+    void evictMain()
+    {
+        while (!mainQueue_.empty())
+        {
+            NodePtr node = mainQueue_.front();
+            mainQueue_.pop_front();
+            if (node->freq_ > 0)
+            {
+                --node->freq_;
+                pushMain(node);
+            }
+            else
+            {
+                removeEvicted(node);
+                return;
+            }
+        }
+    }
+
+    void removeEvicted(const NodePtr& node)
+    {
+        nodeMap_.eraseNode(node);
+        this->onEvict(node->getKey(), node->getValue());
+    }
+
+private:
+    size_t     capacity_;      // 缓存总容量
+    double     smallRatio_;    // small 队列占总容量的比例
+    size_t     smallCapacity_; // small 队列容量
+    size_t     mainCapacity_;  // main 队列容量
+    NodeList   smallQueue_;    // 新数据的 FIFO 队列
+    NodeList   mainQueue_;     // 经过筛选的数据的 FIFO 队列
+    KGhostFifo ghost_;         // 从 small 淘汰的 key 的指纹
+    NodeMap    nodeMap_;       // key -> 节点 的索引
+    std::mutex mutex_;         // 互斥锁，保证线程安全
+};
+
+// S3-FIFO 的分片版本
+template<typename Key, typename Value>
+using KHashS3FifoCache = KShardedCache<Key, Value, KS3FifoCache<Key, Value>>;
+
+} // namespace KamaCache
@@ -0,0 +1,645 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include "KEpoch/KEpochDomain.h"
+#include "KHashIndex.h"
+#include "KHeavyHitters.h"
+
+namespace KamaCache
+{
+
+/**
+ * @brief 当前进程实际可用的 CPU 数
+ *
+ * hardware_concurrency() 返回的是整台机器的核数，容器里只分到 4 个 CPU 的进程在 128 核宿主机上也会得到 128。
+ * Linux 上取 CPU 亲和性掩码中的核数，再与 cgroup 的 CPU 配额(cpu.max / cpu.cfs_quota_us)取较小值。
+ * 结果在第一次调用时计算并缓存。
+ */
+inline int KAvailableCpus()
+{
+    static const int cpus = [] {
+        int count = static_cast<int>(std::thread::hardware_concurrency());
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0 && CPU_COUNT(&set) > 0)
+            count = CPU_COUNT(&set);
+        // 配额 / 周期 向上取整 "max" 表示不限制
+        double quota = -1, period = 0;
+        std::ifstream v2("/sys/fs/cgroup/cpu.max");
+        std::string max;
+        if (v2 >> max >> period && max != "max")
+            quota = std::stod(max);
+        if (quota < 0)
+        {
+            std::ifstream q("/sys/fs/cgroup/cpu/cpu.cfs_quota_us");
+            std::ifstream p("/sys/fs/cgroup/cpu/cpu.cfs_period_us");
+            if (!(q >> quota && p >> period))
+                quota = -1;
+        }
+        if (quota > 0 && period > 0)
+            count = std::min(count, std::max(1, static_cast<int>(std::ceil(quota / period))));
+#endif
+        return count > 0 ? count : 1;
+    }();
+    return cpus;
+}
+
+// 自动调整分片数的参数
+struct KReshardOptions
+{
+    int      minSlices = 1;          // 分片数下限
+    int      maxSlices = 0;          // 分片数上限 0 表示可用 CPU 数的 4 倍
+    double   growAbove = 0.02;       // 冲突率高于该值时分片数翻倍
+    double   shrinkBelow = 0.0005;   // 冲突率低于该值时分片数减半
+    uint32_t checkEvery = 4096;      // 每个分片每隔多少次访问尝试评估一次
+    uint64_t minSamples = 65536;     // 一次评估至少需要累计的访问次数
+};
+
+// 分片数与迁移的统计
+struct KReshardStats
+{
+    int      sliceNum = 0;        // 当前分片数
+    bool     migrating = false;   // 是否有迁移在进行
+    uint64_t reshards = 0;        // 累计开始的重新分片次数
+    uint64_t migrated = 0;        // 累计从旧分片迁入新分片的条目数
+    double   contention = 0;      // 最近一次评估的冲突率(自动调整开启时)
+};
+
+// SliceCache 是否提供 remove(key, hash)：重新分片时写入需要先删除旧分片中的副本
+template<typename SliceCache, typename Key, typename = void>
+struct KHasHashedRemove : std::false_type
+{};
+
+template<typename SliceCache, typename Key>
+struct KHasHashedRemove<SliceCache, Key,
+                        std::void_t<decltype(std::declval<SliceCache&>().remove(std::declval<const Key&>(), size_t()))>>
+    : std::true_type
+{};
+
+/**
+ * @brief 通用的哈希分片缓存
+ *
+ * 把总容量平均分给 sliceNum 个独立的分片(每个分片有自己的锁)，key 按哈希值路由到分片，
+ * 以降低高并发下的锁竞争。KHashLruCaches / KHashLfuCache / KHashSieveCache / KHashS3FifoCache 都基于它实现。
+ *
+ * SliceCache 需要提供构造函数 SliceCache(sliceCapacity, extraArgs...)、setCapacity / trim，
+ * 以及带预计算哈希的 put(key, value, hash) / get(key, value, hash)：
+ * 哈希值在这里只计算一次，同时用于分片路由和分片内部的索引查找。
+ *
+ * 分片数可以在运行期调整(setSliceNum，或 enableAutoResharding 按锁冲突率自动调整)，要求 SliceCache 还提供 remove(key, hash)：
+ * 1. 分片数组与分片数组成一个布局，调整时构造一组新分片，原子地切换当前布局，旧布局进入迁移状态。
+ * 2. 旧分片容量置 0，之后每次读写顺带对 key 所在的旧分片 trim 几个条目，被淘汰的条目由淘汰回调写入新布局，
+ *    读写都不会停顿；维护线程调用的 trim 也会推进迁移。旧分片全部迁空后交给 KEpochDomain 退役。
+ * 3. 迁移期间读取先查新分片再查旧分片；写入先删除旧分片中的副本再写入新分片，
+ *    迁移在旧分片的锁内完成，因此新分片中不会留下比旧分片更旧的值。
+ *    写入期间布局恰好切换时，这次写入可能落在正在迁空的旧分片上，此时删除该 key 在各布局中的副本，之后的读取只会未命中。
+ * 4. 构造时的初始布局迁空后不退役，保留到析构。读写读到的都是初始布局时不进入纪元临界区，
+ *    从未调整过分片数的缓存(包括不支持调整的分片类型)每次读写没有额外开销；第一次调整之后才需要纪元保护。
+ * 分片只能按淘汰顺序交出条目，不能按哈希区间挑出一部分，所以一致性哈希也省不掉迁移量：所有条目都迁入新的分片对象，
+ * 路由仍是 hash % sliceNum。
+ */
+template<typename Key, typename Value, typename SliceCache>
+class KShardedCache
+{
+protected:
+    // 是否支持运行期调整分片数
+    static constexpr bool kReshardable = KHasHashedRemove<SliceCache, Key>::value;
+
+private:
+    // 每次读写顺带迁移的条目数上限
+    static constexpr size_t kMigrateBatch = 4;
+
+    // 每个分片的访问与冲突计数 独占缓存行 只在开启自动调整时更新
+    struct alignas(64) SliceLoad
+    {
+        std::atomic<uint32_t> active{0};     // 正在访问该分片的线程数
+        std::atomic<uint64_t> ops{0};        // 累计访问次数
+        std::atomic<uint64_t> collisions{0}; // 访问时已有其他线程在访问该分片的次数
+    };
+
+    // 一组分片 切换后只读 退役前不会释放
+    struct Layout
+    {
+        explicit Layout(int n)
+            : sliceNum(n)
+            , loads(new SliceLoad[n])
+            , drained(new std::atomic<bool>[n]())
+            , drainedCount(0)
+        {}
+
+        SliceCache& slice(size_t hash) { return *slices[hash % sliceNum]; }
+
+        int                                      sliceNum;
+        std::vector<std::unique_ptr<SliceCache>> slices;
+        std::unique_ptr<SliceLoad[]>             loads;
+        std::unique_ptr<std::atomic<bool>[]>     drained;      // 迁移时该分片已迁空
+        std::atomic<int>                         drainedCount; // 已迁空的分片数
+    };
+
+    // 读写路径上的纪元保护 只在读到可能被退役的布局时才进入临界区
+    using LayoutGuard = std::optional<KEpochGuard>;
+
+    // 开启自动调整时记录一次分片访问 析构时离开 该分片的访问次数每到 checkEvery 的倍数时 due 为 true
+    class SliceProbe
+    {
+    public:
+        SliceProbe(Layout* layout, size_t hash, bool enabled, uint32_t checkEvery)
+            : load_(enabled ? &layout->loads[hash % layout->sliceNum] : nullptr)
+            , due_(false)
+        {
+            if (!load_)
+                return;
+            if (load_->active.fetch_add(1, std::memory_order_relaxed) > 0)
+                load_->collisions.fetch_add(1, std::memory_order_relaxed);
+            uint64_t ops = load_->ops.fetch_add(1, std::memory_order_relaxed) + 1;
+            due_ = ops % std::max<uint32_t>(checkEvery, 1) == 0;
+        }
+
+        ~SliceProbe()
+        {
+            if (load_)
+                load_->active.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        SliceProbe(const SliceProbe&) = delete;
+        SliceProbe& operator=(const SliceProbe&) = delete;
+
+        bool due() const { return due_; }
+
+    private:
+        SliceLoad* load_;
+        bool       due_;
+    };
+
+public:
+    /**
+     * @brief 构造函数
+     *
+     * @param capacity 缓存总容量
+     * @param sliceNum 分片数量 小于等于 0 时使用可用 CPU 数(KAvailableCpus)
+     * @param sliceArgs 透传给每个分片构造函数的额外参数 重新分片时用于构造新分片
+     */
+    template<typename... SliceArgs>
+    KShardedCache(size_t capacity, int sliceNum, SliceArgs&&... sliceArgs)
+        : capacity_(capacity)
+        , makeSlice_([args = std::make_tuple(std::decay_t<SliceArgs>(sliceArgs)...)](size_t sliceSize) {
+            return std::apply([sliceSize](const auto&... a) { return new SliceCache(sliceSize, a...); }, args);
+        })
+        , initialLayout_(nullptr)
+        , layout_(nullptr)
+        , draining_(nullptr)
+        , autoReshard_(false)
+        , hotKeyLanes_(1)
+        , reshards_(0)
+        , migrated_(0)
+        , reclaimPending_(false)
+        , evaluatedLayout_(nullptr)
+        , evaluatedOps_(0)
+        , evaluatedCollisions_(0)
+        , contention_(0)
+    {
+        initialLayout_ = makeLayout(sliceNum > 0 ? sliceNum : KAvailableCpus());
+        layout_.store(initialLayout_, std::memory_order_release);
+    }
+
+    ~KShardedCache()
+    {
+        // 析构时不能再有并发访问
+        Layout* layout = layout_.load(std::memory_order_relaxed);
+        Layout* draining = draining_.load(std::memory_order_relaxed);
+        if (initialLayout_ != layout && initialLayout_ != draining)
+            delete initialLayout_;
+        delete draining;
+        delete layout;
+    }
+
+    KShardedCache(const KShardedCache&) = delete;
+    KShardedCache& operator=(const KShardedCache&) = delete;
+
+    void put(Key key, Value value)
+    {
+        // 获取key的hash值 哈希值同时用于分片路由与分片内部的索引
+        size_t hash = KHashOf(key);
+        if (hotKeys_)
+            hotKeys_->record(hotKeyLane(hash), key, hash);
+        // value 是按值传入的副本 直接移动给分片 接受右值的分片不会再拷贝一次
+        putHashed(key, std::move(value), hash);
+    }
+
+    bool get(Key key, Value& value)
+    {
+        size_t hash = KHashOf(key);
+        if (hotKeys_)
+            hotKeys_->record(hotKeyLane(hash), key, hash);
+        return getHashed(key, value, hash);
+    }
+
+    Value get(Key key)
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    int sliceNum() const
+    {
+        LayoutGuard guard;
+        return protect(layout_, guard)->sliceNum;
+    }
+
+    /**
+     * @brief 运行期调整总容量 与构造时一样平均分给各分片(向上取整)
+     *
+     * 缩容时各分片不立即淘汰，超出部分由之后的写入分批淘汰，或通过 trim / KMaintenanceThread 回收。
+     * 可以与读写以及分片数的调整并发调用。
+     */
+    void setCapacity(size_t capacity)
+    {
+        std::lock_guard<std::mutex> lock(reshardMutex_);
+        capacity_ = capacity;
+        // 持有 reshardMutex_ 时当前布局不会被替换
+        Layout* layout = layout_.load(std::memory_order_acquire);
+        for (auto& slice : layout->slices)
+            slice->setCapacity(sliceSizeFor(layout->sliceNum));
+    }
+
+    /**
+     * @brief 依次在每个分片上回收 每个分片最多淘汰 maxEvictions / sliceNum 个(maxEvictions 非 0 时至少 1 个)
+     *
+     * 有迁移在进行时也对每个旧分片迁移同样多的条目。返回各分片仍超出容量的条目数与旧分片中尚未迁移的条目数之和，
+     * 因此 KMaintenanceThread 会一直工作到迁移完成。trim(0) 不淘汰也不迁移，只返回这个数量。
+     */
+    size_t trim(size_t maxEvictions)
+    {
+        size_t remaining = 0;
+        {
+            LayoutGuard guard;
+            Layout* layout = protect(layout_, guard);
+            size_t perSlice = perSliceBudget(maxEvictions, layout->sliceNum);
+            for (auto& slice : layout->slices)
+                remaining += slice->trim(perSlice);
+            if constexpr (kReshardable)
+            {
+                if (Layout* old = protect(draining_, guard))
+                {
+                    perSlice = perSliceBudget(maxEvictions, old->sliceNum);
+                    for (int i = 0; i < old->sliceNum; ++i)
+                        remaining += drainSlice(*old, static_cast<size_t>(i), perSlice);
+                }
+            }
+        }
+        reclaimRetired();
+        return remaining;
+    }
+
+    /**
+     * @brief 开始把分片数调整为 sliceNum 立即返回 条目随之后的读写逐步迁移
+     *
+     * 已有迁移在进行或分片数不变时返回 false。SliceCache 没有 remove(key, hash) 时不能调用。
+     */
+    bool setSliceNum(int sliceNum)
+    {
+        static_assert(kReshardable, "调整分片数需要 SliceCache 提供 remove(key, hash)");
+        bool started;
+        {
+            std::lock_guard<std::mutex> lock(reshardMutex_);
+            started = beginReshardLocked(sliceNum > 0 ? sliceNum : KAvailableCpus());
+        }
+        reclaimRetired();
+        return started;
+    }
+
+    // 是否有迁移在进行
+    bool resharding() const { return draining_.load(std::memory_order_acquire) != nullptr; }
+
+    /**
+     * @brief 开启按锁冲突率自动调整分片数 需要在并发访问开始前调用
+     *
+     * 开启后每次访问在所在分片的计数上多做两次原子加减：进入时已有其他线程在访问同一分片记为一次冲突。
+     * 每个分片每 checkEvery 次访问尝试评估一次(沿用分片的访问计数 不另设计数器)，窗口内冲突率高于 growAbove 时分片数翻倍，
+     * 低于 shrinkBelow 时减半，迁移进行期间不评估。冲突率只是锁等待的近似，共享锁的分片上并发读也会计入。
+     */
+    void enableAutoResharding(const KReshardOptions& options = KReshardOptions())
+    {
+        static_assert(kReshardable, "调整分片数需要 SliceCache 提供 remove(key, hash)");
+        reshardOptions_ = options;
+        reshardOptions_.minSlices = std::max(1, options.minSlices);
+        if (reshardOptions_.maxSlices <= 0)
+            reshardOptions_.maxSlices = 4 * KAvailableCpus();
+        reshardOptions_.maxSlices = std::max(reshardOptions_.maxSlices, reshardOptions_.minSlices);
+        autoReshard_ = true;
+    }
+
+    KReshardStats reshardStats()
+    {
+        std::lock_guard<std::mutex> lock(reshardMutex_);
+        KReshardStats stats;
+        stats.sliceNum = layout_.load(std::memory_order_acquire)->sliceNum;
+        stats.migrating = draining_.load(std::memory_order_acquire) != nullptr;
+        stats.reshards = reshards_;
+        stats.migrated = migrated_.load(std::memory_order_relaxed);
+        stats.contention = contention_;
+        return stats;
+    }
+
+    /**
+     * @brief 开启热点 key 跟踪 需要在并发访问开始前调用
+     *
+     * 跟踪器的分区数固定为开启时的分片数，之后调整分片数时 key 仍按 hash % 分区数记录。
+     *
+     * @param counters 每个分片的计数器数量
+     * @param sampleEvery 每个线程每隔多少次访问采样一次
+     */
+    void enableHotKeyTracking(size_t counters = 64, uint32_t sampleEvery = 16)
+    {
+        hotKeyLanes_ = sliceNum();
+        hotKeys_.reset(new KHotKeyTracker<Key>(hotKeyLanes_, counters, sampleEvery));
+    }
+
+    // 访问最多的 k 个 key(合并所有分片) 未开启跟踪时返回空
+    std::vector<KHotKey<Key>> hotKeys(size_t k)
+    {
+        return hotKeys_ ? hotKeys_->top(k) : std::vector<KHotKey<Key>>();
+    }
+
+    // 未开启跟踪时返回 nullptr
+    KHotKeyTracker<Key>* hotKeyTracker() { return hotKeys_.get(); }
+
+protected:
+    int hotKeyLane(size_t hash) const { return static_cast<int>(hash % hotKeyLanes_); }
+
+    // 按预计算的哈希写入当前布局 迁移期间先删除旧分片中的副本
+    void putHashed(const Key& key, Value value, size_t hash)
+    {
+        bool due = false;
+        {
+            LayoutGuard guard;
+            Layout* layout = protect(layout_, guard);
+            Layout* old = nullptr;
+            if constexpr (kReshardable)
+            {
+                old = protect(draining_, guard);
+                if (old)
+                    old->slice(hash).remove(key, hash);
+            }
+            {
+                SliceProbe probe(layout, hash, autoReshard_, reshardOptions_.checkEvery);
+                layout->slice(hash).put(key, std::move(value), hash);
+                due = probe.due();
+            }
+            if constexpr (kReshardable)
+            {
+                // 写入期间布局已切换：值可能落在正在迁空的旧分片上被丢弃，而新分片中还留着更旧的值
+                if (layout_.load(std::memory_order_acquire) != layout)
+                    invalidate(key, hash, guard);
+                if (old)
+                    drainSlice(*old, hash % old->sliceNum, kMigrateBatch);
+            }
+        }
+        if (due)
+            maybeAutoReshard();
+    }
+
+    // 按预计算的哈希读取 迁移期间新分片未命中时再查旧分片
+    bool getHashed(const Key& key, Value& value, size_t hash)
+    {
+        bool hit;
+        bool due = false;
+        {
+            LayoutGuard guard;
+            Layout* layout = protect(layout_, guard);
+            {
+                SliceProbe probe(layout, hash, autoReshard_, reshardOptions_.checkEvery);
+                hit = layout->slice(hash).get(key, value, hash);
+                due = probe.due();
+            }
+            if constexpr (kReshardable)
+            {
+                if (Layout* old = protect(draining_, guard))
+                {
+                    if (!hit && old != layout)
+                        hit = old->slice(hash).get(key, value, hash);
+                    drainSlice(*old, hash % old->sliceNum, kMigrateBatch);
+                }
+            }
+        }
+        if (due)
+            maybeAutoReshard();
+        return hit;
+    }
+
+    // 对当前布局与迁移中的旧布局的每个分片调用 f 用于汇总统计等
+    template<typename F>
+    void forEachSlice(F&& f)
+    {
+        LayoutGuard guard;
+        for (auto& slice : protect(layout_, guard)->slices)
+            f(*slice);
+        if (Layout* old = protect(draining_, guard))
+        {
+            for (auto& slice : old->slices)
+                f(*slice);
+        }
+    }
+
+private:
+    /**
+     * @brief 读取布局指针 读到的不是初始布局时先进入纪元临界区再重新读取
+     *
+     * 初始布局保留到析构，不在临界区内也可以直接访问；其他布局可能已经退役，
+     * 临界区外读到的指针只用于比较，进入临界区后重新读取的指针在离开临界区前不会被释放。
+     */
+    Layout* protect(const std::atomic<Layout*>& source, LayoutGuard& guard) const
+    {
+        Layout* layout = source.load(std::memory_order_acquire);
+        if constexpr (kReshardable)
+        {
+            if (!guard && layout && layout != initialLayout_)
+            {
+                guard.emplace();
+                layout = source.load(std::memory_order_acquire);
+            }
+        }
+        return layout;
+    }
+
+    size_t sliceSizeFor(int sliceNum) const
+    {
+        // 获取每个分片的大小 向上取整
+        return static_cast<size_t>(std::ceil(capacity_ / static_cast<double>(sliceNum)));
+    }
+
+    Layout* makeLayout(int sliceNum)
+    {
+        Layout* layout = new Layout(sliceNum);
+        for (int i = 0; i < sliceNum; ++i)
+        {
+            layout->slices.emplace_back(makeSlice_(sliceSizeFor(sliceNum)));
+            if constexpr (kReshardable)
+            {
+                // 回调在分片发布前注册 之后不再修改；布局不在迁移时回调只读一次原子变量
+                layout->slices.back()->setEvictCallback([this, layout](const Key& key, const Value& value) {
+                    migrateEvicted(layout, key, value);
+                });
+            }
+        }
+        return layout;
+    }
+
+    // 持有 reshardMutex_
+    bool beginReshardLocked(int sliceNum)
+    {
+        Layout* current = layout_.load(std::memory_order_relaxed);
+        if (draining_.load(std::memory_order_relaxed) || sliceNum == current->sliceNum)
+            return false;
+        Layout* next = makeLayout(sliceNum);
+        // 先发布旧布局再切换：读到新布局的线程一定也能读到正在迁移的旧布局
+        draining_.store(current, std::memory_order_seq_cst);
+        layout_.store(next, std::memory_order_seq_cst);
+        // 容量置 0 后旧分片不再接受写入 trim 会把条目逐个交给淘汰回调
+        for (auto& slice : current->slices)
+            slice->setCapacity(0);
+        ++reshards_;
+        return true;
+    }
+
+    // 旧分片淘汰条目时的回调 在旧分片的锁内执行 迁移期间把条目写入新布局
+    void migrateEvicted(Layout* owner, const Key& key, const Value& value)
+    {
+        if (draining_.load(std::memory_order_acquire) != owner)
+            return;
+        size_t hash = KHashOf(key);
+        // 调用方可能持有的只是初始布局 不一定在临界区内
+        LayoutGuard guard;
+        protect(layout_, guard)->slice(hash).put(key, value, hash);
+        migrated_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 把 trim 的总数平均分给各分片 总数为 0 时每个分片也是 0
+    static size_t perSliceBudget(size_t maxEvictions, int sliceNum)
+    {
+        return maxEvictions == 0 ? 0 : std::max<size_t>(1, maxEvictions / sliceNum);
+    }
+
+    // 从旧布局的第 index 个分片迁移最多 batch 个条目 返回其中剩余的条目数 全部迁空后结束迁移
+    size_t drainSlice(Layout& old, size_t index, size_t batch)
+    {
+        if (old.drained[index].load(std::memory_order_acquire))
+            return 0;
+        size_t remaining = old.slices[index]->trim(batch);
+        if (remaining > 0 || old.drained[index].exchange(true, std::memory_order_acq_rel))
+            return remaining;
+        if (old.drainedCount.fetch_add(1, std::memory_order_acq_rel) + 1 == old.sliceNum)
+            finishMigration(&old);
+        return 0;
+    }
+
+    void finishMigration(Layout* old)
+    {
+        std::lock_guard<std::mutex> lock(reshardMutex_);
+        if (draining_.load(std::memory_order_relaxed) != old)
+            return;
+        draining_.store(nullptr, std::memory_order_seq_cst);
+        // 初始布局可能正被临界区外的读写访问 保留到析构
+        if (old == initialLayout_)
+            return;
+        // 仍可能有线程在读旧布局 由纪元回收在它们离开后释放
+        KEpochDomain::global().retire(old);
+        reclaimPending_.store(true, std::memory_order_relaxed);
+    }
+
+    // 删除 key 在当前布局与迁移中的旧布局里的副本
+    void invalidate(const Key& key, size_t hash, LayoutGuard& guard)
+    {
+        if constexpr (kReshardable)
+        {
+            if (Layout* old = protect(draining_, guard))
+                old->slice(hash).remove(key, hash);
+            protect(layout_, guard)->slice(hash).remove(key, hash);
+        }
+    }
+
+    // 退役的旧布局在纪元临界区外才能被回收 由 trim / setSliceNum 顺带调用
+    void reclaimRetired()
+    {
+        if constexpr (kReshardable)
+        {
+            if (reclaimPending_.exchange(false, std::memory_order_relaxed))
+                KEpochDomain::global().reclaim();
+        }
+    }
+
+    // 由分片访问次数到达 checkEvery 倍数的那次访问调用
+    void maybeAutoReshard()
+    {
+        std::unique_lock<std::mutex> lock(reshardMutex_, std::try_to_lock);
+        if (!lock.owns_lock() || draining_.load(std::memory_order_relaxed))
+            return;
+        Layout* layout = layout_.load(std::memory_order_relaxed);
+        uint64_t ops = 0, collisions = 0;
+        for (int i = 0; i < layout->sliceNum; ++i)
+        {
+            ops += layout->loads[i].ops.load(std::memory_order_relaxed);
+            collisions += layout->loads[i].collisions.load(std::memory_order_relaxed);
+        }
+        // 布局切换后计数从 0 开始
+        if (evaluatedLayout_ != layout)
+        {
+            evaluatedLayout_ = layout;
+            evaluatedOps_ = 0;
+            evaluatedCollisions_ = 0;
+        }
+        if (ops - evaluatedOps_ < reshardOptions_.minSamples)
+            return;
+        contention_ = static_cast<double>(collisions - evaluatedCollisions_) / (ops - evaluatedOps_);
+        evaluatedOps_ = ops;
+        evaluatedCollisions_ = collisions;
+        if (contention_ > reshardOptions_.growAbove && layout->sliceNum < reshardOptions_.maxSlices)
+            beginReshardLocked(std::min(layout->sliceNum * 2, reshardOptions_.maxSlices));
+        else if (contention_ < reshardOptions_.shrinkBelow && layout->sliceNum > reshardOptions_.minSlices)
+            beginReshardLocked(std::max(layout->sliceNum / 2, reshardOptions_.minSlices));
+    }
+
+protected:
+    size_t                                   capacity_;    // 总容量 受 reshardMutex_ 保护
+    std::unique_ptr<KHotKeyTracker<Key>>     hotKeys_;     // 热点 key 跟踪 为空表示未开启
+
+private:
+    std::function<SliceCache*(size_t)>       makeSlice_;       // 按分片容量构造分片 保存了构造时的额外参数
+    Layout*                                  initialLayout_;   // 构造时的布局 保留到析构
+    std::atomic<Layout*>                     layout_;          // 当前布局
+    std::atomic<Layout*>                     draining_;        // 正在迁空的旧布局 没有迁移时为空
+    std::mutex                               reshardMutex_;    // 串行化布局切换、容量调整与自动评估
+    bool                                     autoReshard_;     // 是否按冲突率自动调整
+    KReshardOptions                          reshardOptions_;
+    int                                      hotKeyLanes_;     // 热点跟踪器的分区数
+    uint64_t                                 reshards_;        // 受 reshardMutex_ 保护
+    std::atomic<uint64_t>                    migrated_;
+    std::atomic<bool>                        reclaimPending_;  // 有退役的布局等待回收
+    Layout*                                  evaluatedLayout_; // 以下为自动评估的窗口 受 reshardMutex_ 保护
+    uint64_t                                 evaluatedOps_;
+    uint64_t                                 evaluatedCollisions_;
+    double                                   contention_;
+};
+
+} // namespace KamaCache
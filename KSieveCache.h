@@ -0,0 +1,251 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+
+#include "KHashIndex.h"
+#include "KICachePolicy.h"
+#include "KShardedCache.h"
+
+namespace KamaCache
+{
+
+template<typename Key, typename Value> class KSieveCache;
+
+/**
+ * @brief SIEVE 缓存的 FIFO 队列节点
+ * visited_ 是原子变量：命中时只需在共享锁下把它置为 true，不移动节点。
+ */
+template<typename Key, typename Value>
+class SieveNode
+{
+private:
+    Key key_;
+    Value value_;
+    size_t hash_;                     // key 的哈希值 淘汰时直接用它删除索引
+    std::atomic<bool> visited_;       // 访问位 由命中置位 由指针(hand)扫描时清除
+    std::weak_ptr<SieveNode> prev_;   // 更旧的节点 weak_ptr 打破循环引用
+    std::shared_ptr<SieveNode> next_; // 更新的节点
+
+public:
+    SieveNode() : hash_(0), visited_(false) {}
+
+    SieveNode(Key key, Value value, size_t hash)
+        : key_(key)
+        , value_(value)
+        , hash_(hash)
+        , visited_(false)
+    {}
+
+    const Key& getKey() const { return key_; }
+    size_t getHash() const { return hash_; }
+    Value getValue() const { return value_; }
+    void setValue(const Value& value) { value_ = value; }
+
+    friend class KSieveCache<Key, Value>;
+};
+
+/**
+ * @brief SIEVE 淘汰策略
+ *
+ * 核心设计：
+ * 1. 所有条目按插入顺序组成一个 FIFO 队列，命中时只设置访问位，不做任何链表移动。
+ * 2. 淘汰时，指针 hand 从上次停下的位置开始由旧向新扫描：
+ *    访问位为 true 的节点清零后保留(相当于"再给一次机会")，遇到第一个访问位为 false 的节点就淘汰它。
+ *    hand 到达最新端后回到最旧端继续。
+ * 3. 与 CLOCK 不同，被保留的节点不会移动到队首，新节点总在队尾，这使得一次性访问的数据很快被淘汰。
+ * 4. 命中路径只修改原子访问位，因此 get 只需要共享锁，多个读者可以并发命中；
+ *    只有 put 与未命中后的淘汰需要独占锁。
+ */
+template<typename Key, typename Value>
+class KSieveCache : public KICachePolicy<Key, Value>
+{
+public:
+    using NodeType = SieveNode<Key, Value>;
+    using NodePtr = std::shared_ptr<NodeType>;
+    using NodeMap = KHashIndex<Key, NodePtr>;
+
+    explicit KSieveCache(int capacity)
+        : capacity_(capacity)
+    {
+        dummyHead_ = std::make_shared<NodeType>();
+        dummyTail_ = std::make_shared<NodeType>();
+        dummyHead_->next_ = dummyTail_;
+        dummyTail_->prev_ = dummyHead_;
+    }
+
+    ~KSieveCache() override = default;
+
+    void put(Key key, Value value) override
+    {
+        put(key, value, KHashOf(key));
+    }
+
+    // 使用调用方预先算好的哈希值 要求 hash == KHashOf(key)
+    void put(const Key& key, const Value& value, size_t hash)
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        NodePtr* node = nodeMap_.find(key, hash);
+        if (node)
+        {
+            // 更新视为一次访问 同样只设置访问位
+            (*node)->setValue(value);
+            (*node)->visited_.store(true, std::memory_order_relaxed);
+            return;
+        }
+
+        if (capacity_ <= 0)
+        {
+            trimLocked(this->kTrimBatch);
+            return;
+        }
+        // 缩容后超出容量的部分 每次写入最多多淘汰 kTrimBatch 个
+        trimLocked(this->kTrimBatch);
+        if (nodeMap_.size() >= static_cast<size_t>(capacity_))
+            evict();
+
+        NodePtr newNode = std::make_shared<NodeType>(key, value, hash);
+        insertNewest(newNode);
+        nodeMap_.insert(hash, newNode);
+    }
+
+    bool get(Key key, Value& value) override
+    {
+        return get(key, value, KHashOf(key));
+    }
+
+    // 命中只需共享锁：查找索引、设置原子访问位、拷贝数据 均不修改结构
+    bool get(const Key& key, Value& value, size_t hash)
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        const NodeMap& index = nodeMap_;
+        const NodePtr* node = index.find(key, hash);
+        if (!node)
+            return false;
+        // 已经置位时不再写 避免多个读者反复写同一缓存行
+        if (!(*node)->visited_.load(std::memory_order_relaxed))
+            (*node)->visited_.store(true, std::memory_order_relaxed);
+        value = (*node)->getValue();
+        return true;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 只更新已存在节点的值 不设置访问位
+    bool updateIfPresent(Key key, Value value) override
+    {
+        size_t hash = KHashOf(key);
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        NodePtr* node = nodeMap_.find(key, hash);
+        if (!node)
+            return false;
+        (*node)->setValue(value);
+        return true;
+    }
+
+    void remove(Key key)
+    {
+        remove(key, KHashOf(key));
+    }
+
+    void remove(const Key& key, size_t hash)
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        NodePtr* node = nodeMap_.find(key, hash);
+        if (!node)
+            return;
+        NodePtr target = *node;
+        if (hand_ == target)
+            hand_ = target->next_; // 指针跳过被删除的节点
+        unlink(target);
+        nodeMap_.erase(key, hash);
+    }
+
+    void setCapacity(size_t capacity) override
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        capacity_ = static_cast<int>(capacity);
+    }
+
+    size_t trim(size_t maxEvictions) override
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        return trimLocked(maxEvictions);
+    }
+
+private:
+    size_t trimLocked(size_t maxEvictions)
+    {
+        size_t capacity = capacity_ > 0 ? static_cast<size_t>(capacity_) : 0;
+        while (maxEvictions-- > 0 && nodeMap_.size() > capacity)
+            evict();
+        return nodeMap_.size() > capacity ? nodeMap_.size() - capacity : 0;
+    }
+
+    // 新节点插入队尾(最新端) 最旧的节点在 dummyHead_ 之后
+    void insertNewest(NodePtr node)
+    {
+        node->next_ = dummyTail_;
+        node->prev_ = dummyTail_->prev_;
+        dummyTail_->prev_.lock()->next_ = node;
+        dummyTail_->prev_ = node;
+    }
+
+    void unlink(NodePtr node)
+    {
+        if (!node->prev_.expired() && node->next_)
+        {
+            auto prev = node->prev_.lock();
+            prev->next_ = node->next_;
+            node->next_->prev_ = prev;
+            node->next_ = nullptr;
+        }
+    }
+
+    /**
+     * @brief SIEVE 淘汰：hand 由旧向新扫描 清除访问位 淘汰第一个未被访问的节点
+     * 最坏情况下扫描一整圈后所有访问位都被清零 因此一定能找到淘汰对象
+     */
+    void evict()
+    {
+        NodePtr node = hand_ ? hand_ : dummyHead_->next_;
+        while (true)
+        {
+            if (node == dummyTail_)
+            {
+                node = dummyHead_->next_; // 到达最新端 回到最旧端
+                continue;
+            }
+            if (!node->visited_.load(std::memory_order_relaxed))
+                break;
+            node->visited_.store(false, std::memory_order_relaxed);
+            node = node->next_;
+        }
+
+        hand_ = node->next_ == dummyTail_ ? nullptr : node->next_; // 下次从被淘汰节点的后继继续
+        unlink(node);
+        nodeMap_.eraseNode(node);
+        this->onEvict(node->getKey(), node->getValue());
+    }
+
+private:
+    int               capacity_;  // 缓存最大容量
+    NodeMap           nodeMap_;   // key -> 节点 的索引
+    std::shared_mutex mutex_;     // 读写锁 命中走共享锁 修改结构走独占锁
+    NodePtr           dummyHead_; // 虚拟头结点 其后为最旧的节点
+    NodePtr           dummyTail_; // 虚拟尾结点 其前为最新的节点
+    NodePtr           hand_;      // 淘汰指针 为空表示从最旧端开始
+};
+
+// SIEVE 的分片版本：命中只需分片内的共享锁 分片间互不影响
+template<typename Key, typename Value>
+using KHashSieveCache = KShardedCache<Key, Value, KSieveCache<Key, Value>>;
+
+} // namespace KamaCache
@@ -0,0 +1,335 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "../KHugePage.h"
+
+namespace KamaCache
+{
+
+// slab 分配器参数
+struct KSlabOptions
+{
+    size_t pageSize = 1 << 20;  // 每个 slab 页的字节数 也是可分配的最大块
+    size_t minChunkSize = 64;   // 最小尺寸等级的块大小(含块头)
+    double growthFactor = 1.25; // 相邻尺寸等级的块大小之比
+    KHugePageMode hugePages = KHugePageMode::Off; // 不为 Off 时 slab 页从大页内存池分配
+};
+
+// 单个尺寸等级的统计
+struct KSlabClassStats
+{
+    size_t   chunkSize = 0;  // 块大小(含块头)
+    size_t   pages = 0;      // 分给该等级的页数
+    size_t   chunksUsed = 0; // 已分配的块
+    size_t   chunksFree = 0; // 空闲链表中的块
+};
+
+/**
+ * @brief memcached 风格的 slab 分配器
+ *
+ * 内存按固定大小的页向系统申请，每页整页分给一个尺寸等级，切成等大的块。
+ * 尺寸等级按 growthFactor 几何增长，请求落到能容纳它的最小等级，块内剩余部分是内部碎片，
+ * 但不同大小的对象不会混在同一页里，长时间运行后不会出现 malloc 那样的外部碎片。
+ * 总页数不超过 memoryLimit / pageSize；上限调低后由调用方通过 releasePage 逐页归还，空出的页编号留给之后的新页复用。
+ *
+ * 每个块前有 8 字节的块头，记录所在页与使用状态，因此 free 不需要调用方给出尺寸等级，
+ * movePage 也可以遍历一页中仍在使用的块。不是线程安全的：每个分片持有自己的分配器，由分片的锁保护。
+ */
+class KSlabAllocator
+{
+private:
+    struct ChunkHeader
+    {
+        uint32_t page;  // 所在页的编号
+        uint16_t slabClass;
+        uint16_t used;  // 1 表示已分配
+    };
+
+    static constexpr size_t kHeaderSize = sizeof(ChunkHeader);
+    static constexpr size_t kAlign = 8;
+
+    struct FreeChunk
+    {
+        FreeChunk* next;
+    };
+
+    struct SlabClass
+    {
+        size_t     chunkSize;     // 含块头
+        size_t     chunksPerPage;
+        FreeChunk* freeList = nullptr;
+        size_t     freeCount = 0;
+        size_t     pages = 0;
+        size_t     used = 0;
+    };
+
+    struct Page
+    {
+        char*  memory = nullptr;
+        size_t slabClass = 0;
+        size_t used = 0; // 页内已分配的块
+    };
+
+public:
+    KSlabAllocator(size_t memoryLimit, const KSlabOptions& options = KSlabOptions())
+        : pageSize_(std::max<size_t>(options.pageSize, options.minChunkSize))
+        , maxPages_(std::max<size_t>(memoryLimit / pageSize_, 1))
+        , arena_(options.hugePages != KHugePageMode::Off ? new KHugePageArena(options.hugePages) : nullptr)
+    {
+        double factor = std::max(options.growthFactor, 1.01);
+        size_t size = roundUp(std::max<size_t>(options.minChunkSize, kHeaderSize + kAlign));
+        while (size <= pageSize_ / 2)
+        {
+            addClass(size);
+            size = std::max(roundUp(static_cast<size_t>(size * factor)), size + kAlign);
+        }
+        // 最后一个等级整页只放一个块
+        addClass(pageSize_);
+    }
+
+    ~KSlabAllocator()
+    {
+        // 来自内存池的页随内存池一起释放 已归还的页 memory 为空
+        if (!arena_)
+        {
+            for (Page& page : pages_)
+                delete[] page.memory;
+        }
+    }
+
+    KSlabAllocator(const KSlabAllocator&) = delete;
+    KSlabAllocator& operator=(const KSlabAllocator&) = delete;
+
+    // 能容纳 bytes 字节的最小尺寸等级 超过单页容量时返回 -1
+    int classOf(size_t bytes) const
+    {
+        auto it = std::lower_bound(classes_.begin(), classes_.end(), bytes + kHeaderSize,
+                                   [](const SlabClass& c, size_t need) { return c.chunkSize < need; });
+        return it == classes_.end() ? -1 : static_cast<int>(it - classes_.begin());
+    }
+
+    /**
+     * @brief 从指定尺寸等级分配一个块
+     *
+     * 空闲链表为空时申请新页，已达页数上限时返回 nullptr，由调用方淘汰同等级的对象或调用 movePage。
+     */
+    void* allocate(int slabClass)
+    {
+        SlabClass& c = classes_[slabClass];
+        if (!c.freeList && !addPage(static_cast<size_t>(slabClass)))
+            return nullptr;
+        FreeChunk* chunk = c.freeList;
+        c.freeList = chunk->next;
+        --c.freeCount;
+        ++c.used;
+        ChunkHeader* header = headerOf(chunk);
+        header->used = 1;
+        ++pages_[header->page].used;
+        return chunk;
+    }
+
+    void free(void* ptr)
+    {
+        ChunkHeader* header = headerOf(ptr);
+        SlabClass& c = classes_[header->slabClass];
+        header->used = 0;
+        --pages_[header->page].used;
+        --c.used;
+        pushFree(c, ptr);
+    }
+
+    /**
+     * @brief 把一页从等级 from 转给等级 to (slab 重平衡)
+     *
+     * 选择 from 中已分配块最少的页，对页内每个仍在使用的块调用 evict(ptr)，
+     * evict 需要让调用方放弃该对象并调用 free(ptr)。随后把整页重新切分给 to。
+     * from 没有页时返回 false。
+     */
+    template<typename Evict>
+    bool movePage(int from, int to, Evict&& evict)
+    {
+        if (classes_[from].pages == 0 || from == to)
+            return false;
+        size_t victim = detachPage(from, evict);
+        carve(victim, static_cast<size_t>(to));
+        ++pagesMoved_;
+        return true;
+    }
+
+    /**
+     * @brief 从等级 from 中取出一页归还系统(或大页内存池) 用于调低内存上限后的缩容
+     *
+     * 与 movePage 一样选择已分配块最少的页并对其中的块调用 evict。from 没有页时返回 false。
+     * 大页模式下页的地址范围留在内存池中，物理内存由内存池 madvise 归还(见 KHugePageArena)。
+     */
+    template<typename Evict>
+    bool releasePage(int from, Evict&& evict)
+    {
+        if (classes_[from].pages == 0)
+            return false;
+        size_t victim = detachPage(from, evict);
+        Page& page = pages_[victim];
+        if (arena_)
+            arena_->deallocate(page.memory, pageSize_);
+        else
+            delete[] page.memory;
+        page.memory = nullptr;
+        page.slabClass = kNoClass;
+        freePageIds_.push_back(victim);
+        return true;
+    }
+
+    // 调整页数上限 已有的页不受影响 超出部分由调用方 releasePage
+    void setPageLimit(size_t pages) { maxPages_ = std::max<size_t>(pages, 1); }
+
+    size_t classCount() const { return classes_.size(); }
+    size_t chunkSize(int slabClass) const { return classes_[slabClass].chunkSize; }
+    size_t pageSize() const { return pageSize_; }
+    size_t pageCount() const { return pages_.size() - freePageIds_.size(); }
+    size_t pageLimit() const { return maxPages_; }
+    size_t pageBytes() const { return pageCount() * pageSize_; }
+    uint64_t pagesMoved() const { return pagesMoved_; }
+    KHugePageStats hugePageStats() const { return arena_ ? arena_->stats() : KHugePageStats(); }
+
+    KSlabClassStats classStats(int slabClass) const
+    {
+        const SlabClass& c = classes_[slabClass];
+        KSlabClassStats stats;
+        stats.chunkSize = c.chunkSize;
+        stats.pages = c.pages;
+        stats.chunksUsed = c.used;
+        stats.chunksFree = c.freeCount;
+        return stats;
+    }
+
+    // 所有已分配块占用的字节数(含块头与块内未用的部分)
+    size_t usedChunkBytes() const
+    {
+        size_t bytes = 0;
+        for (const SlabClass& c : classes_)
+            bytes += c.used * c.chunkSize;
+        return bytes;
+    }
+
+private:
+    static constexpr size_t kNoClass = SIZE_MAX; // 已归还的页
+
+    static size_t roundUp(size_t size) { return (size + kAlign - 1) & ~(kAlign - 1); }
+
+    static ChunkHeader* headerOf(void* ptr)
+    {
+        return reinterpret_cast<ChunkHeader*>(static_cast<char*>(ptr) - kHeaderSize);
+    }
+
+    void addClass(size_t chunkSize)
+    {
+        SlabClass c;
+        c.chunkSize = chunkSize;
+        c.chunksPerPage = pageSize_ / chunkSize;
+        classes_.push_back(c);
+    }
+
+    bool addPage(size_t slabClass)
+    {
+        if (pageCount() >= maxPages_)
+            return false;
+        char* memory = arena_ ? static_cast<char*>(arena_->allocate(pageSize_)) : new char[pageSize_];
+        size_t pageIndex = pages_.size();
+        if (!freePageIds_.empty())
+        {
+            // 复用已归还页的编号
+            pageIndex = freePageIds_.back();
+            freePageIds_.pop_back();
+        }
+        else
+        {
+            pages_.emplace_back();
+        }
+        pages_[pageIndex].memory = memory;
+        carve(pageIndex, slabClass);
+        return true;
+    }
+
+    // 选出 from 中已分配块最少的页 淘汰其中的块并把整页从 from 摘下 返回页编号
+    template<typename Evict>
+    size_t detachPage(int from, Evict& evict)
+    {
+        SlabClass& source = classes_[from];
+        size_t victim = pages_.size();
+        for (size_t i = 0; i < pages_.size(); ++i)
+        {
+            if (pages_[i].slabClass == static_cast<size_t>(from) &&
+                (victim == pages_.size() || pages_[i].used < pages_[victim].used))
+                victim = i;
+        }
+
+        char* base = pages_[victim].memory;
+        for (size_t i = 0; i < source.chunksPerPage; ++i)
+        {
+            ChunkHeader* header = reinterpret_cast<ChunkHeader*>(base + i * source.chunkSize);
+            if (header->used)
+                evict(static_cast<void*>(reinterpret_cast<char*>(header) + kHeaderSize));
+        }
+
+        // 页内的块此时都在 from 的空闲链表上 把它们摘掉
+        FreeChunk** link = &source.freeList;
+        while (*link)
+        {
+            if (headerOf(*link)->page == victim)
+            {
+                *link = (*link)->next;
+                --source.freeCount;
+            }
+            else
+            {
+                link = &(*link)->next;
+            }
+        }
+        --source.pages;
+        return victim;
+    }
+
+    // 把一页切成 slabClass 的块并放入空闲链表
+    void carve(size_t pageIndex, size_t slabClass)
+    {
+        Page& page = pages_[pageIndex];
+        SlabClass& c = classes_[slabClass];
+        page.slabClass = slabClass;
+        page.used = 0;
+        ++c.pages;
+        char* base = page.memory;
+        // 逆序压栈 分配时按地址顺序取块
+        for (size_t i = c.chunksPerPage; i-- > 0;)
+        {
+            ChunkHeader* header = reinterpret_cast<ChunkHeader*>(base + i * c.chunkSize);
+            header->page = static_cast<uint32_t>(pageIndex);
+            header->slabClass = static_cast<uint16_t>(slabClass);
+            header->used = 0;
+            pushFree(c, reinterpret_cast<char*>(header) + kHeaderSize);
+        }
+    }
+
+    void pushFree(SlabClass& c, void* ptr)
+    {
+        FreeChunk* chunk = static_cast<FreeChunk*>(ptr);
+        chunk->next = c.freeList;
+        c.freeList = chunk;
+        ++c.freeCount;
+    }
+
+private:
+    size_t                 pageSize_;
+    size_t                 maxPages_;       // 页数上限
+    std::vector<SlabClass> classes_;        // 按块大小递增
+    std::vector<Page>      pages_;          // 已申请的页 编号即下标
+    std::vector<size_t>    freePageIds_;    // 已归还的页编号
+    std::unique_ptr<KHugePageArena> arena_; // 大页内存池 为空时页直接 new
+    uint64_t               pagesMoved_ = 0; // 累计重平衡的页数
+};
+
+} // namespace KamaCache
@@ -0,0 +1,489 @@
+#pragma once
+
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "../KHashIndex.h"
+#include "../KICachePolicy.h"
+#include "../KShardedCache.h"
+#include "KSlabAllocator.h"
+
+namespace KamaCache
+{
+
+// slab 缓存的内存统计 分片版本是各分片之和
+struct KSlabMemoryStats
+{
+    size_t   limitBytes = 0;     // 内存上限
+    size_t   pageBytes = 0;      // 已向系统申请的 slab 页
+    size_t   chunkBytes = 0;     // 已分配块的总大小
+    size_t   requestedBytes = 0; // 条目实际需要的字节(条目头 + 值)
+    size_t   valueBytes = 0;     // 其中值的字节
+    size_t   items = 0;
+    uint64_t evictions = 0;
+    uint64_t pagesMoved = 0;     // 重平衡转移的页数
+    size_t   hugePageBytes = 0;  // 由大页(透明或预留)支撑的映射 KSlabOptions::hugePages 为 Off 时为 0
+    size_t   releasedBytes = 0;  // 大页模式下缩容归还的页已交还系统的物理内存
+
+    // slab 页中没有存放条目数据的比例 包括块内剩余空间与空闲块
+    double fragmentation() const
+    {
+        return pageBytes > 0 ? 1.0 - static_cast<double>(requestedBytes) / pageBytes : 0;
+    }
+
+    // 平均每个条目实际占用的内存
+    double bytesPerEntry() const
+    {
+        return items > 0 ? static_cast<double>(pageBytes) / items : 0;
+    }
+
+    KSlabMemoryStats& operator+=(const KSlabMemoryStats& other)
+    {
+        limitBytes += other.limitBytes;
+        pageBytes += other.pageBytes;
+        chunkBytes += other.chunkBytes;
+        requestedBytes += other.requestedBytes;
+        valueBytes += other.valueBytes;
+        items += other.items;
+        evictions += other.evictions;
+        pagesMoved += other.pagesMoved;
+        hugePageBytes += other.hugePageBytes;
+        releasedBytes += other.releasedBytes;
+        return *this;
+    }
+};
+
+/**
+ * @brief 数据存放在 slab 块中的 LRU 缓存 值为变长字节串
+ *
+ * 以 std::string 为值的 LRU 每个条目至少有两次堆分配(节点与字符串)，大小不一的对象在 malloc 中长期混杂，
+ * 常驻内存会明显高于实际数据量。这里条目头(key、哈希、链表指针、值长度)与值的字节放在同一个 slab 块中，
+ * 内存完全由 KSlabAllocator 按页管理，容量以字节计。
+ *
+ * 与 memcached 相同，每个尺寸等级有自己的 LRU 链表：写入时所在等级没有空闲块就淘汰该等级最久未访问的条目。
+ * 各等级的页在写入模式变化后可能分配不当，因此按淘汰压力做重平衡：
+ * 每发生 kRebalanceEvery 次淘汰，把一页从淘汰最少(按页平均)的等级转给淘汰最多的等级，
+ * 被转移页中的条目直接淘汰。某个等级一页都没有而页数已达上限时立即转移一页。
+ *
+ * Key 对象本身也放在块中；像 std::string 这样自带堆内存的 key，其外部内存不在 slab 统计之内。
+ */
+template<typename Key>
+class KSlabLruCache : public KICachePolicy<Key, std::string>
+{
+private:
+    struct Item
+    {
+        Item(const Key& k, size_t h)
+            : key(k)
+            , hash(h)
+        {}
+
+        Key      key;
+        size_t   hash;
+        Item*    prev = nullptr;
+        Item*    next = nullptr;
+        uint32_t valueSize = 0;
+        int      slabClass = 0;
+
+        char* data() { return reinterpret_cast<char*>(this + 1); }
+        const Key& getKey() const { return key; }
+        size_t getHash() const { return hash; }
+    };
+
+    static_assert(alignof(Item) <= 8, "slab 块按 8 字节对齐");
+
+    // 一个尺寸等级的 LRU 链表 head 为最近访问
+    struct ClassList
+    {
+        Item*    head = nullptr;
+        Item*    tail = nullptr;
+        uint64_t evictions = 0;       // 累计淘汰
+        uint64_t recentEvictions = 0; // 本轮重平衡窗口内没有空闲块可用的次数
+    };
+
+    static constexpr uint64_t kRebalanceEvery = 1024;
+
+public:
+    /**
+     * @param memoryLimit 本缓存可以使用的 slab 内存上限(字节) 分片版本中为每个分片的上限
+     */
+    explicit KSlabLruCache(size_t memoryLimit, const KSlabOptions& options = KSlabOptions())
+        : limit_(memoryLimit)
+        , allocator_(memoryLimit, options)
+        , lists_(allocator_.classCount())
+        , sinceRebalance_(0)
+        , requestedBytes_(0)
+        , valueBytes_(0)
+    {}
+
+    ~KSlabLruCache() override
+    {
+        // 块内存随分配器释放 这里只需要析构 key
+        for (ClassList& list : lists_)
+        {
+            // 析构之后不能再读取 item->next 先取出下一个
+            for (Item* item = list.head; item;)
+            {
+                Item* next = item->next;
+                item->~Item();
+                item = next;
+            }
+        }
+    }
+
+    void put(Key key, std::string value) override
+    {
+        put(key, value, KHashOf(key));
+    }
+
+    // 使用调用方预先算好的哈希值 要求 hash == KHashOf(key)
+    void put(const Key& key, const std::string& value, size_t hash)
+    {
+        int slabClass = allocator_.classOf(sizeof(Item) + value.size());
+        std::lock_guard<std::mutex> lock(mutex_);
+        // 调低内存上限后 每次写入最多归还一页 代价与一次重平衡相同
+        trimLocked(1);
+        Item** found = index_.find(key, hash);
+        if (found)
+        {
+            Item* item = *found;
+            if (item->slabClass == slabClass)
+            {
+                // 尺寸等级不变时原地覆盖
+                requestedBytes_ += value.size() - item->valueSize;
+                valueBytes_ += value.size() - item->valueSize;
+                std::memcpy(item->data(), value.data(), value.size());
+                item->valueSize = static_cast<uint32_t>(value.size());
+                unlink(item);
+                pushFront(item);
+                return;
+            }
+            // 换到其他等级 旧条目先删除 新值放不下时也不能留下旧值
+            removeItem(item);
+        }
+        insertLocked(key, value, hash, slabClass);
+    }
+
+    // 尺寸等级不变时原地覆盖 不移动条目；等级改变时必须换块 新块与普通写入一样放在链表头部
+    bool updateIfPresent(Key key, std::string value) override
+    {
+        size_t hash = KHashOf(key);
+        int slabClass = allocator_.classOf(sizeof(Item) + value.size());
+        std::lock_guard<std::mutex> lock(mutex_);
+        Item** found = index_.find(key, hash);
+        if (!found)
+            return false;
+        Item* item = *found;
+        if (item->slabClass == slabClass)
+        {
+            requestedBytes_ += value.size() - item->valueSize;
+            valueBytes_ += value.size() - item->valueSize;
+            std::memcpy(item->data(), value.data(), value.size());
+            item->valueSize = static_cast<uint32_t>(value.size());
+            return true;
+        }
+        removeItem(item);
+        insertLocked(key, value, hash, slabClass);
+        return true;
+    }
+
+    bool get(Key key, std::string& value) override
+    {
+        return get(key, value, KHashOf(key));
+    }
+
+    bool get(const Key& key, std::string& value, size_t hash)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Item** found = index_.find(key, hash);
+        if (!found)
+            return false;
+        Item* item = *found;
+        unlink(item);
+        pushFront(item);
+        value.assign(item->data(), item->valueSize);
+        return true;
+    }
+
+    std::string get(Key key) override
+    {
+        std::string value;
+        get(key, value);
+        return value;
+    }
+
+    void remove(const Key& key)
+    {
+        size_t hash = KHashOf(key);
+        std::lock_guard<std::mutex> lock(mutex_);
+        Item** found = index_.find(key, hash);
+        if (found)
+            removeItem(*found);
+    }
+
+    /**
+     * @brief 运行期调整内存上限(字节) 分片版本中为每个分片的上限
+     *
+     * 调低后已有的页不会立即归还：之后每次写入最多归还一页，也可以调用 trim 分批归还。
+     * 至少保留一页。
+     */
+    void setCapacity(size_t memoryLimit) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        limit_ = memoryLimit;
+        allocator_.setPageLimit(memoryLimit / allocator_.pageSize());
+    }
+
+    // slab 按页回收 maxEvictions 计为归还的页数 返回之后仍超出上限的页数
+    size_t trim(size_t maxEvictions) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return trimLocked(maxEvictions);
+    }
+
+    // 手动触发一次重平衡 返回是否转移了页
+    bool rebalance()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return rebalanceLocked(-1);
+    }
+
+    KSlabMemoryStats memoryStats()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        KSlabMemoryStats stats;
+        stats.limitBytes = limit_;
+        stats.pageBytes = allocator_.pageBytes();
+        stats.chunkBytes = allocator_.usedChunkBytes();
+        stats.requestedBytes = requestedBytes_;
+        stats.valueBytes = valueBytes_;
+        stats.items = index_.size();
+        for (const ClassList& list : lists_)
+            stats.evictions += list.evictions;
+        stats.pagesMoved = allocator_.pagesMoved();
+        KHugePageStats huge = allocator_.hugePageStats();
+        stats.hugePageBytes = huge.transparentBytes + huge.explicitBytes;
+        stats.releasedBytes = huge.releasedBytes;
+        return stats;
+    }
+
+    // 各尺寸等级的分配情况 只返回分到过页的等级
+    std::vector<KSlabClassStats> classStats()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<KSlabClassStats> result;
+        for (size_t i = 0; i < allocator_.classCount(); ++i)
+        {
+            KSlabClassStats stats = allocator_.classStats(static_cast<int>(i));
+            if (stats.pages > 0)
+                result.push_back(stats);
+        }
+        return result;
+    }
+
+private:
+    // 从淘汰压力最小的等级归还页 直到页数不超过上限 持有 mutex_
+    size_t trimLocked(size_t maxPages)
+    {
+        for (; maxPages > 0 && allocator_.pageCount() > allocator_.pageLimit(); --maxPages)
+        {
+            double pressure = 0;
+            int donor = pickDonor(-1, pressure);
+            if (donor < 0)
+                break;
+            allocator_.releasePage(donor, [this](void* chunk) { evictItem(static_cast<Item*>(chunk)); });
+        }
+        size_t pages = allocator_.pageCount();
+        return pages > allocator_.pageLimit() ? pages - allocator_.pageLimit() : 0;
+    }
+
+    // 除 exclude 外按页平均的淘汰压力最小、且至少有一页的等级 没有时返回 -1
+    int pickDonor(int exclude, double& donorPressure)
+    {
+        int donor = -1;
+        for (size_t i = 0; i < lists_.size(); ++i)
+        {
+            size_t pages = allocator_.classStats(static_cast<int>(i)).pages;
+            if (static_cast<int>(i) == exclude || pages == 0)
+                continue;
+            double pressure = static_cast<double>(lists_[i].recentEvictions) / pages;
+            if (donor < 0 || pressure < donorPressure)
+            {
+                donor = static_cast<int>(i);
+                donorPressure = pressure;
+            }
+        }
+        return donor;
+    }
+
+    // 在指定等级取得一个块 必要时淘汰或重平衡 持有 mutex_
+    void* allocateIn(int slabClass)
+    {
+        void* memory = allocator_.allocate(slabClass);
+        if (memory)
+            return memory;
+
+        // 记录该等级的分配压力 定期据此重平衡 重平衡后可能已经有了空闲块
+        ClassList& list = lists_[slabClass];
+        ++list.recentEvictions;
+        if (++sinceRebalance_ >= kRebalanceEvery && rebalanceLocked(-1))
+        {
+            memory = allocator_.allocate(slabClass);
+            if (memory)
+                return memory;
+        }
+
+        if (list.tail)
+        {
+            evictItem(list.tail);
+            return allocator_.allocate(slabClass);
+        }
+        // 该等级一页都没有 只能从其他等级转一页过来
+        if (rebalanceLocked(slabClass))
+            return allocator_.allocate(slabClass);
+        return nullptr;
+    }
+
+    /**
+     * @brief 把一页从淘汰压力最小的等级转给 receiver
+     *
+     * receiver 为 -1 时选择本轮窗口内淘汰最多的等级，且要求捐出页的等级按页平均的淘汰数不到它的一半，
+     * 避免两个等级之间来回转移。指定 receiver 时(该等级没有页)不做这个比较。持有 mutex_
+     */
+    bool rebalanceLocked(int receiver)
+    {
+        bool forced = receiver >= 0;
+        if (!forced)
+        {
+            sinceRebalance_ = 0;
+            uint64_t most = 0;
+            for (size_t i = 0; i < lists_.size(); ++i)
+            {
+                if (lists_[i].recentEvictions > most)
+                {
+                    most = lists_[i].recentEvictions;
+                    receiver = static_cast<int>(i);
+                }
+            }
+            if (receiver < 0)
+                return false;
+        }
+
+        double donorPressure = 0;
+        int donor = pickDonor(receiver, donorPressure);
+
+        bool moved = false;
+        if (donor >= 0)
+        {
+            size_t receiverPages = allocator_.classStats(receiver).pages;
+            double receiverPressure = static_cast<double>(lists_[receiver].recentEvictions) /
+                                      std::max<size_t>(receiverPages, 1);
+            if (forced || donorPressure * 2 < receiverPressure)
+            {
+                moved = allocator_.movePage(donor, receiver, [this](void* chunk) {
+                    evictItem(static_cast<Item*>(chunk));
+                });
+            }
+        }
+        if (!forced)
+        {
+            for (ClassList& list : lists_)
+                list.recentEvictions = 0;
+        }
+        return moved;
+    }
+
+    // 容量淘汰 通知回调后释放 持有 mutex_
+    void evictItem(Item* item)
+    {
+        ++lists_[item->slabClass].evictions;
+        if (this->hasEvictCallback())
+            this->onEvict(item->key, std::string(item->data(), item->valueSize));
+        removeItem(item);
+    }
+
+    void removeItem(Item* item)
+    {
+        unlink(item);
+        index_.eraseNode(item);
+        requestedBytes_ -= sizeof(Item) + item->valueSize;
+        valueBytes_ -= item->valueSize;
+        item->~Item();
+        allocator_.free(item);
+    }
+
+    // 在 slabClass 等级分配块并写入新条目 持有 mutex_
+    void insertLocked(const Key& key, const std::string& value, size_t hash, int slabClass)
+    {
+        if (slabClass < 0)
+            return; // 超过单页大小 不缓存
+
+        void* memory = allocateIn(slabClass);
+        if (!memory)
+            return;
+        Item* item = new (memory) Item(key, hash);
+        item->slabClass = slabClass;
+        item->valueSize = static_cast<uint32_t>(value.size());
+        std::memcpy(item->data(), value.data(), value.size());
+        pushFront(item);
+        index_.insert(hash, item);
+        requestedBytes_ += sizeof(Item) + value.size();
+        valueBytes_ += value.size();
+    }
+
+    void pushFront(Item* item)
+    {
+        ClassList& list = lists_[item->slabClass];
+        item->prev = nullptr;
+        item->next = list.head;
+        if (list.head) list.head->prev = item; else list.tail = item;
+        list.head = item;
+    }
+
+    void unlink(Item* item)
+    {
+        ClassList& list = lists_[item->slabClass];
+        if (item->prev) item->prev->next = item->next; else list.head = item->next;
+        if (item->next) item->next->prev = item->prev; else list.tail = item->prev;
+        item->prev = item->next = nullptr;
+    }
+
+private:
+    size_t                 limit_;
+    KSlabAllocator         allocator_;
+    KHashIndex<Key, Item*> index_;
+    std::vector<ClassList> lists_;          // 每个尺寸等级一条 LRU 链表
+    uint64_t               sinceRebalance_; // 上次重平衡后的淘汰次数
+    size_t                 requestedBytes_;
+    size_t                 valueBytes_;
+    std::mutex             mutex_;
+};
+
+/**
+ * @brief slab LRU 的分片版本 每个分片有自己的 slab 页与锁
+ *
+ * capacity 是所有分片合计的内存上限(字节)，平均分给各分片。
+ */
+template<typename Key>
+class KHashSlabLruCache : public KShardedCache<Key, std::string, KSlabLruCache<Key>>
+{
+private:
+    using Base = KShardedCache<Key, std::string, KSlabLruCache<Key>>;
+
+public:
+    explicit KHashSlabLruCache(size_t memoryLimit, int sliceNum = 0, const KSlabOptions& options = KSlabOptions())
+        : Base(memoryLimit, sliceNum, options)
+    {}
+
+    KSlabMemoryStats memoryStats()
+    {
+        KSlabMemoryStats total;
+        this->forEachSlice([&total](KSlabLruCache<Key>& slice) { total += slice.memoryStats(); });
+        return total;
+    }
+};
+
+} // namespace KamaCache
@@ -0,0 +1,367 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "KHashIndex.h"
+#include "KICachePolicy.h"
+#include "KShardedCache.h"
+
+namespace KamaCache
+{
+
+/**
+ * @brief 分段 LRU (Segmented LRU) 淘汰策略
+ *
+ * 核心设计：
+ * 1. 缓存分为试用段(probation)与保护段(protected)两个 LRU 链表，新数据进入试用段，
+ *    在试用段中再次被访问才晋升到保护段；保护段溢出时把其最久未访问的节点降级回试用段。
+ * 2. 淘汰只发生在试用段的最久未访问端，只访问一次的扫描数据无法进入保护段，
+ *    效果接近 KLruKCache(k=2)，但不需要额外的历史缓存和值表。
+ * 3. 两个段共用一块预先分配的节点池和一个索引，链表使用 32 位下标，全部操作在一把锁内完成，
+ *    每次访问的开销与 LRU 相同。
+ */
+template<typename Key, typename Value>
+class KSlruCache : public KICachePolicy<Key, Value>
+{
+private:
+    static constexpr uint32_t kNil = UINT32_MAX; // 空下标 相当于空指针
+
+    enum Segment : uint8_t { Probation = 0, Protected = 1 };
+
+    struct Slot
+    {
+        Key      key{};
+        Value    value{};
+        size_t   hash = 0;
+        uint32_t prev = kNil;
+        uint32_t next = kNil; // 空闲时复用为空闲链表的后继
+        Segment  segment = Probation;
+
+        const Key& getKey() const { return key; }
+        size_t getHash() const { return hash; }
+    };
+
+    // 一个段对应一条双向链表 头为最久未访问 尾为最近访问
+    struct List
+    {
+        uint32_t head = kNil;
+        uint32_t tail = kNil;
+        size_t   size = 0;
+    };
+
+    using NodeMap = KHashIndex<Key, Slot*>;
+
+public:
+    /**
+     * @brief 构造函数
+     *
+     * @param capacity 缓存总容量 节点池按它一次性分配 setCapacity 扩容超过它时重新分配
+     * @param protectedRatio 保护段占总容量的比例 取值 [0, 1)
+     */
+    explicit KSlruCache(int capacity, double protectedRatio = 0.8)
+        : capacity_(capacity > 0 ? static_cast<size_t>(capacity) : 0)
+        , slotCount_(capacity_)
+        , protectedRatio_(protectedRatio)
+        , slots_(new Slot[capacity_ > 0 ? capacity_ : 1])
+        , freeHead_(kNil)
+        , used_(0)
+        , nodeMap_(capacity_)
+    {
+        updateProtectedCapacity();
+    }
+
+    ~KSlruCache() override = default;
+
+    void put(Key key, Value value) override
+    {
+        put(key, value, KHashOf(key));
+    }
+
+    // 使用调用方预先算好的哈希值 要求 hash == KHashOf(key)
+    void put(const Key& key, const Value& value, size_t hash)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slot** found = nodeMap_.find(key, hash);
+        if (found)
+        {
+            Slot* slot = *found;
+            slot->value = value;
+            access(indexOf(slot));
+            return;
+        }
+
+        if (capacity_ == 0)
+        {
+            trimLocked(this->kTrimBatch);
+            return;
+        }
+        uint32_t index = acquireSlot();
+        Slot& slot = slots_[index];
+        slot.key = key;
+        slot.value = value;
+        slot.hash = hash;
+        linkAtTail(probation_, index, Probation);
+        nodeMap_.insert(hash, &slot);
+    }
+
+    // 冷端写入：新条目放在试用段的最久未访问端 已存在的条目只更新值
+    void putCold(Key key, Value value) override
+    {
+        size_t hash = KHashOf(key);
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slot** found = nodeMap_.find(key, hash);
+        if (found)
+        {
+            (*found)->value = value;
+            return;
+        }
+
+        if (capacity_ == 0)
+        {
+            trimLocked(this->kTrimBatch);
+            return;
+        }
+        uint32_t index = acquireSlot();
+        Slot& slot = slots_[index];
+        slot.key = key;
+        slot.value = value;
+        slot.hash = hash;
+        linkAtHead(probation_, index, Probation);
+        nodeMap_.insert(hash, &slot);
+    }
+
+    // 只更新已存在条目的值 不晋升也不移动
+    bool updateIfPresent(Key key, Value value) override
+    {
+        size_t hash = KHashOf(key);
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slot** found = nodeMap_.find(key, hash);
+        if (!found)
+            return false;
+        (*found)->value = std::move(value);
+        return true;
+    }
+
+    bool get(Key key, Value& value) override
+    {
+        return get(key, value, KHashOf(key));
+    }
+
+    bool get(const Key& key, Value& value, size_t hash)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slot** found = nodeMap_.find(key, hash);
+        if (!found)
+            return false;
+        Slot* slot = *found;
+        access(indexOf(slot));
+        value = slot->value;
+        return true;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    void remove(Key key)
+    {
+        remove(key, KHashOf(key));
+    }
+
+    void remove(const Key& key, size_t hash)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slot** found = nodeMap_.find(key, hash);
+        if (!found)
+            return;
+        uint32_t index = indexOf(*found);
+        unlink(listOf(slots_[index].segment), index);
+        nodeMap_.erase(key, hash);
+        slots_[index].next = freeHead_;
+        freeHead_ = index;
+    }
+
+    // 扩容超过节点池大小时重新分配节点池并重建索引 耗时与条目数成正比；缩容不释放节点池
+    void setCapacity(size_t capacity) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (capacity > slotCount_)
+            growSlots(capacity);
+        capacity_ = capacity;
+        updateProtectedCapacity();
+    }
+
+    size_t trim(size_t maxEvictions) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return trimLocked(maxEvictions);
+    }
+
+private:
+    void updateProtectedCapacity()
+    {
+        protectedCapacity_ = static_cast<size_t>(capacity_ * protectedRatio_);
+        if (protectedCapacity_ >= capacity_ && capacity_ > 0)
+            protectedCapacity_ = capacity_ - 1; // 至少为试用段保留一个位置
+    }
+
+    size_t trimLocked(size_t maxEvictions)
+    {
+        while (maxEvictions-- > 0 && nodeMap_.size() > capacity_)
+        {
+            uint32_t index = evictOldest();
+            slots_[index].next = freeHead_;
+            freeHead_ = index;
+        }
+        return nodeMap_.size() > capacity_ ? nodeMap_.size() - capacity_ : 0;
+    }
+
+    // 换用更大的节点池 槽位之间以下标链接不受影响 只需重建保存槽位指针的索引 持有 mutex_
+    void growSlots(size_t count)
+    {
+        std::unique_ptr<Slot[]> slots(new Slot[count]);
+        for (uint32_t i = 0; i < used_; ++i)
+            slots[i] = std::move(slots_[i]);
+        slots_ = std::move(slots);
+        slotCount_ = count;
+        nodeMap_.clear();
+        reindex(probation_);
+        reindex(protected_);
+    }
+
+    void reindex(const List& list)
+    {
+        for (uint32_t index = list.head; index != kNil; index = slots_[index].next)
+            nodeMap_.insert(slots_[index].hash, &slots_[index]);
+    }
+
+    uint32_t indexOf(const Slot* slot) const
+    {
+        return static_cast<uint32_t>(slot - slots_.get());
+    }
+
+    List& listOf(Segment segment)
+    {
+        return segment == Probation ? probation_ : protected_;
+    }
+
+    // 命中：试用段节点晋升到保护段 保护段节点移到最近端
+    void access(uint32_t index)
+    {
+        Slot& slot = slots_[index];
+        if (slot.segment == Protected)
+        {
+            if (protected_.tail != index)
+            {
+                unlink(protected_, index);
+                linkAtTail(protected_, index, Protected);
+            }
+            return;
+        }
+
+        if (protectedCapacity_ == 0)
+        {
+            // 没有保护段 退化为普通 LRU
+            unlink(probation_, index);
+            linkAtTail(probation_, index, Probation);
+            return;
+        }
+
+        unlink(probation_, index);
+        linkAtTail(protected_, index, Protected);
+        if (protected_.size > protectedCapacity_)
+        {
+            // 保护段溢出 最久未访问的节点降级到试用段的最近端 再给它一次机会
+            uint32_t demoted = protected_.head;
+            unlink(protected_, demoted);
+            linkAtTail(probation_, demoted, Probation);
+        }
+    }
+
+    // 取得一个可写入的槽位 缓存已满时淘汰试用段(为空时淘汰保护段)最久未访问的条目并复用其槽位
+    uint32_t acquireSlot()
+    {
+        trimLocked(this->kTrimBatch);
+        if (nodeMap_.size() < capacity_)
+            return allocateSlot();
+        return evictOldest();
+    }
+
+    // 淘汰试用段(为空时淘汰保护段)最久未访问的条目 返回空出的槽位
+    uint32_t evictOldest()
+    {
+        List& victimList = probation_.size > 0 ? probation_ : protected_;
+        uint32_t index = victimList.head;
+        unlink(victimList, index);
+        nodeMap_.eraseNode(&slots_[index]);
+        this->onEvict(slots_[index].key, slots_[index].value);
+        return index;
+    }
+
+    uint32_t allocateSlot()
+    {
+        if (freeHead_ != kNil)
+        {
+            uint32_t index = freeHead_;
+            freeHead_ = slots_[index].next;
+            return index;
+        }
+        return used_++;
+    }
+
+    void unlink(List& list, uint32_t index)
+    {
+        Slot& s = slots_[index];
+        if (s.prev != kNil) slots_[s.prev].next = s.next; else list.head = s.next;
+        if (s.next != kNil) slots_[s.next].prev = s.prev; else list.tail = s.prev;
+        --list.size;
+    }
+
+    void linkAtTail(List& list, uint32_t index, Segment segment)
+    {
+        Slot& s = slots_[index];
+        s.segment = segment;
+        s.prev = list.tail;
+        s.next = kNil;
+        if (list.tail != kNil) slots_[list.tail].next = index; else list.head = index;
+        list.tail = index;
+        ++list.size;
+    }
+
+    void linkAtHead(List& list, uint32_t index, Segment segment)
+    {
+        Slot& s = slots_[index];
+        s.segment = segment;
+        s.prev = kNil;
+        s.next = list.head;
+        if (list.head != kNil) slots_[list.head].prev = index; else list.tail = index;
+        list.head = index;
+        ++list.size;
+    }
+
+private:
+    size_t                  capacity_;          // 缓存总容量
+    size_t                  slotCount_;         // 节点池大小 不小于容量
+    double                  protectedRatio_;    // 保护段占总容量的比例
+    size_t                  protectedCapacity_; // 保护段容量
+    std::unique_ptr<Slot[]> slots_;             // 两个段共用的节点池 只在扩容时重新分配 索引直接保存槽位指针
+    uint32_t                freeHead_;          // 空闲槽位链表(remove 归还的槽位)
+    uint32_t                used_;              // 已经分配过的槽位数
+    List                    probation_;         // 试用段
+    List                    protected_;         // 保护段
+    NodeMap                 nodeMap_;           // key -> 槽位 的索引
+    std::mutex              mutex_;             // 互斥锁，保证线程安全
+};
+
+// SLRU 的分片版本
+template<typename Key, typename Value>
+using KHashSlruCache = KShardedCache<Key, Value, KSlruCache<Key, Value>>;
+
+} // namespace KamaCache
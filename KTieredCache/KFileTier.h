@@ -0,0 +1,480 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace KamaCache
+{
+
+/**
+ * @brief 二级缓存的序列化规则
+ * 默认支持可平凡拷贝的类型(直接按字节写入)与 std::string，其他类型需要使用者自行特化。
+ * write 把对象追加到 out 末尾；read 从 [data, data + size) 还原对象，长度不符返回 false。
+ */
+template<typename T, typename Enable = void>
+struct KTierSerializer;
+
+template<typename T>
+struct KTierSerializer<T, std::enable_if_t<std::is_trivially_copyable<T>::value>>
+{
+    static void write(const T& object, std::string& out)
+    {
+        out.append(reinterpret_cast<const char*>(&object), sizeof(T));
+    }
+
+    static bool read(const char* data, size_t size, T& object)
+    {
+        if (size != sizeof(T))
+            return false;
+        std::memcpy(&object, data, sizeof(T));
+        return true;
+    }
+};
+
+template<>
+struct KTierSerializer<std::string>
+{
+    static void write(const std::string& object, std::string& out) { out.append(object); }
+
+    static bool read(const char* data, size_t size, std::string& object)
+    {
+        object.assign(data, size);
+        return true;
+    }
+};
+
+/**
+ * @brief 文件二级缓存的配置
+ */
+struct KFileTierOptions
+{
+    std::string directory;              // 段文件所在目录 不存在时自动创建
+    size_t      segmentBytes = 4 << 20; // 单个段文件大小 写满后封存并新开一个段
+    size_t      maxBytes = 64 << 20;    // 所有段文件的总大小上限
+    double      compactLiveRatio = 0.5; // 存活率不高于该值的段被压缩(搬迁存活数据) 否则整段丢弃
+};
+
+/**
+ * @brief 文件二级缓存的运行统计
+ */
+struct KFileTierStats
+{
+    size_t entries = 0;      // 索引中的条目数
+    size_t segments = 0;     // 段文件数
+    size_t diskBytes = 0;    // 段文件占用的总字节数
+    size_t liveBytes = 0;    // 其中仍被索引引用的字节数
+    size_t writes = 0;       // 写入的记录数
+    size_t reads = 0;        // 成功读出的记录数
+    size_t gcRelocated = 0;  // 垃圾回收时搬迁的记录数
+    size_t gcDropped = 0;    // 垃圾回收时随整段丢弃的记录数
+};
+
+/**
+ * @brief 日志结构(只追加)的文件二级缓存
+ *
+ * 核心设计：
+ * 1. 数据按 [keyLen][valueLen][key][value] 追加写入当前段文件，写满后封存，永不原地修改。
+ * 2. 内存中只保留 key -> (段号, 偏移, 长度) 的紧凑索引，读取时用 pread 按偏移直接读出一条记录。
+ * 3. 覆盖或删除只是让旧记录失效，每个段统计存活字节；总大小超过上限时按段回收：
+ *    存活率低的段把存活记录搬到当前段后删除，存活率高的段(最旧的)整段丢弃，保证占用有界。
+ * 4. 作为缓存层，丢弃数据是允许的；对象析构时删除所有段文件。
+ */
+template<typename Key, typename Value>
+class KFileTier
+{
+private:
+    // 记录头 紧跟其后的是 key 与 value 的序列化字节
+    struct RecordHeader
+    {
+        uint32_t keyLen;
+        uint32_t valueLen;
+    };
+
+    // 索引项：记录所在的段、偏移与总长度
+    struct Location
+    {
+        uint32_t segmentId;
+        uint32_t length;
+        uint64_t offset;
+    };
+
+    // 一个只追加的段文件
+    struct Segment
+    {
+        int         fd = -1;
+        std::string path;
+        uint64_t    size = 0;      // 已写入字节数 即下一条记录的偏移
+        uint64_t    liveBytes = 0; // 仍被索引引用的字节数
+    };
+
+public:
+    explicit KFileTier(const KFileTierOptions& options)
+        : options_(options)
+        , nextSegmentId_(0)
+        , diskBytes_(0)
+    {
+        std::filesystem::create_directories(options_.directory);
+        openSegment();
+    }
+
+    ~KFileTier()
+    {
+        for (auto& pair : segments_)
+        {
+            closeFile(pair.second.fd);
+            std::error_code ec;
+            std::filesystem::remove(pair.second.path, ec);
+        }
+    }
+
+    KFileTier(const KFileTier&) = delete;
+    KFileTier& operator=(const KFileTier&) = delete;
+
+    /**
+     * @brief 追加写入一条记录 覆盖已有的同名 key
+     *
+     * @return false 序列化结果过大或写文件失败
+     */
+    bool put(const Key& key, const Value& value)
+    {
+        std::string record;
+        encode(key, value, record);
+        if (record.size() > options_.segmentBytes)
+            return false;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!append(key, record))
+            return false;
+        ++stats_.writes;
+        enforceBound();
+        return true;
+    }
+
+    /**
+     * @brief 只覆盖已有的记录 没有该 key 时不写入
+     *
+     * @return 是否存在并成功写入
+     */
+    bool update(const Key& key, const Value& value)
+    {
+        std::string record;
+        encode(key, value, record);
+        if (record.size() > options_.segmentBytes)
+            return false;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (index_.find(key) == index_.end() || !append(key, record))
+            return false;
+        ++stats_.writes;
+        enforceBound();
+        return true;
+    }
+
+    /**
+     * @brief 读取记录 记录保留在文件中
+     */
+    bool get(const Key& key, Value& value)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it == index_.end())
+            return false;
+        return readValue(it->second, value);
+    }
+
+    /**
+     * @brief 读取并删除记录 用于晋升回内存层
+     */
+    bool take(const Key& key, Value& value)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it == index_.end())
+            return false;
+        bool found = readValue(it->second, value);
+        invalidate(it->second);
+        index_.erase(it);
+        return found;
+    }
+
+    // 使记录失效 空间在垃圾回收时回收
+    void erase(const Key& key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it != index_.end())
+        {
+            invalidate(it->second);
+            index_.erase(it);
+        }
+    }
+
+    KFileTierStats stats()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        KFileTierStats result = stats_;
+        result.entries = index_.size();
+        result.segments = segments_.size();
+        result.diskBytes = diskBytes_;
+        result.liveBytes = 0;
+        for (const auto& pair : segments_)
+            result.liveBytes += pair.second.liveBytes;
+        return result;
+    }
+
+private:
+    static void encode(const Key& key, const Value& value, std::string& record)
+    {
+        record.assign(sizeof(RecordHeader), '\0');
+        KTierSerializer<Key>::write(key, record);
+        size_t keyEnd = record.size();
+        KTierSerializer<Value>::write(value, record);
+
+        RecordHeader header;
+        header.keyLen = static_cast<uint32_t>(keyEnd - sizeof(RecordHeader));
+        header.valueLen = static_cast<uint32_t>(record.size() - keyEnd);
+        std::memcpy(&record[0], &header, sizeof(RecordHeader));
+    }
+
+    /**
+     * @brief 把编码好的记录追加到当前段 并更新索引与存活统计
+     */
+    bool append(const Key& key, const std::string& record)
+    {
+        if (segments_.rbegin()->second.size + record.size() > options_.segmentBytes)
+            openSegment();
+
+        uint32_t segmentId = segments_.rbegin()->first;
+        Segment& active = segments_.rbegin()->second;
+        if (!writeAt(active.fd, record.data(), record.size(), active.size))
+            return false;
+
+        Location location{segmentId, static_cast<uint32_t>(record.size()), active.size};
+        active.size += record.size();
+        active.liveBytes += record.size();
+        diskBytes_ += record.size();
+
+        auto it = index_.find(key);
+        if (it != index_.end())
+        {
+            invalidate(it->second);
+            it->second = location;
+        }
+        else
+        {
+            index_.emplace(key, location);
+        }
+        return true;
+    }
+
+    bool readValue(const Location& location, Value& value)
+    {
+        std::string buffer(location.length, '\0');
+        const Segment& segment = segments_.at(location.segmentId);
+        if (!readAt(segment.fd, &buffer[0], buffer.size(), location.offset))
+            return false;
+
+        RecordHeader header;
+        std::memcpy(&header, buffer.data(), sizeof(RecordHeader));
+        const char* valueData = buffer.data() + sizeof(RecordHeader) + header.keyLen;
+        if (!KTierSerializer<Value>::read(valueData, header.valueLen, value))
+            return false;
+        ++stats_.reads;
+        return true;
+    }
+
+    void invalidate(const Location& location)
+    {
+        auto it = segments_.find(location.segmentId);
+        if (it != segments_.end())
+            it->second.liveBytes -= location.length;
+    }
+
+    void openSegment()
+    {
+        uint32_t id = nextSegmentId_++;
+        Segment segment;
+        segment.path = (std::filesystem::path(options_.directory) / ("segment-" + std::to_string(id) + ".log")).string();
+        segment.fd = openFile(segment.path);
+        segments_.emplace(id, std::move(segment));
+    }
+
+    /**
+     * @brief 段级垃圾回收 直到总大小回到上限以内(当前写入段不参与回收)
+     * 每轮选出存活率最低的封存段：存活率不超过阈值则搬迁存活记录，否则丢弃最旧的段。
+     */
+    void enforceBound()
+    {
+        while (diskBytes_ > options_.maxBytes && segments_.size() > 1)
+        {
+            uint32_t activeId = segments_.rbegin()->first;
+            auto victim = segments_.end();
+            double victimRatio = 2.0;
+            for (auto it = segments_.begin(); it != segments_.end(); ++it)
+            {
+                if (it->first == activeId)
+                    continue;
+                double ratio = it->second.size == 0 ? 0.0 : static_cast<double>(it->second.liveBytes) / it->second.size;
+                if (ratio < victimRatio)
+                {
+                    victim = it;
+                    victimRatio = ratio;
+                }
+            }
+
+            bool relocate = victimRatio <= options_.compactLiveRatio;
+            if (!relocate)
+                victim = segments_.begin(); // 都很"满"时按 FIFO 丢弃最旧的段
+            collectSegment(victim->first, relocate);
+        }
+    }
+
+    /**
+     * @brief 回收一个段：顺序扫描其中的记录 仍被索引引用的记录要么搬迁到当前段 要么从索引删除
+     */
+    void collectSegment(uint32_t segmentId, bool relocate)
+    {
+        Segment segment = segments_.at(segmentId);
+        std::string buffer(segment.size, '\0');
+        bool readable = segment.size == 0 || readAt(segment.fd, &buffer[0], buffer.size(), 0);
+
+        uint64_t offset = 0;
+        while (readable && offset + sizeof(RecordHeader) <= segment.size)
+        {
+            RecordHeader header;
+            std::memcpy(&header, buffer.data() + offset, sizeof(RecordHeader));
+            uint64_t length = sizeof(RecordHeader) + header.keyLen + header.valueLen;
+
+            Key key;
+            if (KTierSerializer<Key>::read(buffer.data() + offset + sizeof(RecordHeader), header.keyLen, key))
+            {
+                auto it = index_.find(key);
+                if (it != index_.end() && it->second.segmentId == segmentId && it->second.offset == offset)
+                {
+                    if (relocate && append(key, buffer.substr(offset, length)))
+                    {
+                        ++stats_.gcRelocated;
+                    }
+                    else
+                    {
+                        index_.erase(key);
+                        ++stats_.gcDropped;
+                    }
+                }
+            }
+            offset += length;
+        }
+
+        // 搬迁可能打开了新段 重新查找后再删除
+        auto it = segments_.find(segmentId);
+        diskBytes_ -= it->second.size;
+        closeFile(it->second.fd);
+        std::error_code ec;
+        std::filesystem::remove(it->second.path, ec);
+        segments_.erase(it);
+
+        // 读失败时该段的索引项已无法访问 一并清理
+        if (!readable)
+        {
+            for (auto idx = index_.begin(); idx != index_.end();)
+            {
+                if (idx->second.segmentId == segmentId)
+                    idx = index_.erase(idx);
+                else
+                    ++idx;
+            }
+        }
+    }
+
+    // 平台相关的文件操作 POSIX 下使用 pread/pwrite 按偏移读写 不移动文件指针
+    static int openFile(const std::string& path)
+    {
+#ifdef _WIN32
+        return _open(path.c_str(), _O_CREAT | _O_TRUNC | _O_RDWR | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+        return ::open(path.c_str(), O_CREAT | O_TRUNC | O_RDWR, 0644);
+#endif
+    }
+
+    static void closeFile(int fd)
+    {
+        if (fd < 0)
+            return;
+#ifdef _WIN32
+        _close(fd);
+#else
+        ::close(fd);
+#endif
+    }
+
+    static bool writeAt(int fd, const char* data, size_t size, uint64_t offset)
+    {
+        if (fd < 0)
+            return false;
+#ifdef _WIN32
+        if (_lseeki64(fd, static_cast<__int64>(offset), SEEK_SET) < 0)
+            return false;
+        return _write(fd, data, static_cast<unsigned int>(size)) == static_cast<int>(size);
+#else
+        while (size > 0)
+        {
+            ssize_t written = ::pwrite(fd, data, size, static_cast<off_t>(offset));
+            if (written <= 0)
+                return false;
+            data += written;
+            size -= static_cast<size_t>(written);
+            offset += static_cast<uint64_t>(written);
+        }
+        return true;
+#endif
+    }
+
+    static bool readAt(int fd, char* data, size_t size, uint64_t offset)
+    {
+        if (fd < 0)
+            return false;
+#ifdef _WIN32
+        if (_lseeki64(fd, static_cast<__int64>(offset), SEEK_SET) < 0)
+            return false;
+        return _read(fd, data, static_cast<unsigned int>(size)) == static_cast<int>(size);
+#else
+        while (size > 0)
+        {
+            ssize_t got = ::pread(fd, data, size, static_cast<off_t>(offset));
+            if (got <= 0)
+                return false;
+            data += got;
+            size -= static_cast<size_t>(got);
+            offset += static_cast<uint64_t>(got);
+        }
+        return true;
+#endif
+    }
+
+private:
+    KFileTierOptions                  options_;       // 配置
+    uint32_t                          nextSegmentId_; // 下一个段号 单调递增
+    uint64_t                          diskBytes_;     // 所有段文件的总字节数
+    std::map<uint32_t, Segment>       segments_;      // 段号 -> 段 按段号有序 最后一个为当前写入段
+    std::unordered_map<Key, Location> index_;         // key -> 记录位置 的紧凑索引
+    KFileTierStats                    stats_;         // 运行统计
+    std::mutex                        mutex_;         // 互斥锁
+};
+
+} // namespace KamaCache
@@ -0,0 +1,251 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "../KICachePolicy.h"
+#include "KFileTier.h"
+
+namespace KamaCache
+{
+
+/**
+ * @brief 二级缓存的命中统计
+ */
+struct KTieredCacheStats
+{
+    size_t memoryHits = 0; // 内存层命中
+    size_t fileHits = 0;   // 文件层命中(随后晋升回内存层)
+    size_t misses = 0;     // 两层都未命中
+};
+
+/**
+ * @brief 两级缓存：内存淘汰策略 + 日志结构文件层
+ *
+ * 内存层可以是任意 KICachePolicy(KLruCache / KLfuCache / KArcCache ...)，
+ * 其淘汰的数据通过淘汰回调写入 KFileTier，而不是直接丢弃；
+ * get 在内存层未命中时读取文件层，命中后把数据晋升回内存层(同时从文件层删除)。
+ * 同一时刻一个 key 最多只在一层中有效，put 总是写内存层并使文件层的旧副本失效。
+ *
+ * 淘汰回调在内存层的锁内执行，不能在这里做磁盘 I/O，否则内存层(或分片缓存的该分片)上的所有读写
+ * 都要等待 pwrite。回调只把淘汰的数据放入溢出队列，由刚完成内存层调用、已经离开内存层锁的线程
+ * 写入文件层(同一时间只有一个线程在写)。数据在写完文件层之后才离开队列，get 先查队列再查文件层，
+ * 写入途中的条目不会被漏掉。
+ */
+template<typename Key, typename Value>
+class KTieredCache : public KICachePolicy<Key, Value>
+{
+public:
+    KTieredCache(std::unique_ptr<KICachePolicy<Key, Value>> memoryTier, const KFileTierOptions& options)
+        : memoryTier_(std::move(memoryTier))
+        , fileTier_(options)
+        , memoryHits_(0)
+        , fileHits_(0)
+        , misses_(0)
+    {
+        // 回调在内存层的锁内执行 只入队 由 drainSpill 在锁外写入文件层
+        memoryTier_->setEvictCallback([this](const Key& key, const Value& value) {
+            std::lock_guard<std::mutex> lock(spillMutex_);
+            spill_.push_back(Spilled{key, value, nextSpillSeq_++});
+        });
+    }
+
+    ~KTieredCache() override = default;
+
+    void put(Key key, Value value) override
+    {
+        {
+            std::lock_guard<std::mutex> lock(stripeOf(key));
+            // 先删旧副本再写内存：写入内存后新值可能立即被其他线程的操作淘汰进溢出队列，之后再删会把新值一起删掉。
+            // 两步之间 key 不在任何一层 并发的 get 在分段锁下重新读内存层 不会错过新值
+            cancelSpilled(key);
+            fileTier_.erase(key);
+            memoryTier_->put(key, value);
+        }
+        drainSpill();
+    }
+
+    bool get(Key key, Value& value) override
+    {
+        if (memoryTier_->get(key, value))
+        {
+            ++memoryHits_;
+            return true;
+        }
+
+        bool found;
+        {
+            // 晋升与 put、溢出队列的写出使用同一把分段锁 防止旧值覆盖并发写入的新值
+            std::lock_guard<std::mutex> lock(stripeOf(key));
+            // 等锁期间其他线程可能已经把它晋升回内存层
+            if (memoryTier_->get(key, value))
+            {
+                ++memoryHits_;
+                return true;
+            }
+            found = takeSpilled(key, value) || fileTier_.take(key, value);
+            if (found)
+                memoryTier_->put(key, value);
+        }
+        if (!found)
+        {
+            ++misses_;
+            return false;
+        }
+        ++fileHits_;
+        drainSpill(); // 晋升可能淘汰了其他条目
+        return true;
+    }
+
+    Value get(Key key) override
+    {
+        Value value{};
+        get(key, value);
+        return value;
+    }
+
+    // 在 key 所在的层原地更新 文件层中的条目不晋升
+    bool updateIfPresent(Key key, Value value) override
+    {
+        std::lock_guard<std::mutex> lock(stripeOf(key));
+        if (memoryTier_->updateIfPresent(key, value))
+            return true;
+        return updateSpilled(key, value) || fileTier_.update(key, value);
+    }
+
+    // 只调整内存层 缩容淘汰的数据照常写入文件层
+    void setCapacity(size_t capacity) override
+    {
+        memoryTier_->setCapacity(capacity);
+        drainSpill();
+    }
+
+    size_t trim(size_t maxEvictions) override
+    {
+        size_t remaining = memoryTier_->trim(maxEvictions);
+        drainSpill();
+        return remaining;
+    }
+
+    KTieredCacheStats stats() const
+    {
+        KTieredCacheStats result;
+        result.memoryHits = memoryHits_.load(std::memory_order_relaxed);
+        result.fileHits = fileHits_.load(std::memory_order_relaxed);
+        result.misses = misses_.load(std::memory_order_relaxed);
+        return result;
+    }
+
+    KFileTierStats fileStats() { return fileTier_.stats(); }
+
+private:
+    // 内存层淘汰、等待写入文件层的条目
+    struct Spilled
+    {
+        Key      key;
+        Value    value;
+        uint64_t seq; // 入队序号 用于确认队首在写文件期间没有被取走
+    };
+
+    std::mutex& stripeOf(const Key& key)
+    {
+        return stripes_[std::hash<Key>{}(key) % stripes_.size()];
+    }
+
+    // 以下三个函数持有 key 的分段锁
+    // 从溢出队列取走 key 用于晋升 同一个 key 可能被淘汰过多次 取最新的一条并丢弃其余
+    bool takeSpilled(const Key& key, Value& value)
+    {
+        std::lock_guard<std::mutex> lock(spillMutex_);
+        bool found = false;
+        for (auto it = spill_.begin(); it != spill_.end();)
+        {
+            if (it->key == key)
+            {
+                value = std::move(it->value);
+                found = true;
+                it = spill_.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        return found;
+    }
+
+    void cancelSpilled(const Key& key)
+    {
+        Value ignored;
+        takeSpilled(key, ignored);
+    }
+
+    bool updateSpilled(const Key& key, const Value& value)
+    {
+        std::lock_guard<std::mutex> lock(spillMutex_);
+        bool found = false;
+        for (Spilled& entry : spill_)
+        {
+            if (entry.key == key)
+            {
+                entry.value = value;
+                found = true;
+            }
+        }
+        return found;
+    }
+
+    // 把溢出队列写入文件层 调用方不能持有内存层的锁或任何分段锁
+    // 已经有线程在写时直接返回 新入队的条目由它或下一次调用写出
+    void drainSpill()
+    {
+        std::unique_lock<std::mutex> drainLock(drainMutex_, std::try_to_lock);
+        if (!drainLock.owns_lock())
+            return;
+        while (true)
+        {
+            Key key;
+            uint64_t seq;
+            {
+                std::lock_guard<std::mutex> lock(spillMutex_);
+                if (spill_.empty())
+                    return;
+                key = spill_.front().key;
+                seq = spill_.front().seq;
+            }
+            // 持有分段锁写文件：同一个 key 的晋升与 put 等待写完 不会在写入途中错过它或被旧值覆盖
+            std::lock_guard<std::mutex> stripeLock(stripeOf(key));
+            Value value;
+            {
+                std::lock_guard<std::mutex> lock(spillMutex_);
+                // 等分段锁期间队首可能已被晋升或 put 取走
+                if (spill_.empty() || spill_.front().seq != seq)
+                    continue;
+                value = spill_.front().value;
+            }
+            fileTier_.put(key, value);
+            // 持有分段锁期间队首不会被取走 只有这里出队
+            std::lock_guard<std::mutex> lock(spillMutex_);
+            spill_.pop_front();
+        }
+    }
+
+private:
+    std::unique_ptr<KICachePolicy<Key, Value>> memoryTier_; // 内存层
+    KFileTier<Key, Value>                      fileTier_;   // 文件层
+    std::array<std::mutex, 64>                 stripes_;    // 按 key 分段的锁 串行化同一 key 的写入、晋升与写出
+    std::deque<Spilled>                        spill_;      // 溢出队列 内存层淘汰、尚未写入文件层的条目
+    uint64_t                                   nextSpillSeq_ = 0;
+    std::mutex                                 spillMutex_; // 保护 spill_ 只在内存操作期间持有
+    std::mutex                                 drainMutex_; // 同一时间只有一个线程写出溢出队列
+    std::atomic<size_t>                        memoryHits_;
+    std::atomic<size_t>                        fileHits_;
+    std::atomic<size_t>                        misses_;
+};
+
+} // namespace KamaCache
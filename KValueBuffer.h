@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace KamaCache
+{
+
+/**
+ * @brief 不可变、引用计数的值缓冲区 用作缓存的 Value 类型
+ *
+ * 以 std::string 作为 Value 时，每次 get 都要在分片锁内把整个值拷贝出来，值越大命中越慢。
+ * 把值存成 KSharedBuffer 后：
+ * 1. 头部(引用计数与长度)与数据在同一次分配中，数据紧跟在头部之后。
+ * 2. 拷贝句柄只是一次原子加一，get 的开销与值的大小无关；移动句柄不触碰引用计数。
+ * 3. 数据创建后不可修改，任意多个线程可以同时读取同一个缓冲区而不需要加锁。
+ * 4. 缓存淘汰或覆盖时只是释放缓存自己的那份引用，读者手里的句柄仍然有效，最后一个句柄析构时才释放内存。
+ *
+ * 例：KHashLruCaches<Key, KSharedBuffer> cache(...);
+ *     cache.put(key, KSharedBuffer::fromString(blob));
+ *     KSharedBuffer value; if (cache.get(key, value)) use(value.view());
+ */
+class KSharedBuffer
+{
+private:
+    struct Header
+    {
+        std::atomic<uint32_t> refs;
+        size_t                size;
+    };
+
+public:
+    KSharedBuffer() noexcept
+        : header_(nullptr)
+    {}
+
+    // 分配 size 字节并由 fill(char* data) 一次性写入内容 之后不可再修改
+    template<typename Fill>
+    static KSharedBuffer build(size_t size, Fill&& fill)
+    {
+        void* memory = ::operator new(sizeof(Header) + size);
+        Header* header = new (memory) Header{{1}, size};
+        fill(reinterpret_cast<char*>(header + 1));
+        return KSharedBuffer(header);
+    }
+
+    static KSharedBuffer copyOf(const void* data, size_t size)
+    {
+        return build(size, [&](char* dst) { if (size > 0) std::memcpy(dst, data, size); });
+    }
+
+    static KSharedBuffer fromString(std::string_view text)
+    {
+        return copyOf(text.data(), text.size());
+    }
+
+    KSharedBuffer(const KSharedBuffer& other) noexcept
+        : header_(other.header_)
+    {
+        if (header_)
+            header_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    KSharedBuffer(KSharedBuffer&& other) noexcept
+        : header_(other.header_)
+    {
+        other.header_ = nullptr;
+    }
+
+    KSharedBuffer& operator=(KSharedBuffer other) noexcept
+    {
+        std::swap(header_, other.header_);
+        return *this;
+    }
+
+    ~KSharedBuffer() { release(); }
+
+    const char* data() const { return header_ ? reinterpret_cast<const char*>(header_ + 1) : nullptr; }
+    size_t size() const { return header_ ? header_->size : 0; }
+    bool empty() const { return size() == 0; }
+    std::string_view view() const { return std::string_view(data(), size()); }
+    std::string toString() const { return std::string(data(), size()); }
+
+    // 当前共享这份数据的句柄数 空句柄返回 0
+    uint32_t useCount() const { return header_ ? header_->refs.load(std::memory_order_relaxed) : 0; }
+
+    explicit operator bool() const { return header_ != nullptr; }
+
+    // 按内容比较
+    friend bool operator==(const KSharedBuffer& a, const KSharedBuffer& b) { return a.view() == b.view(); }
+    friend bool operator!=(const KSharedBuffer& a, const KSharedBuffer& b) { return !(a == b); }
+
+private:
+    explicit KSharedBuffer(Header* header) noexcept
+        : header_(header)
+    {}
+
+    void release() noexcept
+    {
+        if (header_ && header_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            header_->~Header();
+            ::operator delete(header_);
+        }
+        header_ = nullptr;
+    }
+
+private:
+    Header* header_;
+};
+
+} // namespace KamaCache
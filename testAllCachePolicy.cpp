@@ -6,15 +6,49 @@
 #include <random>
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <memory>
+#include <thread>
 // Windows 平台特定头文件，用于设置控制台 UTF-8 编码
 #ifdef _WIN32
 #include <windows.h>
 #endif
+// Linux 平台 perf 计数器 用于统计 dTLB 未命中
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 #include "KICachePolicy.h"
+#include "KAdaptiveCache.h"
 #include "KLfuCache.h"
 #include "KLruCache.h"
 #include "KArcCache/KArcCache.h"
+#include "KArcCache/KCarCache.h"
+#include "KCache/KCache.h"
+#include "KEpoch/KEpochLruCache.h"
+#include "KAdmission/KDoorkeeperCache.h"
+#include "KAdmission/KScanResistantCache.h"
+#include "KGdsfCache.h"
+#include "KHotReplicatedCache.h"
+#include "KHugePage.h"
+#include "KLirsCache.h"
+#include "KLrfuCache.h"
+#include "KNearCache.h"
+#include "KLoadingCache/KLoadingCache.h"
+#include "KMaintenanceThread.h"
+#include "KSieveCache.h"
+#include "KSlab/KSlabCache.h"
+#include "KSlruCache.h"
+#include "KS3FifoCache/KS3FifoCache.h"
+#include "KS3FifoCache/KRingS3FifoCache.h"
+#include "KTieredCache/KTieredCache.h"
+#include "KValueBuffer.h"
 
 class Timer {
 public:
@@ -29,23 +63,80 @@ private:
     std::chrono::time_point<std::chrono::high_resolution_clock> start_;
 };
 
-// 辅助函数：打印结果
+// dTLB 读访问与未命中计数 只统计用户态 在之后创建的线程上继承
+// 没有权限(perf_event_paranoid)或虚拟机不支持硬件计数器时 available() 为 false
+class DtlbCounters {
+public:
+    DtlbCounters() {
+#ifdef __linux__
+        accessFd_ = open(PERF_COUNT_HW_CACHE_RESULT_ACCESS);
+        missFd_ = open(PERF_COUNT_HW_CACHE_RESULT_MISS);
+#endif
+    }
+
+    ~DtlbCounters() {
+#ifdef __linux__
+        if (accessFd_ >= 0) close(accessFd_);
+        if (missFd_ >= 0) close(missFd_);
+#endif
+    }
+
+    bool available() const { return accessFd_ >= 0 && missFd_ >= 0; }
+
+    void start() {
+#ifdef __linux__
+        if (!available()) return;
+        ioctl(accessFd_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(missFd_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(accessFd_, PERF_EVENT_IOC_ENABLE, 0);
+        ioctl(missFd_, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    // 停止计数 返回未命中率 计数器不可用时返回负数
+    double stop() {
+#ifdef __linux__
+        if (!available()) return -1;
+        ioctl(accessFd_, PERF_EVENT_IOC_DISABLE, 0);
+        ioctl(missFd_, PERF_EVENT_IOC_DISABLE, 0);
+        long long accesses = 0, misses = 0;
+        if (read(accessFd_, &accesses, sizeof(accesses)) != sizeof(accesses) ||
+            read(missFd_, &misses, sizeof(misses)) != sizeof(misses) || accesses <= 0) {
+            return -1;
+        }
+        return static_cast<double>(misses) / accesses;
+#else
+        return -1;
+#endif
+    }
+
+private:
+#ifdef __linux__
+    static int open(uint64_t result) {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (result << 16);
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+#endif
+
+    int accessFd_ = -1;
+    int missFd_ = -1;
+};
+
+// 辅助函数：打印结果 算法名称由测试函数传入 与 caches 数组一一对应
 void printResults(const std::string& testName, int capacity, 
+                 const std::vector<std::string>& names,
                  const std::vector<int>& get_operations, 
                  const std::vector<int>& hits) {
     std::cout << "=== " << testName << " 结果汇总 ===" << std::endl;
     std::cout << "缓存大小: " << capacity << std::endl;
     
-    // 假设对应的算法名称已在测试函数中定义
-    std::vector<std::string> names;
-    if (hits.size() == 3) {
-        names = {"LRU", "LFU", "ARC"};
-    } else if (hits.size() == 4) {
-        names = {"LRU", "LFU", "ARC", "LRU-K"};
-    } else if (hits.size() == 5) {
-        names = {"LRU", "LFU", "ARC", "LRU-K", "LFU-Aging"};
-    }
-    
     for (size_t i = 0; i < hits.size(); ++i) {
         double hitRate = 100.0 * hits[i] / get_operations[i];
         std::cout << (i < names.size() ? names[i] : "Algorithm " + std::to_string(i+1)) 
@@ -75,6 +166,15 @@ void testHotDataAccess() {
     // - k=2表示数据被访问2次后才会进入缓存，适合区分热点和冷数据
     KamaCache::KLruKCache<int, std::string> lruk(CAPACITY, HOT_KEYS + COLD_KEYS, 2);
     KamaCache::KLfuCache<int, std::string> lfuAging(CAPACITY, 20000);
+    KamaCache::KSieveCache<int, std::string> sieve(CAPACITY);
+    KamaCache::KS3FifoCache<int, std::string> s3fifo(CAPACITY);
+    KamaCache::KLirsCache<int, std::string> lirs(CAPACITY);
+    KamaCache::KCarCache<int, std::string> car(CAPACITY);
+    KamaCache::KSlruCache<int, std::string> slru(CAPACITY);
+    KamaCache::KLrfuCache<int, std::string> lrfu(CAPACITY);
+    // LRU 外面包一层布隆过滤器门卫 窗口取容量的 4 倍
+    KamaCache::KDoorkeeperCache<int, std::string> doorLru(
+        std::make_unique<KamaCache::KLruCache<int, std::string>>(CAPACITY), CAPACITY * 4);
 
     /**
      * @brief 一种更现代的随机数生成方法
@@ -84,13 +184,13 @@ void testHotDataAccess() {
     std::mt19937 gen(rd());
     
     // 基类指针指向派生类对象，添加LFU-Aging
-    std::array<KamaCache::KICachePolicy<int, std::string>*, 5> caches = {&lru, &lfu, &arc, &lruk, &lfuAging};
-    std::vector<int> hits(5, 0);
-    std::vector<int> get_operations(5, 0);
-    std::vector<std::string> names = {"LRU", "LFU", "ARC", "LRU-K", "LFU-Aging"};
+    std::array<KamaCache::KICachePolicy<int, std::string>*, 12> caches = {&lru, &lfu, &arc, &lruk, &lfuAging, &sieve, &s3fifo, &lirs, &car, &slru, &lrfu, &doorLru};
+    std::vector<int> hits(caches.size(), 0);
+    std::vector<int> get_operations(caches.size(), 0);
+    std::vector<std::string> names = {"LRU", "LFU", "ARC", "LRU-K", "LFU-Aging", "SIEVE", "S3-FIFO", "LIRS", "CAR", "SLRU", "LRFU", "LRU+门卫"};
 
     // 为所有的缓存对象进行相同的操作序列测试
-    for (int i = 0; i < caches.size(); ++i) {
+    for (size_t i = 0; i < caches.size(); ++i) {
         // 先预热缓存，插入一些数据
         for (int key = 0; key < HOT_KEYS; ++key) {
             std::string value = "value" + std::to_string(key);
@@ -127,7 +227,36 @@ void testHotDataAccess() {
     }
 
     // 打印测试结果
-    printResults("热点数据访问测试", CAPACITY, get_operations, hits);
+    printResults("热点数据访问测试", CAPACITY, names, get_operations, hits);
+    KamaCache::KAdmissionStats admission = doorLru.stats();
+    std::cout << "LRU+门卫 准入率: " << std::fixed << std::setprecision(2) << 100.0 * admission.admissionRate()
+              << "% (准入 " << admission.admitted << " 拒绝 " << admission.rejected
+              << " 轮换 " << admission.rotations << " 过滤器 " << doorLru.filterBytes() << " 字节)" << std::endl;
+
+    // 门卫拒绝写入时用 updateIfPresent 刷新旧值：已有的 key 更新值但不算一次访问 不存在的 key 不写入
+    for (size_t i = 0; i < caches.size(); ++i) {
+        caches[i]->setCapacity(CAPACITY);
+        for (int key = 0; key < 2 * CAPACITY; ++key) {
+            caches[i]->put(-1 - key, "filler");
+        }
+        caches[i]->put(-1, "old");
+        bool updated = caches[i]->updateIfPresent(-1, "new");
+        bool inserted = caches[i]->updateIfPresent(-1000000, "absent");
+        std::string result;
+        bool ok = updated && !inserted && !caches[i]->get(-1000000, result) &&
+                  caches[i]->get(-1, result) && result == "new";
+        if (!ok) {
+            std::cout << names[i] << " updateIfPresent 检查失败" << std::endl;
+        }
+    }
+    // LRU 中更新过的 key 仍是最久未访问的 会最先被淘汰
+    KamaCache::KLruCache<int, std::string> order(2);
+    order.put(1, "a");
+    order.put(2, "b");
+    order.updateIfPresent(1, "c");
+    order.put(3, "d");
+    std::string evicted;
+    std::cout << "updateIfPresent 不提升访问顺序: " << (order.get(1, evicted) ? "失败" : "通过") << std::endl;
 }
 
 void testLoopPattern() {
@@ -145,17 +274,26 @@ void testLoopPattern() {
     // - k=2，对于循环访问，这是一个合理的阈值
     KamaCache::KLruKCache<int, std::string> lruk(CAPACITY, LOOP_SIZE * 2, 2);
     KamaCache::KLfuCache<int, std::string> lfuAging(CAPACITY, 3000);
+    KamaCache::KSieveCache<int, std::string> sieve(CAPACITY);
+    KamaCache::KS3FifoCache<int, std::string> s3fifo(CAPACITY);
+    KamaCache::KLirsCache<int, std::string> lirs(CAPACITY);
+    KamaCache::KCarCache<int, std::string> car(CAPACITY);
+    KamaCache::KSlruCache<int, std::string> slru(CAPACITY);
+    KamaCache::KLrfuCache<int, std::string> lrfu(CAPACITY);
+    // LRU 外面包一层布隆过滤器门卫 窗口取容量的 4 倍
+    KamaCache::KDoorkeeperCache<int, std::string> doorLru(
+        std::make_unique<KamaCache::KLruCache<int, std::string>>(CAPACITY), CAPACITY * 4);
 
-    std::array<KamaCache::KICachePolicy<int, std::string>*, 5> caches = {&lru, &lfu, &arc, &lruk, &lfuAging};
-    std::vector<int> hits(5, 0);
-    std::vector<int> get_operations(5, 0);
-    std::vector<std::string> names = {"LRU", "LFU", "ARC", "LRU-K", "LFU-Aging"};
+    std::array<KamaCache::KICachePolicy<int, std::string>*, 12> caches = {&lru, &lfu, &arc, &lruk, &lfuAging, &sieve, &s3fifo, &lirs, &car, &slru, &lrfu, &doorLru};
+    std::vector<int> hits(caches.size(), 0);
+    std::vector<int> get_operations(caches.size(), 0);
+    std::vector<std::string> names = {"LRU", "LFU", "ARC", "LRU-K", "LFU-Aging", "SIEVE", "S3-FIFO", "LIRS", "CAR", "SLRU", "LRFU", "LRU+门卫"};
 
     std::random_device rd;
     std::mt19937 gen(rd());
 
     // 为每种缓存算法运行相同的测试
-    for (int i = 0; i < caches.size(); ++i) {
+    for (size_t i = 0; i < caches.size(); ++i) {
         // 先预热一部分数据（只加载20%的数据）
         for (int key = 0; key < LOOP_SIZE / 5; ++key) {
             std::string value = "loop" + std::to_string(key);
@@ -196,7 +334,7 @@ void testLoopPattern() {
         }
     }
 
-    printResults("循环扫描测试", CAPACITY, get_operations, hits);
+    printResults("循环扫描测试", CAPACITY, names, get_operations, hits);
 }
 
 void testWorkloadShift() {
@@ -211,16 +349,25 @@ void testWorkloadShift() {
     KamaCache::KArcCache<int, std::string> arc(CAPACITY);
     KamaCache::KLruKCache<int, std::string> lruk(CAPACITY, 500, 2);
     KamaCache::KLfuCache<int, std::string> lfuAging(CAPACITY, 10000);
+    KamaCache::KSieveCache<int, std::string> sieve(CAPACITY);
+    KamaCache::KS3FifoCache<int, std::string> s3fifo(CAPACITY);
+    KamaCache::KLirsCache<int, std::string> lirs(CAPACITY);
+    KamaCache::KCarCache<int, std::string> car(CAPACITY);
+    KamaCache::KSlruCache<int, std::string> slru(CAPACITY);
+    KamaCache::KLrfuCache<int, std::string> lrfu(CAPACITY);
+    // LRU 外面包一层布隆过滤器门卫 窗口取容量的 4 倍
+    KamaCache::KDoorkeeperCache<int, std::string> doorLru(
+        std::make_unique<KamaCache::KLruCache<int, std::string>>(CAPACITY), CAPACITY * 4);
 
     std::random_device rd;
     std::mt19937 gen(rd());
-    std::array<KamaCache::KICachePolicy<int, std::string>*, 5> caches = {&lru, &lfu, &arc, &lruk, &lfuAging};
-    std::vector<int> hits(5, 0);
-    std::vector<int> get_operations(5, 0);
-    std::vector<std::string> names = {"LRU", "LFU", "ARC", "LRU-K", "LFU-Aging"};
+    std::array<KamaCache::KICachePolicy<int, std::string>*, 12> caches = {&lru, &lfu, &arc, &lruk, &lfuAging, &sieve, &s3fifo, &lirs, &car, &slru, &lrfu, &doorLru};
+    std::vector<int> hits(caches.size(), 0);
+    std::vector<int> get_operations(caches.size(), 0);
+    std::vector<std::string> names = {"LRU", "LFU", "ARC", "LRU-K", "LFU-Aging", "SIEVE", "S3-FIFO", "LIRS", "CAR", "SLRU", "LRFU", "LRU+门卫"};
 
     // 为每种缓存算法运行相同的测试
-    for (int i = 0; i < caches.size(); ++i) { 
+    for (size_t i = 0; i < caches.size(); ++i) {
         // 先预热缓存，只插入少量初始数据
         for (int key = 0; key < 30; ++key) {
             std::string value = "init" + std::to_string(key);
@@ -284,10 +431,1454 @@ void testWorkloadShift() {
         }
     }
 
-    printResults("工作负载剧烈变化测试", CAPACITY, get_operations, hits);
+    printResults("工作负载剧烈变化测试", CAPACITY, names, get_operations, hits);
+}
+
+void testTieredCache() {
+    std::cout << "\n=== 测试场景4：二级文件缓存测试 ===" << std::endl;
+
+    const int CAPACITY = 50;          // 内存层容量
+    const int OPERATIONS = 200000;    // 总操作次数
+    const int HOT_KEYS = 20;          // 热点数据数量
+    const int COLD_KEYS = 5000;       // 冷数据数量
+
+    // 使用本地临时目录存放段文件
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "kamacache_tier_test";
+    std::filesystem::remove_all(dir);
+
+    {   // 缓存析构时关闭并删除段文件 之后再清理目录
+        KamaCache::KFileTierOptions options;
+        options.directory = (dir / "large").string();
+        options.segmentBytes = 256 << 10;
+        options.maxBytes = 16 << 20;      // 足够容纳全部冷数据
+        KamaCache::KFileTierOptions bounded = options;
+        bounded.directory = (dir / "bounded").string();
+        bounded.maxBytes = 1 << 20;       // 只能容纳部分冷数据 触发段级垃圾回收
+
+        KamaCache::KLruCache<int, std::string> lru(CAPACITY);
+        KamaCache::KTieredCache<int, std::string> tiered(
+            std::make_unique<KamaCache::KLruCache<int, std::string>>(CAPACITY), options);
+        KamaCache::KFileTierOptions arcOptions = options;
+        arcOptions.directory = (dir / "arc").string();
+        KamaCache::KTieredCache<int, std::string> tieredArc(
+            std::make_unique<KamaCache::KArcCache<int, std::string>>(CAPACITY), arcOptions);
+        KamaCache::KTieredCache<int, std::string> tieredBounded(
+            std::make_unique<KamaCache::KLruCache<int, std::string>>(CAPACITY), bounded);
+
+        std::array<KamaCache::KICachePolicy<int, std::string>*, 4> caches = {&lru, &tiered, &tieredArc, &tieredBounded};
+        std::vector<std::string> names = {"LRU(仅内存)", "LRU+文件层", "ARC+文件层", "LRU+文件层(1MB)"};
+        std::vector<int> hits(caches.size(), 0);
+        std::vector<int> get_operations(caches.size(), 0);
+        std::vector<double> elapsed(caches.size(), 0);
+
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        // 模拟较大的值 使文件层有真实的读写量
+        const std::string payload(200, 'x');
+
+        for (size_t i = 0; i < caches.size(); ++i) {
+            Timer timer;
+            for (int op = 0; op < OPERATIONS; ++op) {
+                int key = (gen() % 100 < 70) ? gen() % HOT_KEYS : HOT_KEYS + gen() % COLD_KEYS;
+                std::string result;
+                get_operations[i]++;
+                if (caches[i]->get(key, result)) {
+                    hits[i]++;
+                } else {
+                    // 未命中时回源并写入缓存
+                    caches[i]->put(key, payload + std::to_string(key));
+                }
+            }
+            elapsed[i] = timer.elapsed();
+        }
+
+        std::cout << "=== 二级文件缓存测试 结果汇总 ===" << std::endl;
+        std::cout << "内存层大小: " << CAPACITY << std::endl;
+        for (size_t i = 0; i < caches.size(); ++i) {
+            std::cout << names[i] << " - 命中率: " << std::fixed << std::setprecision(2)
+                      << 100.0 * hits[i] / get_operations[i] << "% "
+                      << "(" << hits[i] << "/" << get_operations[i] << ") 耗时: " << elapsed[i] << "ms" << std::endl;
+        }
+        for (auto* tier : {&tiered, &tieredArc, &tieredBounded}) {
+            KamaCache::KTieredCacheStats stats = tier->stats();
+            KamaCache::KFileTierStats fileStats = tier->fileStats();
+            std::cout << "内存命中: " << stats.memoryHits << " 文件命中: " << stats.fileHits
+                      << " 段数: " << fileStats.segments << " 磁盘: " << fileStats.diskBytes / 1024 << "KB"
+                      << " 存活: " << fileStats.liveBytes / 1024 << "KB"
+                      << " GC搬迁/丢弃: " << fileStats.gcRelocated << "/" << fileStats.gcDropped << std::endl;
+        }
+        std::cout << std::endl;
+    }
+
+    // 多线程读写：内存层淘汰的数据先进入溢出队列 再在内存层的锁外写入文件层
+    // 每个 key 只由一个线程写入 该线程之后读到的必须是自己最后写入的值 不能丢失也不能是旧值
+    {
+        const int THREADS = 4;
+        const int KEYS = 4000;
+        KamaCache::KFileTierOptions options;
+        options.directory = (dir / "concurrent").string();
+        options.maxBytes = 16 << 20; // 足够容纳全部数据 不会因回收丢弃
+        KamaCache::KTieredCache<int, std::string> tiered(
+            std::make_unique<KamaCache::KLruCache<int, std::string>>(200), options);
+        std::atomic<int> lost{0};
+        std::atomic<int> stale{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; ++t) {
+            threads.emplace_back([&, t] {
+                std::mt19937 gen(t);
+                std::vector<std::string> written(KEYS);
+                for (int op = 0; op < 50000; ++op) {
+                    int key = gen() % KEYS;
+                    if (gen() % 3 == 0) {
+                        key = key - key % THREADS + t; // 本线程负责写入的 key
+                        written[key] = std::to_string(op);
+                        tiered.put(key, written[key]);
+                    } else {
+                        std::string result;
+                        bool hit = tiered.get(key, result);
+                        if (key % THREADS == t && !written[key].empty()) {
+                            if (!hit) {
+                                ++lost;
+                            } else if (result != written[key]) {
+                                ++stale;
+                            }
+                        }
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        std::cout << "多线程读己之写: 丢失 " << lost.load() << " 旧值 " << stale.load()
+                  << (lost.load() == 0 && stale.load() == 0 ? " 通过" : " 失败") << std::endl;
+    }
+
+    std::filesystem::remove_all(dir);
+}
+
+// 多线程吞吐量测试：多个线程对同一个分片缓存并发读写 统计每秒操作数
+template<typename Cache>
+void runThroughput(const std::string& name, Cache& cache, int threadNum, int opsPerThread, int keyRange) {
+    // 预热 让读操作以命中为主
+    for (int key = 0; key < keyRange; ++key) {
+        cache.put(key, "value" + std::to_string(key));
+    }
+
+    std::atomic<long long> totalHits{0};
+    std::vector<std::thread> threads;
+    Timer timer;
+    for (int t = 0; t < threadNum; ++t) {
+        threads.emplace_back([&, t] {
+            std::mt19937 gen(t);
+            long long hits = 0;
+            std::string result;
+            for (int op = 0; op < opsPerThread; ++op) {
+                // 80%访问前20%的热点键 读写比 9:1
+                int key = (gen() % 100 < 80) ? gen() % (keyRange / 5) : gen() % keyRange;
+                if (gen() % 10 == 0) {
+                    cache.put(key, "value" + std::to_string(key));
+                } else if (cache.get(key, result)) {
+                    ++hits;
+                }
+            }
+            totalHits += hits;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double ms = std::max(timer.elapsed(), 1.0);
+    double totalOps = static_cast<double>(threadNum) * opsPerThread;
+    std::cout << std::left << std::setw(20) << name << std::right
+              << " 吞吐量: " << std::fixed << std::setprecision(2) << totalOps / ms / 1000.0 << " Mops/s"
+              << " (耗时 " << ms << "ms, 读命中 " << totalHits.load() << ")" << std::endl;
+}
+
+void testThroughput() {
+    std::cout << "\n=== 测试场景5：多线程吞吐量测试 ===" << std::endl;
+
+    const int THREADS = 4;             // 并发线程数
+    const int OPS_PER_THREAD = 200000; // 每个线程的操作次数
+    const int CAPACITY = 4000;         // 缓存总容量
+    const int KEY_RANGE = 10000;       // 键范围
+    const int SLICES = 8;              // 分片数量
+
+    std::cout << "线程数: " << THREADS << " 分片数: " << SLICES << " 缓存大小: " << CAPACITY << std::endl;
+
+    KamaCache::KHashLruCaches<int, std::string> lru(CAPACITY, SLICES);
+    runThroughput("HashLRU", lru, THREADS, OPS_PER_THREAD, KEY_RANGE);
+    // 默认的 maxAverageNum(10) 会在几乎每次访问时触发全员降级 吞吐量测试使用较大的上限
+    KamaCache::KHashLfuCache<int, std::string> lfu(CAPACITY, SLICES, 1000000);
+    runThroughput("HashLFU", lfu, THREADS, OPS_PER_THREAD, KEY_RANGE);
+    KamaCache::KHashSieveCache<int, std::string> sieve(CAPACITY, SLICES);
+    runThroughput("HashSIEVE", sieve, THREADS, OPS_PER_THREAD, KEY_RANGE);
+    KamaCache::KHashS3FifoCache<int, std::string> s3fifo(CAPACITY, SLICES);
+    runThroughput("HashS3-FIFO", s3fifo, THREADS, OPS_PER_THREAD, KEY_RANGE);
+    KamaCache::KHashRingS3FifoCache<int, std::string> ringS3fifo(CAPACITY, SLICES);
+    runThroughput("HashS3-FIFO-Ring", ringS3fifo, THREADS, OPS_PER_THREAD, KEY_RANGE);
+    KamaCache::KHashLirsCache<int, std::string> lirs(CAPACITY, SLICES);
+    runThroughput("HashLIRS", lirs, THREADS, OPS_PER_THREAD, KEY_RANGE);
+    KamaCache::KHashCarCache<int, std::string> car(CAPACITY, SLICES);
+    runThroughput("HashCAR", car, THREADS, OPS_PER_THREAD, KEY_RANGE);
+    KamaCache::KHashSlruCache<int, std::string> slru(CAPACITY, SLICES);
+    runThroughput("HashSLRU", slru, THREADS, OPS_PER_THREAD, KEY_RANGE);
+    std::cout << std::endl;
+}
+
+// 代价感知测试：少量 key 的回源代价远高于其他 key 比较各策略的总未命中代价
+void testMissCost() {
+    std::cout << "\n=== 测试场景6：代价感知测试 ===" << std::endl;
+
+    const int CAPACITY = 200;         // 缓存容量
+    const int OPERATIONS = 300000;    // 总操作次数
+    const int KEYS = 2000;            // 键范围
+    const double CHEAP_COST = 1.0;    // 普通 key 回源代价(微秒)
+    const double COSTLY_COST = 200000.0; // 每 10 个 key 中有一个需要跨地域调用(200 毫秒)
+
+    auto costOf = [&](int key) { return key % 10 == 0 ? COSTLY_COST : CHEAP_COST; };
+
+    KamaCache::KLruCache<int, std::string> lru(CAPACITY);
+    KamaCache::KLfuCache<int, std::string> lfu(CAPACITY);
+    KamaCache::KArcCache<int, std::string> arc(CAPACITY);
+    KamaCache::KGdsfCache<int, std::string> gdsf(CAPACITY);
+
+    std::array<KamaCache::KICachePolicy<int, std::string>*, 4> caches = {&lru, &lfu, &arc, &gdsf};
+    std::vector<std::string> names = {"LRU", "LFU", "ARC", "GDSF"};
+    std::vector<int> hits(caches.size(), 0);
+    std::vector<int> get_operations(caches.size(), 0);
+    std::vector<double> missCost(caches.size(), 0);
+
+    for (size_t i = 0; i < caches.size(); ++i) {
+        std::mt19937 gen(42); // 每种策略使用相同的访问序列
+        for (int op = 0; op < OPERATIONS; ++op) {
+            // 60% 访问前 10% 的键 其余均匀分布
+            int key = (gen() % 100 < 60) ? gen() % (KEYS / 10) : gen() % KEYS;
+            std::string result;
+            get_operations[i]++;
+            if (caches[i]->get(key, result)) {
+                hits[i]++;
+                continue;
+            }
+            missCost[i] += costOf(key);
+            std::string value = "value" + std::to_string(key);
+            if (caches[i] == &gdsf) {
+                gdsf.put(key, value, costOf(key), 1); // 只有 GDSF 能利用代价信息
+            } else {
+                caches[i]->put(key, value);
+            }
+        }
+    }
+
+    printResults("代价感知测试", CAPACITY, names, get_operations, hits);
+    for (size_t i = 0; i < caches.size(); ++i) {
+        std::cout << names[i] << " - 总未命中代价: " << std::fixed << std::setprecision(2)
+                  << missCost[i] / 1000.0 << "ms" << std::endl;
+    }
+}
+
+// 自适应策略选择测试：工作负载分阶段变化 比较自适应缓存与各固定策略
+void testAdaptivePolicy() {
+    std::cout << "\n=== 测试场景7：自适应策略选择测试 ===" << std::endl;
+
+    const int CAPACITY = 500;           // 缓存容量
+    const int PHASE_OPERATIONS = 200000; // 每个阶段的操作次数
+
+    KamaCache::KAdaptiveCache<int, std::string> adaptive(CAPACITY, 0.1);
+    adaptive.addPolicy<KamaCache::KLruCache>("LRU");
+    adaptive.addPolicy<KamaCache::KLfuCache>("LFU");
+    adaptive.addPolicy<KamaCache::KArcCache>("ARC");
+    adaptive.addPolicy<KamaCache::KLirsCache>("LIRS");
+
+    KamaCache::KLruCache<int, std::string> lru(CAPACITY);
+    KamaCache::KLfuCache<int, std::string> lfu(CAPACITY);
+    KamaCache::KArcCache<int, std::string> arc(CAPACITY);
+    KamaCache::KLirsCache<int, std::string> lirs(CAPACITY);
+
+    std::array<KamaCache::KICachePolicy<int, std::string>*, 5> caches = {&adaptive, &lru, &lfu, &arc, &lirs};
+    std::vector<std::string> names = {"Adaptive", "LRU", "LFU", "ARC", "LIRS"};
+    std::vector<int> hits(caches.size(), 0);
+    std::vector<int> get_operations(caches.size(), 0);
+    std::vector<double> elapsed(caches.size(), 0);
+
+    for (size_t i = 0; i < caches.size(); ++i) {
+        std::mt19937 gen(7); // 每种策略使用相同的访问序列
+        Timer timer;
+        for (int op = 0; op < 3 * PHASE_OPERATIONS; ++op) {
+            int phase = op / PHASE_OPERATIONS;
+            int key;
+            if (phase == 0) {
+                // 阶段一：少量高频键 + 大范围一次性冷键 频率信息最有价值
+                key = (gen() % 100 < 60) ? gen() % 300 : 100000 + gen() % 1000000;
+            } else if (phase == 1) {
+                // 阶段二：略大于容量的循环扫描
+                key = 200000 + op % 600;
+            } else {
+                // 阶段三：工作集随时间平移 近期访问最有价值
+                int base = 300000 + op / 500;
+                key = base + gen() % 400;
+            }
+            std::string result;
+            get_operations[i]++;
+            if (caches[i]->get(key, result)) {
+                hits[i]++;
+            } else {
+                caches[i]->put(key, "value" + std::to_string(key));
+            }
+        }
+        elapsed[i] = timer.elapsed();
+    }
+
+    printResults("自适应策略选择测试", CAPACITY, names, get_operations, hits);
+    KamaCache::KAdaptiveStats stats = adaptive.stats();
+    std::cout << "Adaptive 当前策略: " << stats.current << " 切换次数: " << stats.switches << std::endl;
+    for (const auto& shadow : stats.shadows) {
+        std::cout << "  影子 " << shadow.name << " 容量: " << shadow.capacity
+                  << " 平滑命中率: " << std::fixed << std::setprecision(2) << 100.0 * shadow.score << "%" << std::endl;
+    }
+    std::cout << "影子模拟开销: 采样 " << stats.sampledAccesses << "/" << stats.accesses
+              << " 次访问, 影子总容量 " << stats.shadowEntries
+              << ", 模拟耗时 " << stats.shadowNanos / 1000000.0 << "ms" << std::endl;
+    for (size_t i = 0; i < caches.size(); ++i) {
+        std::cout << names[i] << " 总耗时: " << elapsed[i] << "ms" << std::endl;
+    }
+
+    // 影子开销随容量的变化：每次采样相当于在容量为 sampleRate 倍的影子缓存上做一次访问，
+    // 耗时应与同样负载下普通 LRU 的单次访问同一量级 且不随容量增长。
+    // 采样位与影子索引的桶号相关时 采样 key 挤在索引一端 每次采样的耗时随容量线性增长
+    for (int capacity : {20000, 200000}) {
+        // 同一访问序列 返回平均每次访问的耗时(纳秒)
+        auto replay = [capacity](KamaCache::KICachePolicy<int, int>& cache) {
+            const int ops = 4 * capacity;
+            std::mt19937 gen(13);
+            auto start = std::chrono::steady_clock::now();
+            for (int op = 0; op < ops; ++op) {
+                int key = gen() % (2 * capacity);
+                int result;
+                if (!cache.get(key, result)) {
+                    cache.put(key, key);
+                }
+            }
+            return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ops;
+        };
+        KamaCache::KLruCache<int, int> plain(capacity);
+        double plainNs = replay(plain);
+        KamaCache::KAdaptiveCache<int, int> scaled(capacity, 0.1);
+        scaled.addPolicy<KamaCache::KLruCache>("LRU");
+        replay(scaled);
+        KamaCache::KAdaptiveStats scaledStats = scaled.stats();
+        double perSampleNs = static_cast<double>(scaledStats.shadowNanos) / std::max<uint64_t>(scaledStats.sampledAccesses, 1);
+        std::cout << "容量 " << capacity << " 影子模拟耗时: " << std::fixed << std::setprecision(2) << scaledStats.shadowNanos / 1000000.0 << "ms"
+                  << " 每次采样: " << perSampleNs << "ns"
+                  << " 普通 LRU 每次访问: " << plainNs << "ns"
+                  << (perSampleNs < 10 * plainNs ? " 通过" : " 失败 影子开销远超一次缓存访问") << std::endl;
+    }
+}
+
+// 扫描隔离测试：交互请求的热点工作集与全表回填任务交错访问同一个缓存
+// 统计交互请求的命中率 回填先按顺序 key 扫描 再按打乱的 key 扫描(只能靠连续未命中识别)
+void testScanResistance() {
+    std::cout << "\n=== 测试场景8：扫描隔离测试 ===" << std::endl;
+
+    const int CAPACITY = 100;         // 缓存容量
+    const int HOT_KEYS = 80;          // 交互请求的工作集
+    const int OPERATIONS = 200000;    // 总操作次数 交互与回填各占一半
+    const uint64_t INTERACTIVE = 1;   // 访问流编号
+    const uint64_t BACKFILL = 2;
+
+    KamaCache::KLruCache<int, std::string> lru(CAPACITY);
+    KamaCache::KScanResistantCache<int, std::string> bypass(
+        std::make_unique<KamaCache::KLruCache<int, std::string>>(CAPACITY), KamaCache::KScanAction::Bypass);
+    KamaCache::KScanResistantCache<int, std::string> cold(
+        std::make_unique<KamaCache::KLruCache<int, std::string>>(CAPACITY), KamaCache::KScanAction::ColdInsert);
+
+    std::vector<std::string> names = {"LRU", "LRU+扫描绕过", "LRU+扫描冷端写入"};
+    std::vector<int> hits(names.size(), 0);
+    std::vector<int> get_operations(names.size(), 0);
+
+    // 打乱的回填 key 用于第二阶段
+    std::vector<int> shuffled(OPERATIONS / 2);
+    for (size_t i = 0; i < shuffled.size(); ++i) {
+        shuffled[i] = 2000000 + static_cast<int>(i);
+    }
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(3));
+
+    for (size_t i = 0; i < names.size(); ++i) {
+        std::mt19937 gen(11);
+        int backfillPos = 0;
+        auto access = [&](int key, uint64_t stream) {
+            std::string result;
+            bool hit;
+            if (i == 0) {
+                hit = lru.get(key, result);
+                if (!hit) lru.put(key, "value" + std::to_string(key));
+            } else {
+                auto& cache = (i == 1) ? bypass : cold;
+                hit = cache.get(key, result, stream);
+                if (!hit) cache.put(key, "value" + std::to_string(key), stream);
+            }
+            return hit;
+        };
+        for (int op = 0; op < OPERATIONS; ++op) {
+            if (op % 2 == 0) {
+                get_operations[i]++;
+                if (access(gen() % HOT_KEYS, INTERACTIVE)) {
+                    hits[i]++;
+                }
+            } else {
+                int key = (op < OPERATIONS / 2) ? 1000000 + backfillPos : shuffled[backfillPos];
+                ++backfillPos;
+                if (op == OPERATIONS / 2 - 1) backfillPos = 0;
+                access(key, BACKFILL);
+            }
+        }
+    }
+
+    printResults("扫描隔离测试(交互请求命中率)", CAPACITY, names, get_operations, hits);
+    std::cout << "扫描写入占比: 绕过 " << bypass.stats().scanPuts << "/" << bypass.stats().puts
+              << " 冷端 " << cold.stats().scanPuts << "/" << cold.stats().puts << std::endl;
+
+    // 只写不读的流(预热、写穿透、旁路缓存的写入方)：随机写入不是扫描 写入的条目都应驻留
+    {
+        const int WRITES = 500;
+        KamaCache::KScanResistantCache<int, int> writer(
+            std::make_unique<KamaCache::KLruCache<int, int>>(1000), KamaCache::KScanAction::Bypass);
+        std::vector<int> keys(WRITES);
+        for (int i = 0; i < WRITES; ++i) {
+            keys[i] = i * 37; // 步长超过 maxStride 不会被当成跨步扫描
+        }
+        std::shuffle(keys.begin(), keys.end(), std::mt19937(5));
+        for (int key : keys) {
+            writer.put(key, key);
+        }
+        int resident = 0;
+        for (int key : keys) {
+            // updateIfPresent 不经过扫描检测 只用来确认 key 是否驻留
+            if (writer.updateIfPresent(key, key)) {
+                ++resident;
+            }
+        }
+        std::cout << "只写流随机写入 " << WRITES << " 个 key 驻留: " << resident
+                  << " 扫描写入: " << writer.stats().scanPuts
+                  << (resident == WRITES ? " 通过" : " 失败") << std::endl;
+    }
+}
+
+void testNegativeCache() {
+    std::cout << "\n=== 测试场景9：负缓存测试 ===" << std::endl;
+
+    const int CAPACITY = 1000;        // 正缓存容量
+    const int EXISTING_KEYS = 5000;   // 后端存在的 key: [0, EXISTING_KEYS)
+    const int ABSENT_KEYS = 2000;     // 被反复查询但后端不存在的 key
+    const int OPERATIONS = 200000;    // 总查询次数
+    const int ABSENT_PERCENTAGE = 30; // 查询不存在 key 的比例
+
+    using Cache = KamaCache::KHashLruCaches<int, std::string>;
+    using Loading = KamaCache::KLoadingCache<int, std::string, Cache>;
+
+    std::vector<std::string> names = {"无负缓存", "负缓存"};
+    for (size_t i = 0; i < names.size(); ++i) {
+        std::atomic<uint64_t> backendCalls(0);
+        auto loader = [&backendCalls](const int& key, std::string& value) {
+            backendCalls.fetch_add(1, std::memory_order_relaxed);
+            if (key < 0 || key >= EXISTING_KEYS) {
+                return false;
+            }
+            value = "value" + std::to_string(key);
+            return true;
+        };
+        KamaCache::KNegativeCacheOptions options;
+        options.capacity = (i == 0) ? 0 : ABSENT_KEYS * 2;
+        Loading cache(std::make_unique<Cache>(CAPACITY, 4), loader, options);
+
+        std::mt19937 gen(42);
+        std::string result;
+        int wrong = 0;
+        for (int op = 0; op < OPERATIONS; ++op) {
+            if (gen() % 100 < ABSENT_PERCENTAGE) {
+                if (cache.get(EXISTING_KEYS + static_cast<int>(gen() % ABSENT_KEYS), result)) {
+                    wrong++;
+                }
+            } else {
+                // 存在的 key 中前 20% 承担大部分访问
+                int key = (gen() % 100 < 70) ? gen() % (EXISTING_KEYS / 5) : gen() % EXISTING_KEYS;
+                if (!cache.get(key, result)) {
+                    wrong++;
+                }
+            }
+        }
+
+        // 后端新建一个先前不存在的 key 写入后必须立即可见
+        int created = EXISTING_KEYS;
+        cache.put(created, "created");
+        bool visible = cache.get(created, result) && result == "created";
+
+        KamaCache::KLoadingStats stats = cache.stats();
+        std::cout << names[i] << " -> 回源次数: " << backendCalls.load()
+                  << " 确认不存在: " << stats.absentLoads
+                  << " 负缓存命中: " << stats.negativeHits
+                  << " 正缓存命中: " << stats.hits
+                  << " 负缓存内存: " << cache.negativeBytes() << "B"
+                  << " 结果错误: " << wrong
+                  << " 新建可见: " << (visible ? "是" : "否") << std::endl;
+    }
+
+    // 回源确认不存在的同时 key 在后端被创建并 invalidate：过时的"不存在"不能再被记录
+    {
+        bool created = false;
+        Loading* self = nullptr;
+        Loading cache(std::make_unique<Cache>(CAPACITY, 4), [&](const int& key, std::string& value) {
+            if (created) {
+                value = "created";
+                return true;
+            }
+            created = true;
+            self->invalidate(key); // 回源返回之前 后端创建了 key
+            return false;
+        });
+        self = &cache;
+        std::string result;
+        cache.get(EXISTING_KEYS, result);
+        bool visible = cache.get(EXISTING_KEYS, result) && result == "created";
+        std::cout << "回源期间创建的 key 之后可见: " << (visible ? "通过" : "失败") << std::endl;
+    }
+}
+
+// 热点 key 统计测试：少数 key 占据大量访问 检查跟踪结果与开启跟踪的开销
+void testHotKeyTracking() {
+    std::cout << "\n=== 测试场景10：热点key统计测试 ===" << std::endl;
+
+    const int THREADS = 4;             // 并发线程数
+    const int OPS_PER_THREAD = 200000; // 每个线程的操作次数
+    const int CAPACITY = 4000;         // 缓存总容量
+    const int KEY_RANGE = 10000;       // 键范围
+    const int SLICES = 8;              // 分片数量
+    const int TOP_K = 5;
+
+    // 三个热点 key 分别占 10% / 5% / 2% 的访问 其余均匀分布
+    auto nextKey = [](std::mt19937& gen) {
+        int r = gen() % 100;
+        if (r < 10) return 42;
+        if (r < 15) return 4242;
+        if (r < 17) return 777;
+        return static_cast<int>(gen() % KEY_RANGE);
+    };
+
+    for (int tracking = 0; tracking < 2; ++tracking) {
+        KamaCache::KHashLfuCache<int, std::string> cache(CAPACITY, SLICES, 1000000);
+        if (tracking) {
+            cache.enableHotKeyTracking();
+        }
+        std::vector<std::thread> threads;
+        Timer timer;
+        for (int t = 0; t < THREADS; ++t) {
+            threads.emplace_back([&, t] {
+                std::mt19937 gen(t);
+                std::string result;
+                for (int op = 0; op < OPS_PER_THREAD; ++op) {
+                    int key = nextKey(gen);
+                    if (!cache.get(key, result)) {
+                        cache.put(key, "value" + std::to_string(key));
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        double ms = std::max(timer.elapsed(), 1.0);
+        std::cout << (tracking ? "HashLFU+热点跟踪" : "HashLFU") << " -> 耗时: " << ms << "ms 吞吐量: "
+                  << std::fixed << std::setprecision(2)
+                  << THREADS * static_cast<double>(OPS_PER_THREAD) / ms / 1000.0 << " Mops/s" << std::endl;
+
+        if (tracking) {
+            std::cout << "Top " << TOP_K << " 热点key(估计访问次数 误差上界 分片):" << std::endl;
+            for (const auto& hot : cache.hotKeys(TOP_K)) {
+                std::cout << "  key " << hot.key << ": " << hot.count << " (+-" << hot.error << ") 分片 "
+                          << hot.shard << std::endl;
+            }
+            std::cout << "各分片估计访问次数:";
+            for (uint64_t load : cache.hotKeyTracker()->shardLoads()) {
+                std::cout << " " << load;
+            }
+            std::cout << std::endl;
+        }
+    }
 }
 
-int main() {
+// 热点复制测试：一个爆款 key 占据大部分读取 比较普通分片与热点复制的吞吐量 并检查写入后副本一致
+void testHotKeyReplication() {
+    std::cout << "\n=== 测试场景11：热点key复制测试 ===" << std::endl;
+
+    const int THREADS = 4;             // 并发线程数
+    const int OPS_PER_THREAD = 400000; // 每个线程的操作次数
+    const int CAPACITY = 4000;         // 缓存总容量
+    const int KEY_RANGE = 10000;       // 键范围
+    const int SLICES = 8;              // 分片数量
+    const int VIRAL_KEY = 42;          // 占 50% 读取的爆款 key
+
+    using Lru = KamaCache::KLruCache<int, std::string>;
+    KamaCache::KHashLruCaches<int, std::string> plain(CAPACITY, SLICES);
+    KamaCache::KHotReplicatedCache<int, std::string, Lru> replicated(CAPACITY, SLICES, KamaCache::KHotReplicaOptions());
+
+    auto run = [&](const std::string& name, auto& cache) {
+        for (int key = 0; key < KEY_RANGE; ++key) {
+            cache.put(key, "value" + std::to_string(key));
+        }
+        std::atomic<long long> stale{0};
+        std::vector<std::thread> threads;
+        Timer timer;
+        for (int t = 0; t < THREADS; ++t) {
+            threads.emplace_back([&, t] {
+                std::mt19937 gen(t);
+                std::string result;
+                for (int op = 0; op < OPS_PER_THREAD; ++op) {
+                    int key = (gen() % 2 == 0) ? VIRAL_KEY : static_cast<int>(gen() % KEY_RANGE);
+                    if (gen() % 1000 == 0) {
+                        cache.put(key, "value" + std::to_string(key));
+                    } else if (cache.get(key, result) && result != "value" + std::to_string(key)) {
+                        ++stale;
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        double ms = std::max(timer.elapsed(), 1.0);
+
+        // 写入后所有线程都应读到新值
+        cache.put(VIRAL_KEY, "updated");
+        std::atomic<int> mismatched{0};
+        threads.clear();
+        for (int t = 0; t < THREADS; ++t) {
+            threads.emplace_back([&] {
+                std::string result;
+                if (!cache.get(VIRAL_KEY, result) || result != "updated") {
+                    ++mismatched;
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        std::cout << name << " -> 耗时: " << ms << "ms 吞吐量: " << std::fixed << std::setprecision(2)
+                  << THREADS * static_cast<double>(OPS_PER_THREAD) / ms / 1000.0 << " Mops/s"
+                  << " 读到错误值: " << stale.load() << " 写入后不一致线程: " << mismatched.load() << std::endl;
+    };
+
+    run("HashLRU", plain);
+    run("HashLRU+热点复制", replicated);
+    std::cout << "被复制的热点key:";
+    for (int key : replicated.replicatedKeys()) {
+        std::cout << " " << key;
+    }
+    std::cout << std::endl;
+}
+
+// 近端缓存测试：读多写少的热点负载下比较分片缓存与加上线程局部 L1 后的吞吐量 并检查写入后的可见性
+void testNearCache() {
+    std::cout << "\n=== 测试场景12：线程局部近端缓存测试 ===" << std::endl;
+
+    const int THREADS = 4;             // 并发线程数
+    const int OPS_PER_THREAD = 400000; // 每个线程的操作次数
+    const int CAPACITY = 4000;         // 缓存总容量
+    const int KEY_RANGE = 10000;       // 键范围
+    const int HOT_KEYS = 200;          // 每个线程反复读取的热点
+    const int SLICES = 8;              // 分片数量
+
+    using Sharded = KamaCache::KHashLruCaches<int, std::string>;
+    Sharded plain(CAPACITY, SLICES);
+    KamaCache::KNearCache<int, std::string, Sharded> near(std::make_unique<Sharded>(CAPACITY, SLICES), 512);
+
+    auto run = [&](const std::string& name, auto& cache) {
+        for (int key = 0; key < KEY_RANGE; ++key) {
+            cache.put(key, "value" + std::to_string(key));
+        }
+        std::vector<std::thread> threads;
+        Timer timer;
+        for (int t = 0; t < THREADS; ++t) {
+            threads.emplace_back([&, t] {
+                std::mt19937 gen(t);
+                std::string result;
+                for (int op = 0; op < OPS_PER_THREAD; ++op) {
+                    // 90% 读取热点 读写比 99:1
+                    int key = (gen() % 100 < 90) ? gen() % HOT_KEYS : gen() % KEY_RANGE;
+                    if (gen() % 100 == 0) {
+                        cache.put(key, "value" + std::to_string(key));
+                    } else {
+                        cache.get(key, result);
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        double ms = std::max(timer.elapsed(), 1.0);
+        std::cout << name << " -> 耗时: " << ms << "ms 吞吐量: " << std::fixed << std::setprecision(2)
+                  << THREADS * static_cast<double>(OPS_PER_THREAD) / ms / 1000.0 << " Mops/s" << std::endl;
+    };
+
+    run("HashLRU", plain);
+    run("HashLRU+L1", near);
+
+    // 当前线程的 L1 已缓存 key 其他线程写入后这里必须读到新值
+    std::string result;
+    near.get(1, result);
+    near.get(1, result);
+    std::thread([&] { near.put(1, "updated"); }).join();
+    bool visible = near.get(1, result) && result == "updated";
+    std::cout << "本线程L1命中: " << near.localHits() << " 未命中: " << near.localMisses()
+              << " 其他线程写入后可见: " << (visible ? "是" : "否") << std::endl;
+}
+
+// 单线程访问一个缓存 返回耗时 用于比较虚函数调用与编译期组合
+template<typename Cache>
+void runSingleThread(const std::string& name, Cache& cache, const std::vector<int>& keys) {
+    int hits = 0;
+    int value = 0;
+    Timer timer;
+    for (int key : keys) {
+        if (cache.get(key, value)) {
+            ++hits;
+        } else {
+            cache.put(key, key);
+        }
+    }
+    double ms = std::max(timer.elapsed(), 1.0);
+    std::cout << std::left << std::setw(28) << name << std::right << " 耗时: " << std::fixed << std::setprecision(2)
+              << ms << "ms 吞吐量: " << keys.size() / ms / 1000.0 << " Mops/s 命中率: "
+              << 100.0 * hits / keys.size() << "%" << std::endl;
+}
+
+// 编译期组合测试：同样的淘汰逻辑 比较 KICachePolicy 虚函数调用 / 适配器 / 直接调用 / 不同索引与锁
+// virtual: 原有实现经 KICachePolicy 调用 adapter: KCache 经 KCachePolicyAdapter 调用 其余为直接调用
+void testStaticComposition() {
+    std::cout << "\n=== 测试场景13：编译期组合测试 ===" << std::endl;
+
+    const int CAPACITY = 1000;      // 缓存容量
+    const int KEY_RANGE = 5000;     // 键范围
+    const int OPERATIONS = 2000000; // 访问次数
+
+    std::vector<int> keys(OPERATIONS);
+    std::mt19937 gen(42);
+    for (int& key : keys) {
+        // 70% 访问前 10% 的 key
+        key = (gen() % 100 < 70) ? gen() % (KEY_RANGE / 10) : gen() % KEY_RANGE;
+    }
+
+    using namespace KamaCache;
+    using NoLockLru = KCache<int, int, KLruEviction, KOpenAddressIndex, KNoLock>;
+    using StdMapLru = KCache<int, int, KLruEviction, KStdMapIndex, KNoLock>;
+
+    std::vector<std::unique_ptr<KICachePolicy<int, int>>> virtualCaches;
+    virtualCaches.emplace_back(new KLruCache<int, int>(CAPACITY));
+    virtualCaches.emplace_back(new KCachePolicyAdapter<int, int, KStaticLruCache<int, int>>(CAPACITY));
+    virtualCaches.emplace_back(new KLfuCache<int, int>(CAPACITY));
+
+    runSingleThread("KLruCache(virtual)", *virtualCaches[0], keys);
+    runSingleThread("KCache LRU(adapter)", *virtualCaches[1], keys);
+    KStaticLruCache<int, int> staticLru(CAPACITY);
+    runSingleThread("KCache LRU(mutex)", staticLru, keys);
+    NoLockLru noLockLru(CAPACITY);
+    runSingleThread("KCache LRU(no lock)", noLockLru, keys);
+    StdMapLru stdMapLru(CAPACITY);
+    runSingleThread("KCache LRU(no lock, std map)", stdMapLru, keys);
+
+    runSingleThread("KLfuCache(virtual)", *virtualCaches[2], keys);
+    KStaticLfuCache<int, int> staticLfu(CAPACITY);
+    runSingleThread("KCache LFU(mutex)", staticLfu, keys);
+    // KArcEviction 是教科书式的 ARC 与 KArcCache 的算法不同 不放进这组对比
+    // 直接驱动它的淘汰逻辑 检查幽灵列表的上限 |T1| + |B1| <= c 与 |T1| + |T2| + |B1| + |B2| <= 2c
+    using ArcNode = KCacheNode<int, int, KArcEviction>;
+    KArcEviction::Policy<ArcNode> arc(CAPACITY);
+    std::vector<ArcNode> arcNodes(KEY_RANGE);
+    std::vector<bool> resident(KEY_RANGE, false);
+    size_t residents = 0;
+    size_t recent = 0; // T1 的大小
+    bool bounded = true;
+    for (int key : keys) {
+        ArcNode* node = &arcNodes[key];
+        if (resident[key]) {
+            recent -= node->frequent ? 0 : 1;
+            arc.onAccess(node);
+            continue;
+        }
+        if (residents == static_cast<size_t>(CAPACITY)) {
+            ArcNode* victim = arc.victim();
+            recent -= victim->frequent ? 0 : 1;
+            arc.onEvict(victim);
+            resident[victim->key] = false;
+            --residents;
+        }
+        node->key = key;
+        node->hash = KHashOf(key);
+        arc.onInsert(node);
+        recent += node->frequent ? 0 : 1;
+        resident[key] = true;
+        ++residents;
+        bounded = bounded && recent + arc.recentGhosts() <= static_cast<size_t>(CAPACITY) &&
+                  residents + arc.recentGhosts() + arc.frequentGhosts() <= 2 * static_cast<size_t>(CAPACITY);
+    }
+    std::cout << "KArcEviction 幽灵条目 B1: " << arc.recentGhosts() << " B2: " << arc.frequentGhosts()
+              << " 上限: " << (bounded ? "通过" : "失败") << std::endl;
+}
+
+// 锁策略测试：同一份 LRU 逻辑分别使用不同的锁策略 比较多线程吞吐量
+void testLockStrategies() {
+    std::cout << "\n=== 测试场景14：锁策略测试 ===" << std::endl;
+
+    const int THREADS = 4;             // 并发线程数
+    const int OPS_PER_THREAD = 200000; // 每个线程的操作次数
+    const int CAPACITY = 4000;         // 缓存总容量
+    const int KEY_RANGE = 10000;       // 键范围
+
+    using namespace KamaCache;
+    std::cout << "线程数: " << THREADS << " 缓存大小: " << CAPACITY << std::endl;
+    // 无锁版本只能单线程运行 作为单线程流水线的参考
+    KCache<int, std::string, KLruEviction, KOpenAddressIndex, KNoLock> noLock(CAPACITY);
+    runThroughput("NoLock(1 thread)", noLock, 1, OPS_PER_THREAD, KEY_RANGE);
+    KCache<int, std::string, KLruEviction, KOpenAddressIndex, KMutexLock> mutexLock(CAPACITY);
+    runThroughput("Mutex(1 thread)", mutexLock, 1, OPS_PER_THREAD, KEY_RANGE);
+
+    KCache<int, std::string, KLruEviction, KOpenAddressIndex, KMutexLock> mutexCache(CAPACITY);
+    runThroughput("Mutex", mutexCache, THREADS, OPS_PER_THREAD, KEY_RANGE);
+    KCache<int, std::string, KLruEviction, KOpenAddressIndex, KSpinLock> spinCache(CAPACITY);
+    runThroughput("Spin(TTAS)", spinCache, THREADS, OPS_PER_THREAD, KEY_RANGE);
+    KCache<int, std::string, KLruEviction, KOpenAddressIndex, KSharedMutexLock> sharedCache(CAPACITY);
+    runThroughput("SharedMutex", sharedCache, THREADS, OPS_PER_THREAD, KEY_RANGE);
+    KCache<int, std::string, KLruEviction, KOpenAddressIndex, KFlatCombiningLock> combiningCache(CAPACITY);
+    runThroughput("FlatCombining", combiningCache, THREADS, OPS_PER_THREAD, KEY_RANGE);
+}
+
+// 无锁读测试：读者在纪元保护下无锁查找 比较吞吐量 并检查零拷贝引用在覆盖与淘汰后仍然有效
+void testEpochReads() {
+    std::cout << "\n=== 测试场景15：纪元回收与无锁读测试 ===" << std::endl;
+
+    const int THREADS = 4;             // 并发线程数
+    const int OPS_PER_THREAD = 200000; // 每个线程的操作次数
+    const int CAPACITY = 4000;         // 缓存总容量
+    const int KEY_RANGE = 10000;       // 键范围
+    const int SLICES = 8;              // 分片数量
+
+    KamaCache::KHashLruCaches<int, std::string> lru(CAPACITY, SLICES);
+    runThroughput("HashLRU", lru, THREADS, OPS_PER_THREAD, KEY_RANGE);
+    KamaCache::KEpochLruCache<int, std::string> epochLru(CAPACITY);
+    runThroughput("EpochLRU", epochLru, THREADS, OPS_PER_THREAD, KEY_RANGE);
+    KamaCache::KHashEpochLruCache<int, std::string> hashEpochLru(CAPACITY, SLICES);
+    runThroughput("HashEpochLRU", hashEpochLru, THREADS, OPS_PER_THREAD, KEY_RANGE);
+
+    // 持有守卫期间 其他线程覆盖并淘汰该 key 引用仍指向原来的值
+    KamaCache::KEpochLruCache<int, std::string> cache(100);
+    cache.put(1, "original");
+    bool stable;
+    {
+        KamaCache::KEpochGuard guard;
+        const std::string* value = cache.find(1, guard);
+        std::thread([&] {
+            cache.put(1, "overwritten");
+            for (int key = 2; key < 1000; ++key) {
+                cache.put(key, "filler");
+            }
+        }).join();
+        KamaCache::KEpochDomain::global().reclaim();
+        stable = value && *value == "original";
+    }
+    KamaCache::KEpochDomain::global().reclaim();
+    KamaCache::KEpochStats stats = KamaCache::KEpochDomain::global().stats();
+    std::cout << "守卫内引用保持有效: " << (stable ? "是" : "否") << " 已退役节点: " << stats.retired
+              << " 已释放: " << stats.reclaimed << " 当前纪元: " << stats.epoch << std::endl;
+}
+
+// 大值读取：读多写少 值为 valueSize 字节 make 把字符串转换成缓存的值类型
+template<typename Cache, typename Make>
+void runLargeValues(const std::string& name, Cache& cache, Make make, int threadNum, int opsPerThread, int keyRange, size_t valueSize) {
+    for (int key = 0; key < keyRange; ++key) {
+        cache.put(key, make(std::string(valueSize, static_cast<char>('a' + key % 26))));
+    }
+
+    std::atomic<long long> totalBytes{0};
+    std::vector<std::thread> threads;
+    Timer timer;
+    for (int t = 0; t < threadNum; ++t) {
+        threads.emplace_back([&, t] {
+            std::mt19937 gen(t);
+            long long bytes = 0;
+            decltype(make(std::string())) result;
+            for (int op = 0; op < opsPerThread; ++op) {
+                int key = gen() % keyRange;
+                if (gen() % 100 == 0) {
+                    cache.put(key, make(std::string(valueSize, 'x')));
+                } else if (cache.get(key, result)) {
+                    bytes += result.size();
+                }
+            }
+            totalBytes += bytes;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double ms = std::max(timer.elapsed(), 1.0);
+    double totalOps = static_cast<double>(threadNum) * opsPerThread;
+    std::cout << std::left << std::setw(20) << name << std::right
+              << " 吞吐量: " << std::fixed << std::setprecision(2) << totalOps / ms / 1000.0 << " Mops/s"
+              << " (耗时 " << ms << "ms, 读取 " << totalBytes.load() / (1024 * 1024) << "MB)" << std::endl;
+}
+
+// 共享值缓冲测试：大值以 std::string 存储时命中要拷贝整个值 以 KSharedBuffer 存储时只增加引用计数
+void testSharedBuffers() {
+    std::cout << "\n=== 测试场景16：共享值缓冲测试 ===" << std::endl;
+
+    const int THREADS = 4;            // 并发线程数
+    const int OPS_PER_THREAD = 20000; // 每个线程的操作次数
+    const int CAPACITY = 256;         // 缓存总容量
+    const int KEY_RANGE = 256;        // 键范围
+    const int SLICES = 8;             // 分片数量
+    const size_t VALUE_SIZE = 64 * 1024;
+
+    KamaCache::KHashLruCaches<int, std::string> stringCache(CAPACITY, SLICES);
+    runLargeValues("string 64KB", stringCache, [](std::string s) { return s; },
+                   THREADS, OPS_PER_THREAD, KEY_RANGE, VALUE_SIZE);
+    KamaCache::KHashLruCaches<int, KamaCache::KSharedBuffer> bufferCache(CAPACITY, SLICES);
+    runLargeValues("SharedBuffer 64KB", bufferCache,
+                   [](const std::string& s) { return KamaCache::KSharedBuffer::fromString(s); },
+                   THREADS, OPS_PER_THREAD, KEY_RANGE, VALUE_SIZE);
+
+    // 读者持有的句柄在条目被覆盖、淘汰后仍然可读
+    KamaCache::KLruCache<int, KamaCache::KSharedBuffer> cache(4);
+    cache.put(1, KamaCache::KSharedBuffer::fromString("original"));
+    KamaCache::KSharedBuffer handle;
+    cache.get(1, handle);
+    cache.put(1, KamaCache::KSharedBuffer::fromString("overwritten"));
+    for (int key = 2; key < 10; ++key) {
+        cache.put(key, KamaCache::KSharedBuffer::fromString("filler"));
+    }
+    std::cout << "淘汰后句柄仍然有效: " << (handle.view() == "original" ? "是" : "否")
+              << " 引用计数: " << handle.useCount() << std::endl;
+}
+
+// slab 分配测试：值大小在运行中整体变大 观察各尺寸等级之间的页重平衡与内存统计
+void testSlabAllocator() {
+    std::cout << "\n=== 测试场景17：slab分配测试 ===" << std::endl;
+
+    const size_t MEMORY = 32 << 20; // 缓存内存上限
+    const int SLICES = 8;           // 分片数量
+    const int KEY_RANGE = 40000;    // 键范围
+    const int OPERATIONS = 400000;  // 每个阶段的操作次数
+
+    KamaCache::KSlabOptions options;
+    options.pageSize = 256 * 1024;
+    KamaCache::KHashSlabLruCache<int> cache(MEMORY, SLICES, options);
+
+    std::mt19937 gen(42);
+    auto runPhase = [&](const std::string& name, int minSize, int maxSize) {
+        std::uniform_int_distribution<int> size(minSize, maxSize);
+        int hits = 0;
+        std::string value;
+        Timer timer;
+        for (int op = 0; op < OPERATIONS; ++op) {
+            // 80%访问前20%的热点键 未命中时回源写入
+            int key = (gen() % 100 < 80) ? gen() % (KEY_RANGE / 5) : gen() % KEY_RANGE;
+            if (cache.get(key, value)) {
+                ++hits;
+            } else {
+                cache.put(key, std::string(size(gen), 'v'));
+            }
+        }
+        KamaCache::KSlabMemoryStats stats = cache.memoryStats();
+        std::cout << name << " 命中率: " << std::fixed << std::setprecision(2) << 100.0 * hits / OPERATIONS << "%"
+                  << " 耗时: " << timer.elapsed() << "ms"
+                  << " 条目: " << stats.items
+                  << " 页内存: " << stats.pageBytes / 1024 << "KB"
+                  << " 值: " << stats.valueBytes / 1024 << "KB"
+                  << " 碎片率: " << 100.0 * stats.fragmentation() << "%"
+                  << " 每条目: " << stats.bytesPerEntry() << "B"
+                  << " 淘汰: " << stats.evictions
+                  << " 转移页: " << stats.pagesMoved << std::endl;
+    };
+
+    runPhase("小值(64-512B)", 64, 512);
+    runPhase("大值(1-4KB)", 1024, 4096);
+    runPhase("小值(64-512B)", 64, 512);
+
+    // 大页模式下调低内存上限 归还的页应把物理内存交还系统
+    KamaCache::KSlabOptions hugeOptions;
+    hugeOptions.hugePages = KamaCache::KHugePageMode::Transparent;
+    KamaCache::KSlabLruCache<int> hugeCache(16 << 20, hugeOptions);
+    for (int key = 0; key < 16 * 1024; ++key) {
+        hugeCache.put(key, std::string(900, 'v'));
+    }
+    size_t before = hugeCache.memoryStats().pageBytes;
+    hugeCache.setCapacity(4 << 20);
+    while (hugeCache.trim(4) > 0) {
+    }
+    KamaCache::KSlabMemoryStats shrunk = hugeCache.memoryStats();
+    size_t returned = before - shrunk.pageBytes;
+    // 每页首个 4KB 保留空闲链表指针
+    bool ok = returned > 0 && shrunk.releasedBytes >= returned - returned / 64;
+    std::cout << "大页缩容 归还页: " << returned / 1024 << "KB"
+              << " 交还系统: " << shrunk.releasedBytes / 1024 << "KB"
+              << " 缩容释放物理内存: " << (ok ? "通过" : "失败") << std::endl;
+}
+
+// 大页内存测试：大容量分片 LRU 均匀随机读 比较节点与索引放在普通页、透明大页、预留大页上的吞吐量与 dTLB 未命中率
+void testHugePages() {
+    std::cout << "\n=== 测试场景18：大页内存测试 ===" << std::endl;
+
+    const int THREADS = 4;             // 并发线程数
+    const int OPS_PER_THREAD = 500000; // 每个线程的读取次数
+    const int CAPACITY = 1000000;      // 缓存总容量 全部写满
+    const int SLICES = 8;              // 分片数量
+
+    const std::vector<std::pair<std::string, KamaCache::KHugePageMode>> modes = {
+        {"4KB pages", KamaCache::KHugePageMode::Off},
+        {"THP madvise", KamaCache::KHugePageMode::Transparent},
+        {"MAP_HUGETLB", KamaCache::KHugePageMode::Explicit},
+    };
+    for (const auto& mode : modes) {
+        KamaCache::KHashLruCaches<int, std::string> cache(CAPACITY, SLICES, mode.second);
+        for (int key = 0; key < CAPACITY; ++key) {
+            cache.put(key, "value" + std::to_string(key));
+        }
+
+        DtlbCounters counters;
+        std::atomic<long long> totalHits{0};
+        std::vector<std::thread> threads;
+        counters.start();
+        Timer timer;
+        for (int t = 0; t < THREADS; ++t) {
+            threads.emplace_back([&, t] {
+                std::mt19937 gen(t);
+                long long hits = 0;
+                std::string result;
+                for (int op = 0; op < OPS_PER_THREAD; ++op) {
+                    if (cache.get(static_cast<int>(gen() % CAPACITY), result)) {
+                        ++hits;
+                    }
+                }
+                totalHits += hits;
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        double ms = std::max(timer.elapsed(), 1.0);
+        double missRate = counters.stop();
+
+        KamaCache::KHugePageStats stats = cache.hugePageStats();
+        std::cout << std::left << std::setw(20) << mode.first << std::right
+                  << " 吞吐量: " << std::fixed << std::setprecision(2)
+                  << static_cast<double>(THREADS) * OPS_PER_THREAD / ms / 1000.0 << " Mops/s"
+                  << " 命中: " << totalHits.load()
+                  << " dTLB未命中率: ";
+        if (missRate >= 0) {
+            std::cout << 100.0 * missRate << "%";
+        } else {
+            std::cout << "不可用";
+        }
+        std::cout << " 映射: " << stats.mappedBytes / (1024 * 1024) << "MB"
+                  << " 透明大页: " << stats.transparentBytes / (1024 * 1024) << "MB"
+                  << " 预留大页: " << stats.explicitBytes / (1024 * 1024) << "MB" << std::endl;
+    }
+}
+
+// 缩容后逐次写入新 key 直到回收完毕 返回每次写入的耗时(微秒) 已排序
+std::vector<double> shrinkByWrites(KamaCache::KICachePolicy<int, int>& cache, int firstKey) {
+    std::vector<double> latencies;
+    while (cache.trim(0) > 0) {
+        auto start = std::chrono::steady_clock::now();
+        cache.put(firstKey + static_cast<int>(latencies.size()), 1);
+        latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(latencies.begin(), latencies.end());
+    return latencies;
+}
+
+// 运行期缩容测试：容量缩小到十分之一 比较一次性淘汰与分批淘汰的单次操作延迟 以及后台维护线程的回收
+void testRuntimeResize() {
+    std::cout << "\n=== 测试场景19：运行期缩容测试 ===" << std::endl;
+
+    const int CAPACITY = 200000;     // 缩容前的容量 全部写满
+    const int SHRUNK = CAPACITY / 10; // 缩容后的容量
+
+    // 一次性淘汰：缩容后立即回收全部超出的条目 期间持有锁 相当于一次长时间的停顿
+    {
+        KamaCache::KLruCache<int, int> cache(CAPACITY);
+        for (int key = 0; key < CAPACITY; ++key) {
+            cache.put(key, key);
+        }
+        cache.setCapacity(SHRUNK);
+        auto start = std::chrono::steady_clock::now();
+        cache.trim(SIZE_MAX);
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        std::cout << std::left << std::setw(20) << "LRU trim-all" << std::right
+                  << " 单次停顿: " << us << "us" << std::endl;
+    }
+
+    // 分批淘汰：每次写入最多多淘汰 kTrimBatch 个 所有策略通过 KICachePolicy 接口缩容
+    std::vector<std::pair<std::string, std::unique_ptr<KamaCache::KICachePolicy<int, int>>>> caches;
+    caches.emplace_back("LRU", new KamaCache::KLruCache<int, int>(CAPACITY));
+    caches.emplace_back("LFU", new KamaCache::KLfuCache<int, int>(CAPACITY));
+    caches.emplace_back("ARC", new KamaCache::KArcCache<int, int>(CAPACITY / 2));
+    caches.emplace_back("SLRU", new KamaCache::KSlruCache<int, int>(CAPACITY));
+    caches.emplace_back("LIRS", new KamaCache::KLirsCache<int, int>(CAPACITY));
+    caches.emplace_back("SIEVE", new KamaCache::KSieveCache<int, int>(CAPACITY));
+    caches.emplace_back("S3-FIFO", new KamaCache::KS3FifoCache<int, int>(CAPACITY));
+    caches.emplace_back("KCache<LRU>", new KamaCache::KCachePolicyAdapter<int, int, KamaCache::KStaticLruCache<int, int>>(CAPACITY));
+    for (auto& entry : caches) {
+        KamaCache::KICachePolicy<int, int>& cache = *entry.second;
+        for (int key = 0; key < CAPACITY; ++key) {
+            cache.put(key, key);
+        }
+        size_t evictions = 0;
+        cache.setEvictCallback([&evictions](const int&, const int&) { ++evictions; });
+        cache.setCapacity(entry.first == "ARC" ? SHRUNK / 2 : SHRUNK); // ARC 的容量参数是单个部分的大小
+        std::vector<double> latencies = shrinkByWrites(cache, CAPACITY);
+        std::cout << std::left << std::setw(20) << entry.first << std::right
+                  << " 回收所需写入: " << latencies.size()
+                  << " 淘汰: " << evictions
+                  << " 单次写入 p99: " << std::fixed << std::setprecision(1) << latencies[latencies.size() * 99 / 100] << "us"
+                  << " 最长: " << latencies.back() << "us" << std::endl;
+    }
+
+    // 容量改为 0：写入已有的 key 不能被丢弃 之后的读取不能再返回旧值
+    {
+        const int FILLED = 50; // 缩容前写入的条目数
+        std::vector<std::pair<std::string, std::unique_ptr<KamaCache::KICachePolicy<int, int>>>> zeroCaches;
+        zeroCaches.emplace_back("LRU", new KamaCache::KLruCache<int, int>(FILLED));
+        zeroCaches.emplace_back("LFU", new KamaCache::KLfuCache<int, int>(FILLED));
+        zeroCaches.emplace_back("ARC", new KamaCache::KArcCache<int, int>(FILLED));
+        zeroCaches.emplace_back("CAR", new KamaCache::KCarCache<int, int>(FILLED));
+        zeroCaches.emplace_back("SLRU", new KamaCache::KSlruCache<int, int>(FILLED));
+        zeroCaches.emplace_back("LIRS", new KamaCache::KLirsCache<int, int>(FILLED));
+        zeroCaches.emplace_back("LRFU", new KamaCache::KLrfuCache<int, int>(FILLED));
+        zeroCaches.emplace_back("SIEVE", new KamaCache::KSieveCache<int, int>(FILLED));
+        zeroCaches.emplace_back("S3-FIFO", new KamaCache::KS3FifoCache<int, int>(FILLED));
+        zeroCaches.emplace_back("RingS3-FIFO", new KamaCache::KRingS3FifoCache<int, int>(FILLED));
+        zeroCaches.emplace_back("FlatLRU", new KamaCache::KFlatLruCache<int, int>(FILLED));
+        zeroCaches.emplace_back("EpochLRU", new KamaCache::KEpochLruCache<int, int>(FILLED));
+        zeroCaches.emplace_back("GDSF", new KamaCache::KGdsfCache<int, int>(FILLED));
+        zeroCaches.emplace_back("KCache<LRU>", new KamaCache::KCachePolicyAdapter<int, int, KamaCache::KStaticLruCache<int, int>>(FILLED));
+        for (auto& entry : zeroCaches) {
+            KamaCache::KICachePolicy<int, int>& cache = *entry.second;
+            for (int key = 0; key < FILLED; ++key) {
+                cache.put(key, key);
+            }
+            cache.setCapacity(0);
+            cache.put(FILLED - 1, -1);
+            int value = 0;
+            bool stale = cache.get(FILLED - 1, value) && value != -1;
+            std::cout << std::left << std::setw(20) << entry.first << std::right
+                      << " 容量为0时覆盖写入: " << (stale ? "失败 读到旧值 " + std::to_string(value) : "通过") << std::endl;
+        }
+    }
+
+    // trim(n) 最多淘汰 n 个：用奇数配额检查各策略不会多淘汰
+    {
+        const int FILLED = 50; // 缩容前写入的条目数
+        std::vector<std::pair<std::string, std::unique_ptr<KamaCache::KICachePolicy<int, int>>>> trimCaches;
+        trimCaches.emplace_back("LRU", new KamaCache::KLruCache<int, int>(FILLED));
+        trimCaches.emplace_back("LFU", new KamaCache::KLfuCache<int, int>(FILLED));
+        trimCaches.emplace_back("ARC", new KamaCache::KArcCache<int, int>(FILLED));
+        trimCaches.emplace_back("CAR", new KamaCache::KCarCache<int, int>(FILLED));
+        trimCaches.emplace_back("SLRU", new KamaCache::KSlruCache<int, int>(FILLED));
+        trimCaches.emplace_back("S3-FIFO", new KamaCache::KS3FifoCache<int, int>(FILLED));
+        trimCaches.emplace_back("KCache<LRU>", new KamaCache::KCachePolicyAdapter<int, int, KamaCache::KStaticLruCache<int, int>>(FILLED));
+        for (auto& entry : trimCaches) {
+            KamaCache::KICachePolicy<int, int>& cache = *entry.second;
+            // 读取两遍后 ARC 的条目同时分布在 LRU 与 LFU 两部分
+            int value = 0;
+            for (int key = 0; key < FILLED; ++key) {
+                cache.put(key, key);
+                if (key % 2 == 0) {
+                    cache.get(key, value);
+                    cache.get(key, value);
+                }
+            }
+            size_t evictions = 0;
+            cache.setEvictCallback([&evictions](const int&, const int&) { ++evictions; });
+            cache.setCapacity(0);
+            bool ok = true;
+            for (size_t budget : {1, 3, 5}) {
+                evictions = 0;
+                cache.trim(budget);
+                ok = ok && evictions <= budget;
+            }
+            std::cout << std::left << std::setw(20) << entry.first << std::right
+                      << " trim 不超过配额: " << (ok ? "通过" : "失败") << std::endl;
+        }
+    }
+
+    // LFU 所有条目的访问频次都超过 127 后缩容：淘汰的必须是缓存中真实存在的 key
+    {
+        KamaCache::KLfuCache<int, int> cache(3);
+        std::vector<int> evicted;
+        cache.setEvictCallback([&evicted](const int& key, const int&) { evicted.push_back(key); });
+        int value = 0;
+        for (int key = 1; key <= 3; ++key) {
+            cache.put(key, key);
+            for (int hit = 0; hit < 100 * (key + 1); ++hit) {
+                cache.get(key, value);
+            }
+        }
+        cache.setCapacity(1);
+        cache.trim(2);
+        bool ok = evicted == std::vector<int>{1, 2} && cache.get(3, value);
+        std::cout << std::left << std::setw(20) << "LFU" << std::right
+                  << " 高频次缩容淘汰: " << (ok ? "通过" : "失败") << std::endl;
+    }
+
+    // 扩容超过构造时的容量：节点池预先分配的策略需要追加节点 扩容后写入的条目应全部驻留
+    {
+        const int INITIAL = 50; // 构造时的容量
+        const int GROWN = INITIAL * 4; // 扩容后的容量
+        std::vector<std::pair<std::string, std::unique_ptr<KamaCache::KICachePolicy<int, int>>>> growCaches;
+        growCaches.emplace_back("SLRU", new KamaCache::KSlruCache<int, int>(INITIAL));
+        growCaches.emplace_back("RingS3-FIFO", new KamaCache::KRingS3FifoCache<int, int>(INITIAL));
+        growCaches.emplace_back("KCache<LRU>", new KamaCache::KCachePolicyAdapter<int, int, KamaCache::KStaticLruCache<int, int>>(INITIAL));
+        for (auto& entry : growCaches) {
+            KamaCache::KICachePolicy<int, int>& cache = *entry.second;
+            for (int key = 0; key < INITIAL; ++key) {
+                cache.put(key, key);
+            }
+            cache.setCapacity(GROWN);
+            for (int key = INITIAL; key < GROWN; ++key) {
+                cache.put(key, key);
+            }
+            int resident = 0;
+            for (int key = 0; key < GROWN; ++key) {
+                int value = -1;
+                if (cache.get(key, value) && value == key) {
+                    ++resident;
+                }
+            }
+            std::cout << std::left << std::setw(20) << entry.first << std::right
+                      << " 扩容到 " << GROWN << " 后驻留: " << resident
+                      << (resident == GROWN ? " 通过" : " 失败") << std::endl;
+        }
+    }
+
+    // 后台维护线程：没有写入时由维护线程分批回收 记录每一轮 trim 的耗时(即单个分片锁的最长持有时间的上界)
+    {
+        const int SLICES = 8; // 分片数量
+        KamaCache::KHashLruCaches<int, int> cache(CAPACITY, SLICES);
+        for (int key = 0; key < CAPACITY; ++key) {
+            cache.put(key, key);
+        }
+        std::atomic<long long> maxRoundNs{0};
+        KamaCache::KMaintenanceThread maintenance([&cache, &maxRoundNs](size_t n) {
+            auto start = std::chrono::steady_clock::now();
+            size_t remaining = cache.trim(n);
+            long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            if (ns > maxRoundNs.load(std::memory_order_relaxed)) {
+                maxRoundNs.store(ns, std::memory_order_relaxed);
+            }
+            return remaining;
+        });
+
+        Timer timer;
+        uint64_t roundsBefore = maintenance.rounds();
+        cache.setCapacity(SHRUNK);
+        maintenance.wake();
+        while (cache.trim(0) > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::cout << std::left << std::setw(20) << "HashLRU maintenance" << std::right
+                  << " 回收耗时: " << timer.elapsed() << "ms"
+                  << " 维护轮数: " << maintenance.rounds() - roundsBefore
+                  << " 单轮最长: " << std::fixed << std::setprecision(1) << maxRoundNs.load() / 1000.0 << "us" << std::endl;
+    }
+}
+
+struct ReshardPhaseResult {
+    double    throughput; // Mops/s
+    double    hitRate;    // 读命中率(%)
+    long long staleReads; // 读到比自己最后一次写入更旧的值的次数
+};
+
+// 动态分片测试的一个阶段：访问分布与 runThroughput 相同
+// 每个 key 只由 key % threadNum 号线程写入，值带有全局唯一的版本，线程读到自己写过的 key 时
+// 命中的必须是最后一次写入的版本，否则说明迁移让旧值重新可见
+template<typename Cache>
+ReshardPhaseResult runReshardPhase(Cache& cache, int threadNum, int opsPerThread, int keyRange) {
+    static std::atomic<int> phaseSeq{0};
+    const int phase = ++phaseSeq; // 区分不同阶段写入的值
+    std::atomic<long long> totalHits{0};
+    std::atomic<long long> totalReads{0};
+    std::atomic<long long> totalStale{0};
+    std::vector<std::thread> threads;
+    Timer timer;
+    for (int t = 0; t < threadNum; ++t) {
+        threads.emplace_back([&, t] {
+            std::mt19937 gen(t);
+            long long hits = 0;
+            long long reads = 0;
+            long long stale = 0;
+            std::vector<std::string> written(keyRange); // 本线程在本阶段最后写入的值 空表示未写过
+            std::string result;
+            for (int op = 0; op < opsPerThread; ++op) {
+                int key = (gen() % 100 < 80) ? gen() % (keyRange / 5) : gen() % keyRange;
+                if (gen() % 10 == 0) {
+                    key = key - key % threadNum + t; // 换成本线程负责写入的 key
+                    if (key >= keyRange) {
+                        key -= threadNum;
+                    }
+                    written[key] = std::to_string(phase) + ":" + std::to_string(t) + ":" + std::to_string(op);
+                    cache.put(key, written[key]);
+                } else {
+                    ++reads;
+                    if (cache.get(key, result)) {
+                        ++hits;
+                        if (!written[key].empty() && result != written[key]) {
+                            ++stale;
+                        }
+                    }
+                }
+            }
+            totalHits += hits;
+            totalReads += reads;
+            totalStale += stale;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double ms = std::max(timer.elapsed(), 1.0);
+    return {static_cast<double>(threadNum) * opsPerThread / ms / 1000.0,
+            100.0 * totalHits.load() / std::max(totalReads.load(), 1LL),
+            totalStale.load()};
+}
+
+// 动态分片测试：在读写进行中把分片数从 1 调整到 16 比较调整前、迁移中、迁移后的吞吐量与命中率
+// 迁移不丢条目时迁移中的命中率与调整前接近；最后演示按锁冲突率自动调整分片数
+void testDynamicSharding() {
+    std::cout << "\n=== 测试场景20：动态分片测试 ===" << std::endl;
+
+    const int THREADS = 4;             // 并发线程数
+    const int OPS_PER_THREAD = 100000; // 每个阶段每个线程的操作次数
+    const int CAPACITY = 4000;         // 缓存总容量
+    const int KEY_RANGE = 10000;       // 键范围
+    const int TARGET_SLICES = 16;      // 调整后的分片数
+
+    std::cout << "线程数: " << THREADS << " 缓存大小: " << CAPACITY << " 可用CPU: " << KamaCache::KAvailableCpus() << std::endl;
+
+    auto run = [&](const std::string& name, auto& cache) {
+        for (int key = 0; key < KEY_RANGE; ++key) {
+            cache.put(key, "value" + std::to_string(key));
+        }
+        auto print = [&](const std::string& phase, const ReshardPhaseResult& result) {
+            KamaCache::KReshardStats stats = cache.reshardStats();
+            std::cout << std::left << std::setw(10) << name << std::setw(14) << phase << std::right
+                      << " 吞吐量: " << std::fixed << std::setprecision(2) << result.throughput << " Mops/s"
+                      << " 命中率: " << result.hitRate << "%"
+                      << " 分片: " << stats.sliceNum
+                      << " 已迁移: " << stats.migrated
+                      << (stats.migrating ? " (迁移中)" : "")
+                      << " 读己之写: " << (result.staleReads == 0 ? "通过" : "失败 过期读 " + std::to_string(result.staleReads))
+                      << std::endl;
+        };
+        print("调整前", runReshardPhase(cache, THREADS, OPS_PER_THREAD, KEY_RANGE));
+        cache.setSliceNum(TARGET_SLICES);
+        print("迁移中", runReshardPhase(cache, THREADS, OPS_PER_THREAD / 10, KEY_RANGE));
+        // 剩余的条目交给 trim 迁完 相当于维护线程的工作
+        while (cache.resharding()) {
+            cache.trim(256);
+        }
+        print("迁移后", runReshardPhase(cache, THREADS, OPS_PER_THREAD, KEY_RANGE));
+    };
+
+    KamaCache::KHashLruCaches<int, std::string> lru(CAPACITY, 1);
+    run("HashLRU", lru);
+    // 与场景5相同 使用较大的 maxAverageNum
+    KamaCache::KHashLfuCache<int, std::string> lfu(CAPACITY, 1, 1000000);
+    run("HashLFU", lfu);
+
+    // 自动调整：从 1 个分片开始 冲突率高于阈值时分片数翻倍 直到冲突率降下来或达到上限
+    KamaCache::KHashLruCaches<int, std::string> autoLru(CAPACITY, 1);
+    KamaCache::KReshardOptions options;
+    options.maxSlices = TARGET_SLICES;
+    autoLru.enableAutoResharding(options);
+    ReshardPhaseResult result = runReshardPhase(autoLru, THREADS, OPS_PER_THREAD * 2, KEY_RANGE);
+    KamaCache::KReshardStats stats = autoLru.reshardStats();
+    std::cout << std::left << std::setw(24) << "HashLRU auto" << std::right
+              << " 吞吐量: " << std::fixed << std::setprecision(2) << result.throughput << " Mops/s"
+              << " 命中率: " << result.hitRate << "%"
+              << " 分片: 1 -> " << stats.sliceNum
+              << " 调整次数: " << stats.reshards
+              << " 冲突率: " << std::setprecision(4) << stats.contention * 100 << "%"
+              << " 读己之写: " << (result.staleReads == 0 ? "通过" : "失败 过期读 " + std::to_string(result.staleReads))
+              << std::endl;
+}
+
+// 回放访问轨迹：每行取第一个字段作为 key 未命中时回源写入
+// 用于在真实业务轨迹上比较 LRU / LRU-K / ARC / LIRS / LRFU 的命中率与耗时
+void testTraceReplay(const std::string& path, int capacity) {
+    std::cout << "\n=== 测试场景21：访问轨迹回放测试 ===" << std::endl;
+
+    std::vector<std::string> trace;
+    {
+        std::ifstream in(path);
+        if (!in) {
+            std::cout << "无法打开轨迹文件: " << path << std::endl;
+            return;
+        }
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream fields(line);
+            std::string key;
+            if (fields >> key) {
+                trace.push_back(key);
+            }
+        }
+    }
+    std::cout << "轨迹文件: " << path << " 访问次数: " << trace.size() << std::endl;
+    if (trace.empty()) {
+        return;
+    }
+
+    KamaCache::KLruCache<std::string, int> lru(capacity);
+    KamaCache::KLruKCache<std::string, int> lruk(capacity, capacity * 2, 2);
+    KamaCache::KArcCache<std::string, int> arc(capacity);
+    KamaCache::KLirsCache<std::string, int> lirs(capacity);
+    // LRFU 扫描一组 lambda 取值 便于按轨迹选取参数 0 接近 LFU 1 等价于 LRU
+    KamaCache::KLrfuCache<std::string, int> lrfu0(capacity, 0.0);
+    KamaCache::KLrfuCache<std::string, int> lrfu1(capacity, 0.001);
+    KamaCache::KLrfuCache<std::string, int> lrfu2(capacity, 0.01);
+    KamaCache::KLrfuCache<std::string, int> lrfu3(capacity, 0.1);
+    KamaCache::KLrfuCache<std::string, int> lrfu4(capacity, 1.0);
+
+    std::array<KamaCache::KICachePolicy<std::string, int>*, 9> caches = {&lru, &lruk, &arc, &lirs,
+                                                                          &lrfu0, &lrfu1, &lrfu2, &lrfu3, &lrfu4};
+    std::vector<std::string> names = {"LRU", "LRU-K", "ARC", "LIRS", "LRFU(0)", "LRFU(0.001)",
+                                      "LRFU(0.01)", "LRFU(0.1)", "LRFU(1)"};
+    std::vector<int> hits(caches.size(), 0);
+    std::vector<int> get_operations(caches.size(), 0);
+
+    for (size_t i = 0; i < caches.size(); ++i) {
+        Timer timer;
+        int result;
+        for (const std::string& key : trace) {
+            get_operations[i]++;
+            if (caches[i]->get(key, result)) {
+                hits[i]++;
+            } else {
+                caches[i]->put(key, 1);
+            }
+        }
+        double ms = std::max(timer.elapsed(), 1.0);
+        std::cout << std::left << std::setw(12) << names[i] << std::right
+                  << " 耗时: " << ms << "ms 吞吐量: " << std::fixed << std::setprecision(2)
+                  << trace.size() / ms / 1000.0 << " Mops/s" << std::endl;
+    }
+
+    printResults("访问轨迹回放测试", capacity, names, get_operations, hits);
+}
+
+// 用法: main [轨迹文件 [缓存容量]] 提供轨迹文件时额外运行回放测试
+int main(int argc, char* argv[]) {
     #ifdef _WIN32
     SetConsoleOutputCP(65001);
     #endif
@@ -295,5 +1886,25 @@ int main() {
     testHotDataAccess();
     testLoopPattern();
     testWorkloadShift();
+    testTieredCache();
+    testThroughput();
+    testMissCost();
+    testAdaptivePolicy();
+    testScanResistance();
+    testNegativeCache();
+    testHotKeyTracking();
+    testHotKeyReplication();
+    testNearCache();
+    testStaticComposition();
+    testLockStrategies();
+    testEpochReads();
+    testSharedBuffers();
+    testSlabAllocator();
+    testHugePages();
+    testRuntimeResize();
+    testDynamicSharding();
+    if (argc > 1) {
+        testTraceReplay(argv[1], argc > 2 ? std::stoi(argv[2]) : 1000);
+    }
     return 0;
 }
\ No newline at end of file